@@ -8,14 +8,16 @@
 #include <common.h>
 #include <getopt.h>
 #include <Curve.h>
-#include <Arrow.h>
-#include <SphericalSphere.h>
+#include <Instances.h>
+#include <IcosahedralSphere.h>
 #include <CGAL/IO/Polyhedron_iostream.h>
 #include <CGAL/IO/Nef_polyhedron_iostream_3.h>
 #include <CGAL/Aff_transformation_3.h>
 #include <debug.h>
+#include <Union.h>
 #include <iostream>
 #include <Parts.h>
+#include <ComponentCache.h>
 
 namespace csg {
 
@@ -30,12 +32,14 @@ public:
 		return point(_radius * cos(t), _radius * sin(t), _a * t);
 	}
 
-	virtual vector	tangent(double t) const {
-		return vector(-_radius * sin(t), _radius * cos(t), _a);
-	}
-
-	virtual vector	normal(double t) const {
-		return vector(-cos(t), -sin(t), 0);
+	virtual curvepoint	evaluate(double t) const {
+		double	c = cos(t);
+		double	s = sin(t);
+		curvepoint	result;
+		result.p = point(_radius * c, _radius * s, _a * t);
+		result.d1 = vector(-_radius * s, _radius * c, _a);
+		result.d2 = vector(-c, -s, 0);
+		return result;
 	}
 };
 
@@ -55,7 +59,7 @@ Nef_polyhedron	build_helix(int steps, int phisteps, double radius) {
 }
 
 Nef_polyhedron	build_frame(double a) {
-	Nef_nary_union	unioner;
+	Parallel_nary_union	unioner;
 	double	normalize = sqrt(1 + a * a);
 	double	deltax = 1 / normalize;
 	double	deltay = a / normalize;
@@ -63,32 +67,25 @@ Nef_polyhedron	build_frame(double a) {
 		deltax, deltay);
 	{
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "add X-axis");
-		Polyhedron	p;
 		point	end(0, 80 * deltax, 80 * deltay);
-		Build_Arrow	b(point(0, 0, 0), end, 10, 16);
-		p.delegate(b);
-		unioner.add_polyhedron(p);
+		unioner.add_polyhedron(arrow_polyhedron(point(0, 0, 0), end,
+					10, 16));
 	}
 	{
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "add Y-axis");
-		Polyhedron	p;
-		Build_Arrow	b(point(0, 0, 0),
-					point(-80, 0, 0), 10, 16);
-		p.delegate(b);
-		unioner.add_polyhedron(p);
+		unioner.add_polyhedron(arrow_polyhedron(point(0, 0, 0),
+					point(-80, 0, 0), 10, 16));
 	}
 	{
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "add Z-axis");
-		Polyhedron	p;
 		point	end(0, -80 * deltay, 80 * deltax);
-		Build_Arrow	b(point(0, 0, 0), end, 10, 16);
-		p.delegate(b);
-		unioner.add_polyhedron(p);
+		unioner.add_polyhedron(arrow_polyhedron(point(0, 0, 0), end,
+					10, 16));
 	}
 	{
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "add sphere");
 		Polyhedron	p;
-		Build_SphericalSphere	b(12, 20);
+		Build_IcosahedralSphere	b(12, 3);
 		p.delegate(b);
 		unioner.add_polyhedron(p);
 	}
@@ -109,7 +106,9 @@ int	main(int argc, char *argv[]) {
 	double	radius = 5;
 	int	c;
 	bool	doframe = false;
-	while (EOF != (c = getopt(argc, argv, "df")))
+	output_format	format = OFF_FORMAT;
+	ComponentCache	cache;
+	while (EOF != (c = getopt(argc, argv, "dfO:K:")))
 		switch (c) {
 		case 'd':
 			debuglevel = LOG_DEBUG;
@@ -117,16 +116,32 @@ int	main(int argc, char *argv[]) {
 		case 'f':
 			doframe = true;
 			break;
+		case 'O':
+			format = format_from_string(optarg);
+			break;
+		case 'K':
+			cache = ComponentCache(optarg);
+			break;
 		}
 
 	// convert to Nef polyhedra
-	Nef_polyhedron	n1 = build_helix(steps, phisteps,
-					radius + ((doframe) ? 1 : 0));
+	double	helixradius = radius + ((doframe) ? 1 : 0);
+	char	description[256];
+	snprintf(description, sizeof(description),
+		"helix steps=%d phisteps=%d radius=%.17g", steps, phisteps,
+		helixradius);
+	Nef_polyhedron	n1 = cache.get(description,
+		[steps, phisteps, helixradius]() {
+			return build_helix(steps, phisteps, helixradius);
+		});
 
 	// Frenet frame
 	Nef_polyhedron	image;
 	if (doframe) {
-		Nef_polyhedron	n2 = build_frame(1. / (2. * M_PI));
+		double	a = 1. / (2. * M_PI);
+		snprintf(description, sizeof(description), "frame a=%.17g", a);
+		Nef_polyhedron	n2 = cache.get(description,
+			[a]() { return build_frame(a); });
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "compute difference");
 		image = n2 - n1;
 	} else {
@@ -139,13 +154,15 @@ int	main(int argc, char *argv[]) {
 	std::cout << P;
 
 	// print parts
-	PartWriter	pw("helix");
-	pw(PartWriter::LEFT_PART, image);
-	pw(PartWriter::RIGHT_PART, image);
-	pw(PartWriter::FRONT_PART, image);
-	pw(PartWriter::BACK_PART, image);
-	pw(PartWriter::TOP_PART, image);
-	pw(PartWriter::BOTTOM_PART, image);
+	PartWriter	pw("helix", format);
+	std::vector<PartWriter::object_part>	parts;
+	parts.push_back(PartWriter::LEFT_PART);
+	parts.push_back(PartWriter::RIGHT_PART);
+	parts.push_back(PartWriter::FRONT_PART);
+	parts.push_back(PartWriter::BACK_PART);
+	parts.push_back(PartWriter::TOP_PART);
+	parts.push_back(PartWriter::BOTTOM_PART);
+	pw(parts, image);
 
 	return EXIT_SUCCESS;
 }
@@ -9,6 +9,7 @@
 #include <Curve.h>
 #include <math.h>
 #include <parameters.h>
+#include <Components.h>
 
 namespace csg {
 
@@ -21,14 +22,14 @@ point	CharacteristicY::position(double t) const {
 	return p;
 }
 
-vector	CharacteristicY::tangent(double t) const {
-	vector	v(cosh(t / y0), sinh(t / y0), 0);
-	return v;
-}
-
-vector	CharacteristicY::normal(double t) const {
-	vector	n(sinh(t / y0) / y0, cosh(t / y0) / y0, 0);
-	return n;
+curvepoint	CharacteristicY::evaluate(double t) const {
+	double	s = sinh(t / y0);
+	double	c = cosh(t / y0);
+	curvepoint	result;
+	result.p = point(y0 * s, y0 * c, a * y0 * y0);
+	result.d1 = vector(c, s, 0);
+	result.d2 = vector(s / y0, c / y0, 0);
+	return result;
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -40,14 +41,14 @@ point	CharacteristicX::position(double t) const {
 	return p;
 }
 
-vector	CharacteristicX::tangent(double t) const {
-	vector	v(sinh(t / x0), cosh(t / x0), 0);
-	return v;
-}
-
-vector	CharacteristicX::normal(double t) const {
-	vector	n(cosh(t / x0) / x0, sinh(t / x0) / x0, 0);
-	return n;
+curvepoint	CharacteristicX::evaluate(double t) const {
+	double	s = sinh(t / x0);
+	double	c = cosh(t / x0);
+	curvepoint	result;
+	result.p = point(x0 * c, x0 * s, z);
+	result.d1 = vector(s, c, 0);
+	result.d2 = vector(c / x0, s / x0, 0);
+	return result;
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -58,19 +59,20 @@ point	Asymptote::position(double t) const {
 	return point(t, m * t, 0.);
 }
 
-vector	Asymptote::tangent(double /* t */) const {
-	return vector(1., m, 0.);
-}
-
-vector	Asymptote::normal(double /* t */) const {
-	return vector::e2;
+curvepoint	Asymptote::evaluate(double t) const {
+	curvepoint	result;
+	result.p = position(t);
+	result.d1 = vector(1., m, 0.);
+	// straight line, any vector not parallel to it orients the tube
+	result.d2 = vector::e2;
+	return result;
 }
 
 //////////////////////////////////////////////////////////////////////
 // build_xcharacteristics implementation
 //////////////////////////////////////////////////////////////////////
 
-static void	add_characteristic(Nef_nary_union& unioner, double y0) {
+static Nef_polyhedron	build_characteristic(double y0) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "add characteristic at y0 = %f", y0);
 	double	tmax = fabs(y0) * acosh(2 / fabs(y0));
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "t interval extends to %f", tmax);
@@ -78,65 +80,88 @@ static void	add_characteristic(Nef_nary_union& unioner, double y0) {
 	CharacteristicY	cs(y0);
 	Build_Curve	charcurve(cs, interval, steps, 8,
 				smallcurveradius);
+	charcurve.frames(Build_Curve::ROTATION_MINIMIZING_FRAMES);
+	charcurve.maxangle(M_PI / 36);
+	charcurve.clip(imagebox);
+	charcurve.validation(true);
 	Polyhedron	p;
 	p.delegate(charcurve);
-	Nef_polyhedron	n(p);
-	unioner.add_polyhedron(n);
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "curve added");
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "curve for y0 = %f built", y0);
+	return Nef_polyhedron(p);
 }
 
-static void	add_asymptote(Nef_nary_union& unioner, double m) {
+static Nef_polyhedron	build_asymptote(double m) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "adding asymptote %f", m);
 	Interval	interval(0., 2.1);
 	Asymptote	asymptote(m);
 	Build_Curve	charcurve(asymptote, interval, steps, phisteps,
 				smallcurveradius);
+	charcurve.frames(Build_Curve::ROTATION_MINIMIZING_FRAMES);
+	charcurve.maxangle(M_PI / 36);
+	charcurve.clip(imagebox);
+	charcurve.validation(true);
 	Polyhedron	p;
 	p.delegate(charcurve);
-	Nef_polyhedron	n(p);
-	unioner.add_polyhedron(n);
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "asymptote %f added", m);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "asymptote %f built", m);
+	return Nef_polyhedron(p);
+}
+
+static void	add_characteristic(Components& components, double y0) {
+	components.add("characteristic",
+		[y0]() { return build_characteristic(y0); });
+}
+
+static void	add_asymptote(Components& components, double m) {
+	components.add("asymptote",
+		[m]() { return build_asymptote(m); });
 }
 
 Nef_polyhedron	build_characteristics() {
-	Nef_nary_union	unioner;
+	Components	components;
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "add 1st quadrant characteristics");
 	for (double y0 = charstep * floor(2 / charstep); y0 > 0.1;
 			y0 -= charstep) {
-		add_characteristic(unioner, y0);
+		add_characteristic(components, y0);
 	}
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "add asymptotes");
-	add_asymptote(unioner, 1);
-	add_asymptote(unioner, -1);
+	add_asymptote(components, 1);
+	add_asymptote(components, -1);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "add 4th quadrant characteristics");
 	for (double y0 = -charstep; y0 > -2.1; y0 -= charstep) {
-		add_characteristic(unioner, y0);
+		add_characteristic(components, y0);
 	}
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "extract union of characteristics");
-	return unioner.get_union();
+	return components.get_union();
 }
 
 //////////////////////////////////////////////////////////////////////
 // build_xcharacteristics implementation
 //////////////////////////////////////////////////////////////////////
 
+static Nef_polyhedron	build_xcharacteristic(double x0) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "characteristic for x0 = %f", x0);
+	Polyhedron	p;
+	double	tmax = x0 * asinh(2 / x0);
+	Interval	interval(-tmax - 0.2, tmax + 0.2);
+	CharacteristicX	cx(x0, -a * x0 * x0);
+	Build_Curve	charcurve(cx, interval, steps, phisteps,
+				smallcurveradius);
+	charcurve.frames(Build_Curve::ROTATION_MINIMIZING_FRAMES);
+	charcurve.maxangle(M_PI / 36);
+	charcurve.clip(imagebox);
+	charcurve.validation(true);
+	p.delegate(charcurve);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "characteristic for x0 = %f built", x0);
+	return Nef_polyhedron(p);
+}
+
 Nef_polyhedron	build_xcharacteristics() {
-	Nef_nary_union	unioner;
+	Components	components;
 	for (double x0 = charstep; a * x0 * x0 < 2; x0 += charstep) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "characteristic for x0 = %f",
-			x0);
-		Polyhedron	p;
-		double	tmax = x0 * asinh(2 / x0);
-		Interval	interval(-tmax - 0.2, tmax + 0.2);
-		CharacteristicX	cx(x0, -a * x0 * x0);
-		Build_Curve	charcurve(cx, interval, steps, phisteps,
-					smallcurveradius);
-		p.delegate(charcurve);
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "add characteristic for x0 = %f",
-			x0);
-		unioner.add_polyhedron(p);
+		components.add("negative characteristic",
+			[x0]() { return build_xcharacteristic(x0); });
 	}
-	return unioner.get_union();
+	return components.get_union();
 }
 
 } // namespace csg
@@ -20,8 +20,7 @@ public:
 	CharacteristicY(const double _y0, double deltat = 0)
 		: CurveFunction(deltat), y0(_y0) { }
 	virtual point	position(double t) const;
-	virtual vector	tangent(double t) const;
-	virtual vector	normal(double t) const;
+	virtual curvepoint	evaluate(double t) const;
 };
 
 class CharacteristicX : public CurveFunction {
@@ -31,8 +30,7 @@ public:
 	CharacteristicX(const double _x0, double _z, double deltat = 0)
 		: CurveFunction(deltat), x0(_x0), z(_z) { }
 	virtual point	position(double t) const;
-	virtual vector	tangent(double t) const;
-	virtual	vector	normal(double t) const;
+	virtual curvepoint	evaluate(double t) const;
 };
 
 class Asymptote : public CurveFunction {
@@ -41,8 +39,7 @@ public:
 	Asymptote(const double _m, double deltat = 0)
 		: CurveFunction(deltat), m(_m) { }
 	virtual point	position(double t) const;
-	virtual vector	tangent(double t) const;
-	virtual vector	normal(double t) const;
+	virtual curvepoint	evaluate(double t) const;
 };
 
 extern Nef_polyhedron	build_xcharacteristics();
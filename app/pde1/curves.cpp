@@ -15,12 +15,12 @@ point	InitialCurve::position(double t) const {
 	return point(0., t, a * t * t);
 }
 
-vector	InitialCurve::tangent(double t) const {
-	return vector(0., 1., 2 * a * t);
-}
-
-vector	InitialCurve::normal(double /* t */) const {
-	return vector(0., 0., 2 * a);
+curvepoint	InitialCurve::evaluate(double t) const {
+	curvepoint	result;
+	result.p = position(t);
+	result.d1 = vector(0., 1., 2 * a * t);
+	result.d2 = vector(0., 0., 2 * a);
+	return result;
 }
 
 Nef_polyhedron	build_initialcurve() {
@@ -29,6 +29,7 @@ Nef_polyhedron	build_initialcurve() {
 	InitialCurve	ic;
 	Build_Curve	initialcurve(ic, interval,
 				steps, phisteps, largecurveradius);
+	initialcurve.clip(imagebox);
 	p.delegate(initialcurve);
 	return Nef_polyhedron(p);
 }
@@ -41,12 +42,12 @@ point	FCurve::position(double t) const {
 	return point(t, 0., -a * t * t);
 }
 
-vector	FCurve::tangent(double t) const {
-	return vector(1., 0., -2 * a * t);
-}
-
-vector	FCurve::normal(double /* t */) const {
-	return vector(0., 0., -2 * a);
+curvepoint	FCurve::evaluate(double t) const {
+	curvepoint	result;
+	result.p = position(t);
+	result.d1 = vector(1., 0., -2 * a * t);
+	result.d2 = vector(0., 0., -2 * a);
+	return result;
 }
 
 Nef_polyhedron	build_fcurve() {
@@ -55,6 +56,7 @@ Nef_polyhedron	build_fcurve() {
 	FCurve	fc;
 	Build_Curve	fcurve(fc, interval,
 				steps, phisteps, largecurveradius);
+	fcurve.clip(imagebox);
 	p.delegate(fcurve);
 	return Nef_polyhedron(p);
 }
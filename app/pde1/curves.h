@@ -15,8 +15,7 @@ namespace csg {
 class InitialCurve : public CurveFunction {
 public:
 	virtual point	position(double t) const;
-	virtual vector	tangent(double t) const;
-	virtual vector	normal(double t) const;
+	virtual curvepoint	evaluate(double t) const;
 };
 
 extern Nef_polyhedron	build_initialcurve();
@@ -24,8 +23,7 @@ extern Nef_polyhedron	build_initialcurve();
 class FCurve : public CurveFunction {
 public:
 	virtual point	position(double t) const;
-	virtual vector	tangent(double t) const;
-	virtual vector	normal(double t) const;
+	virtual curvepoint	evaluate(double t) const;
 };
 
 extern Nef_polyhedron	build_fcurve();
@@ -6,6 +6,8 @@
 #ifndef _pde1_h
 #define _pde1_h
 
+#include <Bounds.h>
+
 namespace csg {
 
 extern double	a;
@@ -17,6 +19,7 @@ extern int	steps;
 extern int	phisteps;
 extern double	charstep;
 extern bool	yzslicing;
+extern bounds	imagebox;
 
 } // namespace csg
 
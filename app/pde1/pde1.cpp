@@ -18,6 +18,8 @@
 #include <debug.h>
 #include <Box.h>
 #include <Cartesian.h>
+#include <Components.h>
+#include <Expression.h>
 #include <CGAL/IO/Polyhedron_iostream.h>
 #include <CGAL/IO/Nef_polyhedron_iostream_3.h>
 
@@ -36,6 +38,9 @@ double	smallcurveradius = 0.04;
 double	arrowdiameter = 0.04;
 double	largecurveradius = 0.060;
 
+// the image is restricted to this box, builders only create what is inside
+bounds	imagebox(point(-0.1, -2, -2), point(4, 2, 2));
+
 bool	show_solution = true;
 bool	show_characteristics = true;
 bool	show_alternatives = true;
@@ -45,13 +50,30 @@ bool	show_negative = true;
 bool	show_support = false;
 bool	show_fcurve = true;
 
+output_format	format = OFF_FORMAT;
+
+/**
+ * \brief All parameters the components depend on, for the cache
+ */
+static std::string	parameters() {
+	char	buffer[1024];
+	snprintf(buffer, sizeof(buffer), "pde1 a=%.17g speed=%.17g steps=%d "
+		"charstep=%.17g phisteps=%d sheetthickness=%.17g "
+		"smallcurveradius=%.17g arrowdiameter=%.17g "
+		"largecurveradius=%.17g yzslicing=%d", a, speed, steps,
+		charstep, phisteps, sheetthickness, smallcurveradius,
+		arrowdiameter, largecurveradius, (yzslicing) ? 1 : 0);
+	return std::string(buffer);
+}
+
 /** 
  * \brief main function for example6
  */
 int	main(int argc, char *argv[]) {
 
 	int	c;
-	while (EOF != (c = getopt(argc, argv, "dSACIXNPFxp:")))
+	ComponentCache	cache;
+	while (EOF != (c = getopt(argc, argv, "dSACIXNPFxp:j:O:K:")))
 		switch (c) {
 		case 'd':
 			if (debuglevel == LOG_DEBUG) {
@@ -90,112 +112,67 @@ int	main(int argc, char *argv[]) {
 		case 'x':
 			yzslicing = false;
 			break;
+		case 'j':
+			ThreadPool::concurrency(atoi(optarg));
+			break;
+		case 'O':
+			format = format_from_string(optarg);
+			break;
+		case 'K':
+			cache = ComponentCache(optarg);
+			break;
 		}
 
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "nonuniqueness of solution of a "
 		"partial differential equation");
 
-	// start building up the union of things to be restricted to a box
-	Nef_nary_union	unioner;
-
-	// create a the solution surface
-	try {
-		if (show_solution) {
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "adding solution surface");
-			unioner.add_polyhedron(build_solution(sheetthickness));
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "solution surface added");
-		}
-	} catch (std::exception& x) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "failed to add solution: %s",
-			x.what());
+	// collect the components of the image, they are independent and
+	// are built concurrently
+	Components	components;
+	components.cache(cache, parameters());
+	if (show_solution) {
+		components.add("solution surface",
+			[]() { return build_solution(sheetthickness); });
 	}
-
-	// create an alternative solution surface
-	try {
-		if (show_alternatives) {
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "adding alternatives");
-			unioner.add_polyhedron(build_alternative(sheetthickness));
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "alternatives added");
-		}
-	} catch (std::exception& x) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "failed to add alternatives: %s",
-			x.what());
+	if (show_alternatives) {
+		components.add("alternatives",
+			[]() { return build_alternative(sheetthickness); });
 	}
-
-	// add additional characteristics
-	try {
-		if (show_characteristics) {
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "adding characteristics");
-			unioner.add_polyhedron(build_characteristics());
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "characteristics added");
-		}
-	} catch (std::exception& x) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "failed to add characteristics: %s",
-			x.what());
+	if (show_characteristics) {
+		components.add("characteristics",
+			[]() { return build_characteristics(); });
 	}
-
-	// add negative characteristics
-	try {
-		if (show_negative) {
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "adding neg characteristics");
-			unioner.add_polyhedron(build_xcharacteristics());
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "neg characteristics added");
-		}
-	} catch (std::exception& x) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "failed to add negative characteristics: %s",
-			x.what());
+	if (show_negative) {
+		components.add("negative characteristics",
+			[]() { return build_xcharacteristics(); });
 	}
-
-	// add the FCurve
-	try {
-		if (show_fcurve) {
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "adding fcurve");
-			unioner.add_polyhedron(build_fcurve());
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "fcurve added");
-		}
-	} catch (std::exception& x) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "failed to add fcurve: %s",
-			x.what());
+	if (show_fcurve) {
+		components.add("fcurve",
+			[]() { return build_fcurve(); });
 	}
-
-	// add the support sheet
-	try {
-		if (show_support) {
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "adding support");
-			unioner.add_polyhedron(build_support(sheetthickness));
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "support added");
-		}
-	} catch (std::exception& x) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "failed to add support: %s",
-			x.what());
+	if (show_support) {
+		components.add("support",
+			[]() { return build_support(sheetthickness); });
 	}
-
-	// add the initial curve
 	if (show_initial) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "adding initial curve");
-		unioner.add_polyhedron(build_initialcurve());
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "initial curve added");
+		components.add("initial curve",
+			[]() { return build_initialcurve(); });
 	}
 
-	// extract union
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "extract the image component union");
-	Nef_polyhedron	image = unioner.get_union();
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "base image constructed");
-
-	// restrict everything to a box
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "restrict to a box");
-	Build_Box	box(point(-0.1, -2, -2), point(4, 2, 2));
-        Polyhedron      boxp;
-        boxp.delegate(box);
-	image = image * boxp;
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "restriction complete");
-
-	// add axes
+	// restrict the components to a box and add the axes, nothing is
+	// built before the whole expression is evaluated
+	Expression	image_expression = components.expression()
+		* Expression::box(imagebox.min(), imagebox.max());
 	if (show_axes) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "adding axes");
-		image = image + build_axes();
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "axes added");
+		image_expression = image_expression + Expression::leaf("axes",
+			[cache]() {
+				return cache.get("axes\n" + parameters(),
+					[]() { return build_axes(); });
+			});
 	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "evaluate the image expression");
+	Nef_polyhedron	image = image_expression.evaluate();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "image constructed");
 
 	// output 
 	Polyhedron	P;
@@ -205,11 +182,13 @@ int	main(int argc, char *argv[]) {
 
 	// write parts
 	if (prefix.size() > 0) {
-		PartWriter	pw(prefix);
-		pw(PartWriter::LEFT_PART, image);
-		pw(PartWriter::RIGHT_PART, image);
-		pw(PartWriter::FRONT_PART, image);
-		pw(PartWriter::BACK_PART, image);
+		PartWriter	pw(prefix, format);
+		std::vector<PartWriter::object_part>	parts;
+		parts.push_back(PartWriter::LEFT_PART);
+		parts.push_back(PartWriter::RIGHT_PART);
+		parts.push_back(PartWriter::FRONT_PART);
+		parts.push_back(PartWriter::BACK_PART);
+		pw(parts, image);
 	} else {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "part output suppressed");
 	}
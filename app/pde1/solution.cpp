@@ -8,12 +8,10 @@
 #include <Cartesian.h>
 #include <math.h>
 #include <parameters.h>
-#include <CGAL/Nef_nary_union_3.h>
+#include <Components.h>
 
 namespace csg {
 
-typedef CGAL::Nef_nary_union_3<Nef_polyhedron>  Nef_nary_union;
-
 bool	yzslicing = true;
 
 static double	h0(double x) {
@@ -67,6 +65,10 @@ Nef_polyhedron	build_solution(double thickness) {
 	BaseSolution	basesolution;
 	Build_CartesianPointFunction	b(basesolution, domain,
 		2 * steps, 2 * steps, thickness);
+	// the sheet is thickness / 2 thick, stay below half of that
+	b.decimation(thickness / 8);
+	b.validation(true);
+	b.clip(imagebox);
 	p.delegate(b);
 	return Nef_polyhedron(p);
 }
@@ -117,40 +119,62 @@ point	AlternativeSolution::p(double xi, double eta) const {
 }
 
 vector	AlternativeSolution::v(double xi, double eta) const {
+	point	_p;
+	vector	_v;
+	pv(xi, eta, _p, _v);
+	return _v;
+}
+
+/**
+ * \brief Compute point and normal together
+ *
+ * Both need the same coordinates and the value of F there, so computing
+ * them in one go saves the pow and sqrt/exp calls p and v would repeat.
+ */
+void	AlternativeSolution::pv(double xi, double eta, point& _p, vector& _v) const {
 	double	xx = x(xi, eta);
 	double	yy = y(xi, eta);
+	double	zz = F(xx, yy);
+	_p = point(xx, yy, zz);
 	if (yzslicing) {
 		double	dy = 0.0001;
-		double	derivative = (F(xx, yy + dy) - F(xx, yy)) / dy;
-		vector	n =  vector(0., -derivative, 1.).normalized();
-		return n;
+		double	derivative = (F(xx, yy + dy) - zz) / dy;
+		_v = vector(0., -derivative, 1.).normalized();
 	} else {
 		double	dx = 0.0001;
-		double	derivative = (F(xx + dx, yy) - F(xx, yy)) / dx;
-		vector	n =  vector(-derivative, 0., 1.).normalized();
-		return n;
+		double	derivative = (F(xx + dx, yy) - zz) / dx;
+		_v = vector(-derivative, 0., 1.).normalized();
 	}
 }
 
 double	AlternativeSolution::gamma = 1.5;
 
+static Nef_polyhedron	build_alternative(double m, double thickness) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "m = %f", m);
+	CartesianDomain	xietadomain(Interval(0, 1), Interval(0, 1));
+	AlternativeSolution	altsolution(m);
+	// the surface is flat in large parts, refine only where it is not
+	Build_CartesianPointFunction	a(altsolution,
+		xietadomain, 4 * steps, 4 * steps, thickness);
+	a.tolerance(thickness / 4);
+	a.clip(imagebox);
+	Polyhedron	p;
+	p.delegate(a);
+	return Nef_polyhedron(p);
+}
+
 Nef_polyhedron	build_alternative(double thickness) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "build alternative solution surfaces");
-	Nef_nary_union	unioner;
-	CartesianDomain	xietadomain(Interval(0, 1), Interval(0, 1));
+	Components	components;
 	for (double m = 0.5; m > -0.6; m -= 0.25) {
 	//for (double m = 0.25; m > 0.2; m -= 0.25) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "m = %f", m);
-		AlternativeSolution	altsolution(m);
-		Build_CartesianPointFunction	a(altsolution,
-			xietadomain, 2 * steps, 2 * steps, thickness);
-		Polyhedron	p;
-		p.delegate(a);
-		Nef_polyhedron	n(p);
-		unioner.add_polyhedron(n);
+		components.add("alternative solution",
+			[m, thickness]() {
+				return build_alternative(m, thickness);
+			});
 	}
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "get union");
-	return unioner.get_union();
+	return components.get_union();
 }
 
 } // namespace csg
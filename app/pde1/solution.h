@@ -13,13 +13,13 @@ namespace csg {
 
 extern bool yzslicing;
 
-class Solution : public PointFunction {
+class Solution : public BatchPointFunction<Solution> {
 public:
 	virtual point	p(double y0, double t) const;
 	virtual vector	v(double y0, double t) const;
 };
 
-class BaseSolution : public PointFunction {
+class BaseSolution : public BatchPointFunction<BaseSolution> {
 public:
 	virtual point	p(double x, double y) const;
 	virtual vector	v(double x, double y) const;
@@ -27,7 +27,7 @@ public:
 
 Nef_polyhedron	build_solution(double thickness);
 
-class AlternativeSolution : public PointFunction {
+class AlternativeSolution : public BatchPointFunction<AlternativeSolution> {
 	double	mu;
 	double	F(double x, double y) const;
 	static double	gamma;
@@ -37,6 +37,7 @@ public:
 	AlternativeSolution(double _mu);
 	virtual point	p(double xi, double eta) const;
 	virtual vector	v(double xi, double eta) const;
+	virtual void	pv(double xi, double eta, point& p, vector& v) const;
 };
 
 Nef_polyhedron   build_alternative(double thickness);
@@ -53,6 +53,7 @@ Nef_polyhedron	build_support(double thickness) {
 		CharSupport	support;
 		Build_CartesianPointFunction	s(support,
 				domain, 4 * steps, 2, thickness);
+		s.clip(imagebox);
 		Polyhedron	p;
 		p.delegate(s);
 		return	Nef_polyhedron(p);
@@ -61,6 +62,7 @@ Nef_polyhedron	build_support(double thickness) {
 		SupportSheet	support;
 		Build_CartesianPointFunction	s(support,
 				domain, steps, steps, thickness);
+		s.clip(imagebox);
 		Polyhedron	p;
 		p.delegate(s);
 		return	Nef_polyhedron(p);
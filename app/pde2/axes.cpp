@@ -9,11 +9,12 @@
 #include <common.h>
 #include <Arrow.h>
 #include <debug.h>
+#include <Union.h>
 
 namespace csg {
 
 Nef_polyhedron	build_axes() {
-	Nef_nary_union	unioner;
+	Parallel_nary_union	unioner;
 	// now add the various components, starting with the X-axis
 	try {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "add X-axis");
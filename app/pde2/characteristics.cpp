@@ -8,8 +8,11 @@
 
 #include <characteristics.h>
 #include <Curve.h>
+#include <DistanceField.h>
 #include <Box.h>
 #include <debug.h>
+#include <Components.h>
+#include <parameters.h>
 
 namespace csg {
 
@@ -23,42 +26,60 @@ public:
 	virtual point	position(double t) const {
 		return point(t, 0.5 * t * t + _y0, _z0 * exp(-t));
 	}
-	virtual vector	tangent(double t) const {
-		return vector(1, t, -_z0 * exp(-t));
-	}
-	virtual vector normal(double t) const {
-		return vector(0, 1, _z0 * exp(-t));
+	virtual curvepoint	evaluate(double t) const {
+		double	e = _z0 * exp(-t);
+		curvepoint	c;
+		c.p = point(t, 0.5 * t * t + _y0, e);
+		c.d1 = vector(1, t, -e);
+		c.d2 = vector(0, 1, e);
+		return c;
 	}
 };
 
+static Nef_polyhedron	build_characteristic(double y0, int phisteps,
+				int curvesteps) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "add characteristic for y0 = %f", y0);
+	// build a characteristic curve vor a particular y0 vaule
+	Interval	interval(0, 1.9);
+	Characteristic	characteristic(y0, sin(y0));
+	Build_Curve	charcurve(characteristic, interval,
+				curvesteps, phisteps, characteristicradius);
+	charcurve.frames(Build_Curve::ROTATION_MINIMIZING_FRAMES);
+	charcurve.maxangle(M_PI / 36);
+	charcurve.clip(imagebox);
+	charcurve.validation(true);
+	Polyhedron	p;
+	p.delegate(charcurve);
+	return Nef_polyhedron(p);
+}
+
 Nef_polyhedron	build_characteristics(int phisteps, int curvesteps) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "adding characteristics");
-	// the charcurves Nef_polyhedron is used to accumulate
-	// the characteristic curves
-	Nef_nary_union	unioner;
-	Interval	interval(0, 1.9);
+	// the curves are independent, they are built concurrently
+	// and accumulated in a union afterwards
+	Components	components;
 	for (double y0 = -M_PI / 2; y0 <= M_PI + 0.01;
 		y0 += M_PI / 8) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0,
-			"add characteristic for y0 = %f", y0);
-		// build a characteristic curve vor a particular
-		// y0 vaule
-		Characteristic	characteristic(y0, sin(y0));
-		Build_Curve	charcurve(characteristic, interval,
-					curvesteps, phisteps, 0.03);
-		Polyhedron	p;
-		p.delegate(charcurve);
-		Nef_polyhedron	n(p);
-
-		// add the curve to the union
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "add curve to union");
-		unioner.add_polyhedron(n);
+		components.add("characteristic", [y0, phisteps, curvesteps]() {
+			return build_characteristic(y0, phisteps, curvesteps);
+		});
 	}
 
 	// add the curve to the accumulator
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "extract union");
-	Nef_polyhedron	charcurves = unioner.get_union();
-	return charcurves;
+	return components.get_union();
+}
+
+distancefield_ptr	characteristics_field(int curvesteps) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "characteristics field");
+	std::vector<distancefield_ptr>	tubes;
+	for (double y0 = -M_PI / 2; y0 <= M_PI + 0.01;
+		y0 += M_PI / 8) {
+		Characteristic	characteristic(y0, sin(y0));
+		tubes.push_back(tube_field(characteristic, Interval(0, 1.9),
+			curvesteps, characteristicradius));
+	}
+	return union_field(tubes);
 }
 
 } // namespace csg
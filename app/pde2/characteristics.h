@@ -7,10 +7,12 @@
 #define _characteristics_h
 
 #include <common.h>
+#include <DistanceField.h>
 
 namespace csg {
 
 extern Nef_polyhedron	build_characteristics(int phisteps, int curvesteps);
+extern distancefield_ptr	characteristics_field(int curvesteps);
 
 } // namespace csg
 
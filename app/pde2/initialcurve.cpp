@@ -9,6 +9,8 @@
 #include <common.h>
 #include <debug.h>
 #include <Curve.h>
+#include <DistanceField.h>
+#include <parameters.h>
 
 namespace csg {
 
@@ -19,20 +21,35 @@ class Sine : public CurveFunction {
 public:
 	Sine() : CurveFunction() { }
 	virtual point	position(double t) const { return point(0, t, sin(t)); }
-	virtual vector	tangent(double t) const { return vector(0, 1, cos(t)); }
-	virtual vector	normal(double t) const { return vector::e3; }
+	virtual curvepoint	evaluate(double t) const {
+		curvepoint	c;
+		c.p = point(0, t, sin(t));
+		c.d1 = vector(0, 1, cos(t));
+		// the second derivative vanishes at the inflection points
+		c.d2 = vector::e3;
+		return c;
+	}
 };
 
 Nef_polyhedron	build_initialcurve(int curvesteps, int phisteps) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "adding initial curve");
 	Interval	interval(-0.1, M_PI + 0.1);
 	Sine		sine;
-	Build_Curve	cauchycurve(sine, interval, curvesteps, phisteps, 0.04);
+	Build_Curve	cauchycurve(sine, interval, curvesteps, phisteps,
+				initialcurveradius);
+	cauchycurve.clip(imagebox);
 	Polyhedron	p;
 	p.delegate(cauchycurve);
 	return Nef_polyhedron(p);
 }
 
+distancefield_ptr	initialcurve_field(int curvesteps) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "initial curve field");
+	Sine		sine;
+	return tube_field(sine, Interval(-0.1, M_PI + 0.1), curvesteps,
+		initialcurveradius);
+}
+
 } // namespace csg
 
 #endif /* _initialcurve_h */
@@ -7,10 +7,12 @@
 #define _initialcurve_h
 
 #include <common.h>
+#include <DistanceField.h>
 
 namespace csg {
 
 extern Nef_polyhedron	build_initialcurve(int curvesteps, int phisteps);
+extern distancefield_ptr	initialcurve_field(int curvesteps);
 
 } // namespace csg
 
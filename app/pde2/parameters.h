@@ -7,6 +7,7 @@
 #define _parameters_h
 
 #include <string>
+#include <Bounds.h>
 
 namespace csg {
 
@@ -15,6 +16,9 @@ extern int	curvesteps;
 extern double	radius;
 extern std::string	prefix;
 extern double	thickness;
+extern double	characteristicradius;
+extern double	initialcurveradius;
+extern bounds	imagebox;
 
 } // namespace csg
 
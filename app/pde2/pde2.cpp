@@ -20,6 +20,9 @@
 #include <initialcurve.h>
 #include <Parts.h>
 #include <Box.h>
+#include <Components.h>
+#include <Expression.h>
+#include <DualContouring.h>
 
 namespace csg {
 
@@ -27,7 +30,91 @@ int	phisteps = 16;
 int	curvesteps = 30;
 double	radius = 0.1;
 double	thickness = 0.03;
+// tube radii, shared by the exact builders and the distance fields
+double	characteristicradius = 0.03;
+double	initialcurveradius = 0.04;
+double	resolution = 0;
+
+// the image is restricted to this box, builders only create what is inside
+bounds	imagebox(point(-0.1, 0, -1), point(1.8, M_PI, 1.1));
 std::string	prefix("characteristics");
+output_format	format = OFF_FORMAT;
+
+/**
+ * \brief All parameters the components depend on, for the cache
+ */
+static std::string	parameters() {
+	char	buffer[1024];
+	snprintf(buffer, sizeof(buffer), "pde2 phisteps=%d curvesteps=%d "
+		"radius=%.17g thickness=%.17g resolution=%.17g", phisteps,
+		curvesteps, radius, thickness, resolution);
+	return std::string(buffer);
+}
+
+/**
+ * \brief Exact image components restricted to the image box
+ *
+ * The components of the image are independent, they are built
+ * concurrently when the image expression is evaluated.
+ */
+static Expression	components_expression(const ComponentCache& cache,
+	bool initialcurve, bool characteristics, bool solutionsurface) {
+	Components	components;
+	components.cache(cache, parameters());
+
+	// adding the initial curve
+	if (initialcurve) {
+		components.add("initial curve", []() {
+			return build_initialcurve(curvesteps, phisteps);
+		});
+	} else {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "initial curve suppressed");
+	}
+
+	// adding the characteristics
+	if (characteristics) {
+		components.add("characteristics", []() {
+			return build_characteristics(phisteps, curvesteps);
+		});
+	} else {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "characterstics suppressed");
+	}
+
+	// adding the solution surface
+	if (solutionsurface) {
+		components.add("solution surface", []() {
+			return build_solution();
+		});
+	} else {
+		debug(LOG_DEBUG, DEBUG_LOG, 0,
+			"solution surface suppressed");
+	}
+
+	// restrict what we have so far to a box
+	return components.expression()
+		* Expression::box(imagebox.min(), imagebox.max());
+}
+
+/**
+ * \brief Mesh the union of the component distance fields inside the image box
+ */
+static Nef_polyhedron	build_field(bool initialcurve, bool characteristics,
+	bool solutionsurface) {
+	std::vector<distancefield_ptr>	fields;
+	if (initialcurve) {
+		fields.push_back(initialcurve_field(curvesteps));
+	}
+	if (characteristics) {
+		fields.push_back(characteristics_field(curvesteps));
+	}
+	if (solutionsurface) {
+		fields.push_back(solution_field());
+	}
+	Build_DistanceField	b(union_field(fields), imagebox, resolution);
+	Polyhedron	p;
+	p.delegate(b);
+	return Nef_polyhedron(p);
+}
 
 /** 
  * \brief main function for example5
@@ -39,7 +126,8 @@ int	main(int argc, char *argv[]) {
 	bool	characteristics = true;
 	bool	supportstructure = true;
 	bool	axesincluded = true;
-	while (EOF != (c = getopt(argc, argv, "r:ds:p:ICSc:XA")))
+	ComponentCache	cache;
+	while (EOF != (c = getopt(argc, argv, "r:ds:p:ICSc:XAj:O:K:F:")))
 		switch (c) {
 		case 'c':
 			curvesteps = atoi(optarg);
@@ -71,84 +159,81 @@ int	main(int argc, char *argv[]) {
 		case 'p':
 			prefix = std::string(optarg);
 			break;
+		case 'j':
+			ThreadPool::concurrency(atoi(optarg));
+			break;
+		case 'O':
+			format = format_from_string(optarg);
+			break;
+		case 'K':
+			cache = ComponentCache(optarg);
+			break;
+		case 'F':
+			resolution = atof(optarg);
+			break;
 		}
 
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "3 lines of radius %f", radius);
 
-	// here is Nef_nary_union which we use to build up the image
-	Nef_nary_union	unioner;
-
-	// adding the initial curve
-	if (initialcurve) {
-		try {
-			unioner.add_polyhedron(build_initialcurve(curvesteps, phisteps));
-		} catch (std::exception& x) {
-			fprintf(stderr, "exception while adding initial curve: %s\n", x.what());
-		} catch (...) {
-			fprintf(stderr, "exception while adding initial curve\n");
-		}
+	// with a resolution, the curves and the solution surface are
+	// combined as distance fields and meshed in a single leaf, which
+	// avoids the exact boolean operations between them
+	Expression	image_expression;
+	if (resolution > 0) {
+		char	buffer[64];
+		snprintf(buffer, sizeof(buffer), "field %d%d%d\n",
+			initialcurve, characteristics, solutionsurface);
+		std::string	key(buffer);
+		image_expression = Expression::leaf("field", [cache, key,
+			initialcurve, characteristics, solutionsurface]() {
+			try {
+				return cache.get(key + parameters(), [initialcurve,
+					characteristics, solutionsurface]() {
+					return build_field(initialcurve,
+						characteristics, solutionsurface);
+				});
+			} catch (std::exception& x) {
+				// the image is useless without the field
+				debug(LOG_ERR, DEBUG_LOG, 0, "cannot build field: %s",
+					x.what());
+				fprintf(stderr, "exception while adding field: %s\n",
+					x.what());
+				throw;
+			}
+		}, imagebox);
 	} else {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "initial curve suppressed");
+		image_expression = components_expression(cache, initialcurve,
+			characteristics, solutionsurface);
 	}
 
-	// adding the characteristics
-	if (characteristics) {
-		try {
-			// create the characteristic curves
-			debug(LOG_DEBUG, DEBUG_LOG, 0,
-				"adding characteristics to image");
-			unioner.add_polyhedron(
-				build_characteristics(phisteps, curvesteps));
-		} catch (std::exception& x) {
-			fprintf(stderr, "exception while adding characteristics: %s\n", x.what());
-		} catch (...) {
-			fprintf(stderr, "exception while adding characteristics\n");
-		}
-	} else {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "characterstics suppressed");
-	}
-
-	// adding the solution surface
-	if (solutionsurface) {
-		try {
-			debug(LOG_DEBUG, DEBUG_LOG, 0,
-				"adding solution surface");
-			unioner.add_polyhedron(build_solution());
-		} catch (std::exception& x) {
-			fprintf(stderr, "exception while adding solution "
-				"surface: %s\n", x.what());
-		} catch (...) {
-			fprintf(stderr, "exception while adding solution "
-				"surface\n");
-		}
-	} else {
-		debug(LOG_DEBUG, DEBUG_LOG, 0,
-			"solution surface suppressed");
-	}
-
-	// restrict what we have so far to a box
-	Build_Box	box(point(-0.1, 0, -1), point(1.8, M_PI, 1.1));
-	Polyhedron	boxp;
-	boxp.delegate(box);
-	Nef_polyhedron	image = Nef_polyhedron(boxp) * unioner.get_union();
-
 	// add the support structure
 	if (supportstructure) {
-		try {
-			image = image + build_support(thickness);
-		} catch(...) {
-			fprintf(stderr, "exceptin while adding support");
-		}
+		image_expression = image_expression + Expression::leaf("support",
+			[cache]() {
+				try {
+					return cache.get("support\n" + parameters(),
+						[]() { return build_support(thickness); });
+				} catch(...) {
+					fprintf(stderr, "exceptin while adding support");
+				}
+				return Nef_polyhedron();
+			});
 	}
 
 	// now add the various components, starting with the X-axis
 	if (axesincluded) {
-		try {
-			image = image + build_axes();
-		} catch(...) {
-			fprintf(stderr, "exceptin while adding axes");
-		}
+		image_expression = image_expression + Expression::leaf("axes",
+			[cache]() {
+				try {
+					return cache.get("axes\n" + parameters(),
+						[]() { return build_axes(); });
+				} catch(...) {
+					fprintf(stderr, "exceptin while adding axes");
+				}
+				return Nef_polyhedron();
+			});
 	}
+	Nef_polyhedron	image = image_expression.evaluate();
 
 	// output union
 	Polyhedron	P;
@@ -158,9 +243,11 @@ int	main(int argc, char *argv[]) {
 	// now we have to cut along the y-z-plane, because otherwise it would
 	// hardly be printable
 	if (prefix.size() > 0) {
-		PartWriter	pw(prefix);
-		pw(PartWriter::LEFT_PART, image);
-		pw(PartWriter::RIGHT_PART, image);
+		PartWriter	pw(prefix, format);
+		std::vector<PartWriter::object_part>	parts;
+		parts.push_back(PartWriter::LEFT_PART);
+		parts.push_back(PartWriter::RIGHT_PART);
+		pw(parts, image);
 	} else {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "part output suppressed");
 	}
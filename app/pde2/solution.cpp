@@ -22,14 +22,38 @@ public:
 	}
 };
 
+/**
+ * \brief Total thickness of the solution sheet
+ *
+ * Build_CartesianFunction puts the two layers at f +- h/4, so the sheet
+ * built with h = thickness is only thickness / 2 thick. The distance
+ * field is given the same total thickness.
+ */
+static double	sheetthickness() {
+	return thickness / 2;
+}
+
 Nef_polyhedron	build_solution() {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "adding solution surface");
 	CartesianDomain	domain(Interval(0, 1.8), Interval(0, M_PI));
 	Solution	sol;
-	Build_CartesianFunction	b(sol, domain, curvesteps, curvesteps, thickness);
+	Build_CartesianFunction	b(sol, domain, curvesteps, curvesteps,
+		2 * sheetthickness());
+	// stay below half the sheet thickness
+	b.decimation(sheetthickness() / 4);
+	b.validation(true);
+	b.clip(imagebox);
 	Polyhedron	p;
 	p.delegate(b);
 	return Nef_polyhedron(p);
 }
 
+distancefield_ptr	solution_field() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "solution surface field");
+	CartesianDomain	domain(Interval(0, 1.8), Interval(0, M_PI));
+	Solution	sol;
+	return sheet_field(sol, domain, curvesteps, curvesteps,
+		sheetthickness());
+}
+
 } // namespace csg
@@ -7,10 +7,12 @@
 #define _solution_h
 
 #include <common.h>
+#include <DistanceField.h>
 
 namespace csg {
 
 extern Nef_polyhedron	build_solution();
+extern distancefield_ptr	solution_field();
 
 } // namespace csg
 
@@ -10,46 +10,49 @@
 #include <math.h>
 #include <parameters.h>
 #include <Box.h>
+#include <Boolean.h>
 
 namespace csg {
 
-point	Characteristic::position(double t) const {
-	point	p(-r * cos(t), -r * sin(t), f(r) * t);
-	return p;
-}
-
-vector	Characteristic::tangent(double t) const {
-	vector	v(r * sin(t), -r * cos(t), f(r));
-	return v;
-}
+Characteristic::Characteristic(const double _r) : r(_r), slope(f(_r)) { }
 
-static void	add_characteristic(Nef_nary_union& unioner, double r) {
+static void	add_characteristic(Mesh_nary_union& unioner, double r) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "add characteristic for r = %f", r);
 	Interval	interval(-M_PI - 0.01, M_PI + 0.01);
 	Characteristic	cs(r);
 	Build_Curve	charcurve(cs, interval, 3 * steps, 12,
 				smallcurveradius);
+	charcurve.frames(Build_Curve::ROTATION_MINIMIZING_FRAMES);
+	charcurve.maxangle(M_PI / 36);
+	charcurve.clip(imagebox);
+	charcurve.validation(true);
 	Polyhedron	p;
 	p.delegate(charcurve);
-	Nef_polyhedron	n(p);
-	unioner.add_polyhedron(n);
+	unioner.add_polyhedron(p);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "curve added");
 }
 
 Nef_polyhedron	build_characteristics() {
-	Nef_nary_union	unioner;
+	Mesh_nary_union	unioner(boolean_engine);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "add characteristics");
 	for (double r = 2.5; r > 0.4; r -= 0.5) {
 		add_characteristic(unioner, r);
 	}
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "extract union of characteristics");
-	Nef_polyhedron	characteristics = unioner.get_union();
+	Polyhedron	characteristics;
+	Nef_polyhedron	nefcharacteristics;
+	bool	simple = unioner.get_union(characteristics, nefcharacteristics);
 
-	Build_Box	box(point(-2, -2, -2), point(2, 2, 2));
+	Build_Box	box(imagebox.min(), imagebox.max());
 	Polyhedron	boxp;
 	boxp.delegate(box);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "intersect with box");
-	return characteristics * boxp;
+	if (!simple) {
+		// touching characteristics, stay with Nef polyhedra
+		return nefcharacteristics * Nef_polyhedron(boxp);
+	}
+	Boolean	boolean(boolean_engine);
+	return boolean.evaluate(characteristics, boxp, Boolean::INTERSECTION);
 }
 
 } // namespace csg
@@ -14,13 +14,20 @@
 
 namespace csg {
 
-class Characteristic : public CurveFunction {
+/**
+ * \brief Characteristic curve, derivatives by automatic differentiation
+ */
+class Characteristic : public AutoCurveFunction<Characteristic> {
 	double	r;
+	double	slope;
 public:
-	Characteristic(const double _r, double deltat = 0.0001)
-		: CurveFunction(deltat), r(_r) { }
-	virtual point	position(double t) const;
-	virtual vector	tangent(double t) const;
+	Characteristic(const double _r);
+	template<typename T>
+	void	coordinates(const T& t, T& x, T& y, T& z) const {
+		x = -r * cos(t);
+		y = -r * sin(t);
+		z = slope * t;
+	}
 };
 
 extern Nef_polyhedron	build_characteristics();
@@ -6,6 +6,9 @@
 #ifndef _parameters_h
 #define _parameters_h
 
+#include <Boolean.h>
+#include <Bounds.h>
+
 namespace csg {
 
 extern double	thickness;
@@ -15,6 +18,8 @@ extern double	arrowdiameter;
 extern double	smallcurveradius;
 extern double	a;
 extern double	f(double x);
+extern Boolean::engine_type	boolean_engine;
+extern bounds	imagebox;
 
 };
 
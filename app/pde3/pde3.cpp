@@ -15,6 +15,7 @@
 #include <math.h>
 #include <support.h>
 #include <Parts.h>
+#include <Components.h>
 
 namespace csg {
 
@@ -31,8 +32,13 @@ double	smallcurveradius = 0.04;
 double	a = 1.5;
 double	xa = 1.5;
 double	offset = -0.001;
+Boolean::engine_type	boolean_engine = Boolean::MESH_ENGINE;
+
+// solution and characteristics are restricted to this box
+bounds	imagebox(point(-2, -2, -2), point(2, 2, 2));
 
 std::string	prefix("nosolution");
+output_format	format = OFF_FORMAT;
 
 double	f(double x) {
 	if (x > xa) {
@@ -41,9 +47,22 @@ double	f(double x) {
 	return a * x * x * (3 * xa - 2 * x) / (xa * xa * xa * M_PI);
 }
 
+/**
+ * \brief All parameters the components depend on, for the cache
+ */
+static std::string	parameters() {
+	char	buffer[1024];
+	snprintf(buffer, sizeof(buffer), "pde3 thickness=%.17g h=%.17g "
+		"steps=%d arrowdiameter=%.17g smallcurveradius=%.17g a=%.17g "
+		"xa=%.17g", thickness, h, steps, arrowdiameter,
+		smallcurveradius, a, xa);
+	return std::string(buffer);
+}
+
 int	main(int argc, char *argv[]) {
 	int	c;
-	while (EOF != (c = getopt(argc, argv, "dPXACSp:")))
+	ComponentCache	cache;
+	while (EOF != (c = getopt(argc, argv, "dPXACSnp:j:O:K:")))
 		switch (c) {
 		case 'd':
 			if (debuglevel == LOG_DEBUG) {
@@ -67,67 +86,50 @@ int	main(int argc, char *argv[]) {
 		case 'S':
 			solution_enable = false;
 			break;
+		case 'n':
+			boolean_engine = Boolean::NEF_ENGINE;
+			break;
+		case 'j':
+			ThreadPool::concurrency(atoi(optarg));
+			break;
+		case 'O':
+			format = format_from_string(optarg);
+			break;
 		case 'p':
 			prefix = std::string(optarg);
 			break;
+		case 'K':
+			cache = ComponentCache(optarg);
+			break;
 		}
 
-	Nef_nary_union	unioner;
-
-	// solution
-	try {
-		if (solution_enable) {
-			unioner.add_polyhedron(build_solution(thickness));
-		}
-	} catch (std::exception& x) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "failed to add solution: %s",
-			x.what());
+	// the components are independent, so they can be built concurrently
+	Components	components;
+	components.cache(cache, parameters());
+	if (solution_enable) {
+		components.add("solution",
+			[]() { return build_solution(thickness); });
 	}
-
-	// characteristics
-	try {
-		if (characteristics_enable) {
-			unioner.add_polyhedron(build_characteristics());
-		}
-	} catch (std::exception& x) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "failed to add charactistics: %s",
-			x.what());
+	if (characteristics_enable) {
+		components.add("characteristics",
+			[]() { return build_characteristics(); });
 	}
-
-	// add the cut support
-	try {
-		if (support_enable) {
-			unioner.add_polyhedron(
-				build_cutsupport(2 * thickness));
-		}
-	} catch (std::exception& x) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "failed to add cut supports: %s",
-			x.what());
+	if (support_enable) {
+		components.add("cut supports",
+			[]() { return build_cutsupport(2 * thickness); });
 	}
-
-	// add the axes support
-	try {
-		if (axessupport_enable) {
-			unioner.add_polyhedron(
-				build_axessupport(thickness));
-		}
-	} catch (std::exception& x) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "failed to add axes supports: %s",
-			x.what());
+	if (axessupport_enable) {
+		components.add("axes supports",
+			[]() { return build_axessupport(thickness); });
 	}
-
-	// axes
-	try {
-		if (axes_enable) {
-			unioner.add_polyhedron(build_axes());
-		}
-	} catch (std::exception& x) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "failed to add axes: %s", x.what());
+	if (axes_enable) {
+		components.add("axes",
+			[]() { return build_axes(); });
 	}
 
 	// extract
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "extracting image");
-	Nef_polyhedron	image = unioner.get_union();
+	Nef_polyhedron	image = components.get_union();
 
 	// output
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "convert for output");
@@ -137,13 +139,15 @@ int	main(int argc, char *argv[]) {
 
 	// output halves
 	if (prefix.size() > 0) {
-		PartWriter	pw(prefix);
-		pw(PartWriter::BACK_PART, image, offset);
-		pw(PartWriter::FRONT_PART, image, offset);
-		pw(PartWriter::LEFT_PART, image, offset);
-		pw(PartWriter::RIGHT_PART, image, offset);
-		pw(PartWriter::TOP_PART, image, offset);
-		pw(PartWriter::BOTTOM_PART, image, offset);
+		PartWriter	pw(prefix, format);
+		std::vector<PartWriter::object_part>	parts;
+		parts.push_back(PartWriter::BACK_PART);
+		parts.push_back(PartWriter::FRONT_PART);
+		parts.push_back(PartWriter::LEFT_PART);
+		parts.push_back(PartWriter::RIGHT_PART);
+		parts.push_back(PartWriter::TOP_PART);
+		parts.push_back(PartWriter::BOTTOM_PART);
+		pw(parts, image, offset);
 	} else {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "part output suppressed");
 	}
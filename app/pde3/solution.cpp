@@ -26,6 +26,15 @@ vector	Solution::v(double r, double t) const {
 ;
 }
 
+/**
+ * \brief Compute point and normal with the center point evaluated once
+ */
+void	Solution::pv(double r, double t, point& _p, vector& _v) const {
+	_p = Solution::p(r, t);
+	_v = (Solution::p(r + h, t) - _p).cross(Solution::p(r, t + h) - _p)
+		.normalized();
+}
+
 Nef_polyhedron	build_solution(double thickness) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "building solution surface");
 	Polyhedron	p;
@@ -33,10 +42,13 @@ Nef_polyhedron	build_solution(double thickness) {
 				Interval(-M_PI - 0.01, M_PI + 0.01));
 	Solution	solution(a);
 	Build_PolarPointFunction	s(solution, domain, 2 * steps, 2 * steps, thickness);
+	s.decimation(thickness / 4);
+	s.validation(true);
+	s.clip(imagebox);
 	p.delegate(s);
 	Nef_polyhedron	surface(p);
 
-	Build_Box	box(point(-2, -2, -2), point(2, 2, 2));
+	Build_Box	box(imagebox.min(), imagebox.max());
 	Polyhedron	boxp;
 	boxp.delegate(box);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "intersect with box");
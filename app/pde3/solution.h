@@ -10,12 +10,13 @@
 
 namespace csg {
 
-class Solution : public PointFunction {
+class Solution : public BatchPointFunction<Solution> {
 	double	a;
 public:
 	Solution(double _a) : a(_a) { }
 	virtual point	p(double r0, double t) const;
 	virtual vector	v(double r0, double t) const;
+	virtual void	pv(double r0, double t, point& p, vector& v) const;
 };
 
 Nef_polyhedron	build_solution(double thickness);
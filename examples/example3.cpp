@@ -26,12 +26,14 @@ public:
 		return point(_radius * cos(t), _radius * sin(t), _a * t);
 	}
 
-	virtual vector	tangent(double t) const {
-		return vector(-_radius * sin(t), _radius * cos(t), _a);
-	}
-
-	virtual vector	normal(double t) const {
-		return vector(-cos(t), -sin(t), 0);
+	virtual curvepoint	evaluate(double t) const {
+		double	c = cos(t);
+		double	s = sin(t);
+		curvepoint	result;
+		result.p = point(_radius * c, _radius * s, _a * t);
+		result.d1 = vector(-_radius * s, _radius * c, _a);
+		result.d2 = vector(-_radius * c, -_radius * s, 0);
+		return result;
 	}
 };
 
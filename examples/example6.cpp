@@ -43,11 +43,8 @@ int	main(int argc, char *argv[]) {
 	Nef_polyhedron	n1(p1);
 
 	// create a half space
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "construct a plane");
-	Plane	plane(1,2,3,-1);
-
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "construct a half space");
-	Nef_polyhedron	n2(plane, Nef_polyhedron::INCLUDED);
+	Nef_polyhedron	n2 = halfspace(1, 2, 3, -1);
 
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "intersect with half space");
 	Nef_polyhedron	n3 = n1 * n2; // intersection
@@ -0,0 +1,78 @@
+/*
+ * example7.cpp -- example 7, thickened implicit surface
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <iostream>
+#include <common.h>
+#include <CGAL/IO/Polyhedron_iostream.h>
+#include <Implicit.h>
+#include <ThreadPool.h>
+#include <debug.h>
+
+namespace csg {
+
+/**
+ * \brief Hyperboloid of one sheet x^2 + y^2 - z^2 = 1/4
+ */
+class	Hyperboloid : public ImplicitFunction {
+public:
+	Hyperboloid() { }
+	virtual double	operator()(const point& p) const {
+		return p.x() * p.x() + p.y() * p.y() - p.z() * p.z() - 0.25;
+	}
+	virtual vector	gradient(const point& p, double /* h */) const {
+		return vector(2 * p.x(), 2 * p.y(), -2 * p.z());
+	}
+};
+
+/** 
+ * \brief main function for example7
+ */
+int	main(int argc, char *argv[]) {
+	int	c;
+	double	resolution = 0.02;
+	double	thickness = 0.08;
+	while (EOF != (c = getopt(argc, argv, "dr:t:j:")))
+		switch (c) {
+		case 'd':
+			debuglevel++;
+			break;
+		case 'r':
+			resolution = atof(optarg);
+			break;
+		case 't':
+			thickness = atof(optarg);
+			break;
+		case 'j':
+			ThreadPool::concurrency(atoi(optarg));
+			break;
+		}
+
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "hyperboloid at resolution %f",
+		resolution);
+	Hyperboloid	hyperboloid;
+	Build_Implicit	b(hyperboloid, bounds(point(-1.2, -1.2, -1),
+		point(1.2, 1.2, 1)), resolution, thickness);
+	Polyhedron	P;
+	P.delegate(b);
+	std::cout << P;
+
+	return EXIT_SUCCESS;
+}
+
+} // namespace csg
+
+int	main(int argc, char *argv[]) {
+	try {
+		return csg::main(argc, argv);
+	} catch (std::exception& x) {
+		std::cerr << "terminated by std::exception: " << x.what()
+			<< std::endl;
+	} catch (...) {
+		std::cerr << "terminated by unknown exception" << std::endl;
+	}
+}
@@ -0,0 +1,242 @@
+/*
+ * example8.cpp -- example 8, check the mesh counts of all builders
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <math.h>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <common.h>
+#include <Cartesian.h>
+#include <Polar.h>
+#include <Curve.h>
+#include <SphericalSphere.h>
+#include <SphericalSurface.h>
+#include <IcosahedralSphere.h>
+#include <Arrow.h>
+#include <Box.h>
+#include <debug.h>
+
+namespace csg {
+
+/**
+ * \brief Paraboloid for the cartesian and polar builders
+ */
+class	Paraboloid : public Function {
+public:
+	Paraboloid() { }
+	double	operator()(const double x, const double y) {
+		return (x * x + y * y) / 20;
+	}
+};
+
+/**
+ * \brief Ripples, so that adaptive grids are refined unevenly
+ */
+class	Ripple : public Function {
+public:
+	Ripple() { }
+	double	operator()(const double x, const double y) {
+		return 0.2 * sin(3 * x) * cos(2 * y) + 0.05 * sin(7 * x * y);
+	}
+};
+
+/**
+ * \brief Helix, derivatives from the default finite differences
+ */
+class	Helix : public CurveFunction {
+public:
+	Helix() : CurveFunction(0.001) { }
+	virtual point	position(double t) const {
+		return point(cos(t), sin(t), 0.2 * t);
+	}
+};
+
+/**
+ * \brief Sphere with a wavy radius for the spherical surface builder
+ */
+class	Wavy : public SphericalFunction {
+public:
+	Wavy() { }
+	virtual double	operator()(const double theta, const double phi) {
+		return (1.1 + sin(theta)) * (1 + 0.1 * sin(5 * phi));
+	}
+};
+
+/**
+ * \brief Build a surface and compare it with the expected counts
+ *
+ * Besides the counts, every edge of the mesh must be shared by exactly
+ * two consistently oriented triangles, i.e. the mesh must be closed.
+ */
+static bool	check(const char *name, Build_Surface& b) {
+	IndexedMesh	m = b.mesh();
+	bool	ok = true;
+	if (m.number_of_vertices() != b.expected_vertices()) {
+		fprintf(stderr, "%s: expected %d vertices, got %d\n", name,
+			b.expected_vertices(), m.number_of_vertices());
+		ok = false;
+	}
+	if (m.number_of_triangles() != b.expected_facets()) {
+		fprintf(stderr, "%s: expected %d facets, got %d\n", name,
+			b.expected_facets(), m.number_of_triangles());
+		ok = false;
+	}
+	std::map<std::pair<int, int>, int>	edges;
+	for (int t = 0; t < m.number_of_triangles(); t++) {
+		for (int k = 0; k < 3; k++) {
+			int	a = m.triangles[3 * t + k];
+			int	c = m.triangles[3 * t + (k + 1) % 3];
+			edges[std::make_pair(a, c)]++;
+		}
+	}
+	int	bad = 0;
+	std::map<std::pair<int, int>, int>::const_iterator	e;
+	for (e = edges.begin(); e != edges.end(); e++) {
+		std::pair<int, int>	reverse(e->first.second, e->first.first);
+		std::map<std::pair<int, int>, int>::const_iterator	r
+			= edges.find(reverse);
+		if ((e->second != 1) || (r == edges.end()) || (r->second != 1)) {
+			bad++;
+		}
+	}
+	if (bad > 0) {
+		fprintf(stderr, "%s: %d edges not shared by two triangles\n",
+			name, bad);
+		ok = false;
+	}
+	printf("%-28s %7d vertices %7d facets %s\n", name,
+		m.number_of_vertices(), m.number_of_triangles(),
+		(ok) ? "ok" : "FAILED");
+	return ok;
+}
+
+/**
+ * \brief main function for example8
+ */
+int	main(int argc, char *argv[]) {
+	int	c;
+	int	steps = 20;
+	while (EOF != (c = getopt(argc, argv, "dn:")))
+		switch (c) {
+		case 'd':
+			debuglevel++;
+			break;
+		case 'n':
+			steps = atoi(optarg);
+			break;
+		}
+
+	int	failures = 0;
+	Paraboloid	paraboloid;
+	bounds	clipbox(point(-0.5, -0.5, -1), point(1.5, 0.7, 1));
+
+	Build_CartesianFunction	cartesian(paraboloid,
+		CartesianDomain(Interval(-2, 2), Interval(-1, 1)),
+		steps, steps, 0.1);
+	failures += check("cartesian", cartesian) ? 0 : 1;
+
+	Build_CartesianFunction	cartesianclipped(paraboloid,
+		CartesianDomain(Interval(-2, 2), Interval(-1, 1)),
+		steps, steps, 0.1);
+	cartesianclipped.clip(clipbox);
+	failures += check("cartesian clipped", cartesianclipped) ? 0 : 1;
+
+	Build_PolarFunction	closeddisk(paraboloid,
+		PolarDomain(Interval(0, 2), Interval2Pi), steps, steps, 0.1);
+	failures += check("polar closed disk", closeddisk) ? 0 : 1;
+
+	Build_PolarFunction	closedring(paraboloid,
+		PolarDomain(Interval(1, 2), Interval2Pi), steps, steps, 0.1);
+	failures += check("polar closed ring", closedring) ? 0 : 1;
+
+	Build_PolarFunction	opendisk(paraboloid,
+		PolarDomain(Interval(0, 2), Interval(0, M_PI)),
+		steps, steps, 0.1);
+	failures += check("polar open disk", opendisk) ? 0 : 1;
+
+	Build_PolarFunction	openring(paraboloid,
+		PolarDomain(Interval(1, 2), Interval(0, M_PI)),
+		steps, steps, 0.1);
+	failures += check("polar open ring", openring) ? 0 : 1;
+
+	Build_PolarFunction	polarclipped(paraboloid,
+		PolarDomain(Interval(0, 2), Interval2Pi), steps, steps, 0.1);
+	polarclipped.clip(clipbox);
+	failures += check("polar clipped", polarclipped) ? 0 : 1;
+
+	// adaptive grids, the polar disk wraps around and collapses the
+	// center, the ring does neither
+	Ripple	ripple;
+	Build_CartesianFunction	cartesianadaptive(ripple,
+		CartesianDomain(Interval(-2, 2), Interval(-1, 1)),
+		steps, steps, 0.1);
+	cartesianadaptive.tolerance(0.02);
+	failures += check("cartesian adaptive", cartesianadaptive) ? 0 : 1;
+
+	Build_PolarFunction	diskadaptive(ripple,
+		PolarDomain(Interval(0, 2), Interval2Pi), steps, steps, 0.1);
+	diskadaptive.tolerance(0.02);
+	failures += check("polar closed disk adaptive", diskadaptive) ? 0 : 1;
+
+	Build_PolarFunction	ringadaptive(ripple,
+		PolarDomain(Interval(1, 2), Interval(0, M_PI)),
+		steps, steps, 0.1);
+	ringadaptive.tolerance(0.02);
+	failures += check("polar open ring adaptive", ringadaptive) ? 0 : 1;
+
+	Helix	helix;
+	Build_Curve	curve(helix, Interval(0, 4 * M_PI), 4 * steps, 12, 0.1);
+	failures += check("curve", curve) ? 0 : 1;
+
+	Build_Curve	curveadaptive(helix, Interval(0, 4 * M_PI), steps, 12,
+		0.1);
+	curveadaptive.frames(Build_Curve::ROTATION_MINIMIZING_FRAMES);
+	curveadaptive.maxangle(M_PI / 36);
+	failures += check("curve adaptive", curveadaptive) ? 0 : 1;
+
+	Build_Curve	curveclipped(helix, Interval(0, 4 * M_PI), 4 * steps,
+		12, 0.1);
+	curveclipped.clip(clipbox);
+	failures += check("curve clipped", curveclipped) ? 0 : 1;
+
+	Build_SphericalSphere	sphere(1, steps);
+	failures += check("spherical sphere", sphere) ? 0 : 1;
+
+	Wavy	wavy;
+	Build_SphericalSurface	spherical(wavy, steps);
+	failures += check("spherical surface", spherical) ? 0 : 1;
+
+	Build_Arrow	arrow(point(0, 0, 0), point(1, 2, 3), 0.1, steps);
+	failures += check("arrow", arrow) ? 0 : 1;
+
+	Build_Box	box(point(0, 0, 0), point(1, 2, 3));
+	failures += check("box", box) ? 0 : 1;
+
+	Build_IcosahedralSphere	icosahedral(1, 3);
+	failures += check("icosahedral sphere", icosahedral) ? 0 : 1;
+
+	if (failures > 0) {
+		fprintf(stderr, "%d builders failed\n", failures);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+} // namespace csg
+
+int	main(int argc, char *argv[]) {
+	try {
+		return csg::main(argc, argv);
+	} catch (std::exception& x) {
+		std::cerr << "terminated by std::exception: " << x.what()
+			<< std::endl;
+	} catch (...) {
+		std::cerr << "terminated by unknown exception" << std::endl;
+	}
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,126 @@
+/*
+ * example9.cpp -- example 9, expressions sharing nodes
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <atomic>
+#include <iostream>
+#include <common.h>
+#include <CGAL/IO/Polyhedron_iostream.h>
+#include <Expression.h>
+#include <SphericalSphere.h>
+#include <ThreadPool.h>
+#include <debug.h>
+
+namespace csg {
+
+static std::atomic<int>	builds(0);
+
+/**
+ * \brief Expression leaf for a sphere, counting how often it is built
+ */
+static Expression	sphere(const std::string& name, const point& center,
+				double radius, int steps) {
+	return Expression::leaf(name, [center, radius, steps]() {
+		builds++;
+		Build_SphericalSphere	b(radius, steps);
+		Polyhedron	p;
+		p.delegate(b);
+		Nef_polyhedron	n(p);
+		n.transform(Aff_transformation(CGAL::Translation(),
+			Kernel::Vector_3(center.x(), center.y(), center.z())));
+		return n;
+	});
+}
+
+/**
+ * \brief Mesh leaf for a sphere at the origin, counting its builds
+ */
+static Expression	meshsphere(const std::string& name, double radius,
+				int steps) {
+	return Expression::mesh(name, [radius, steps]() {
+		builds++;
+		Build_SphericalSphere	b(radius, steps);
+		Polyhedron	p;
+		p.delegate(b);
+		return p;
+	});
+}
+
+/**
+ * \brief main function for example9
+ *
+ * The expression contains an inner node used by two differences, a leaf
+ * clipped by two boxes and a mesh leaf transformed twice. Each of the
+ * four leaves must be built exactly once, and the evaluation must not
+ * block on the shared nodes, whatever the number of threads.
+ */
+int	main(int argc, char *argv[]) {
+	int	c;
+	int	steps = 12;
+	while (EOF != (c = getopt(argc, argv, "dn:j:")))
+		switch (c) {
+		case 'd':
+			debuglevel = LOG_DEBUG;
+			break;
+		case 'n':
+			steps = atoi(optarg);
+			break;
+		case 'j':
+			ThreadPool::concurrency(atoi(optarg));
+			break;
+		}
+
+	// an inner union shared by two differences
+	Expression	s = sphere("a", point(0, 0, 0), 1, steps)
+			+ sphere("b", point(1, 0, 0), 1, steps);
+	Expression	shared = (s - Expression::box(point(-2, -2, 0.5),
+					point(3, 2, 2)))
+			+ (s - Expression::box(point(-2, -2, -2),
+					point(3, 2, -0.5)));
+
+	// one leaf clipped by two boxes
+	Expression	l = sphere("c", point(0, 4, 0), 1, steps);
+	Expression	clipped = l.clip(bounds(point(-2, 2, -2), point(2, 4, 2)))
+			+ l.clip(bounds(point(-2, 4.5, -2), point(2, 6, 2)));
+
+	// a mesh leaf in two places
+	Expression	m = meshsphere("d", 0.5, steps);
+	Expression	meshes = m.transform(Aff_transformation(
+				CGAL::Translation(), Kernel::Vector_3(0, -3, 0)))
+			+ m.transform(Aff_transformation(
+				CGAL::Translation(), Kernel::Vector_3(2, -3, 0)));
+
+	Expression	e = shared + clipped + meshes;
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "plan: %s", e.plan().str().c_str());
+	Nef_polyhedron	n = e.evaluate();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%d leaves built", (int)builds);
+	if (builds != 4) {
+		std::cerr << "expected 4 leaf builds, got " << builds
+			<< std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Polyhedron	P;
+	n.convert_to_polyhedron(P);
+	std::cout << P;
+
+	return EXIT_SUCCESS;
+}
+
+} // namespace csg
+
+int	main(int argc, char *argv[]) {
+	try {
+		return csg::main(argc, argv);
+	} catch (std::exception& x) {
+		std::cerr << "terminated by std::exception: " << x.what()
+			<< std::endl;
+	} catch (...) {
+		std::cerr << "terminated by unknown exception" << std::endl;
+	}
+	return EXIT_FAILURE;
+}
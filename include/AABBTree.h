@@ -0,0 +1,86 @@
+/*
+ * AABBTree.h -- bounding box hierarchy over the triangles of a mesh
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _AABBTree_h
+#define _AABBTree_h
+
+#include <common.h>
+#include <Bounds.h>
+#include <Mesh.h>
+#include <utility>
+#include <vector>
+
+namespace csg {
+
+/**
+ * \brief Axis aligned bounding box tree over the triangles of a mesh
+ *
+ * The tree is a balanced binary tree stored in heap order: the children
+ * of node n are the nodes 2n + 1 and 2n + 2. Each node is split at the
+ * median of the triangle centers along the longest axis of its box, the
+ * subtrees near the root are built concurrently on the thread pool.
+ * Triangles are reported by their index in the mesh.
+ *
+ * All computations are done in double precision, so triangles that only
+ * touch may or may not be reported as intersecting. Queries that decide
+ * whether meshes can be combined without an exact boolean operation
+ * therefore take a margin, pieces closer than the margin are treated as
+ * intersecting.
+ */
+class AABBTree {
+public:
+	typedef std::pair<int, int>	triangle_pair;
+private:
+	class triangle {
+	public:
+		int	index;
+		int	v[3];
+		point	a, b, c;
+		bounds	box;
+	};
+	class node {
+	public:
+		bounds	box;
+		int	first, count;
+	};
+	std::vector<point>	_vertices;
+	std::vector<triangle>	_triangles;
+	std::vector<node>	_nodes;
+	int	_depth;
+	void	setup(const IndexedMesh& mesh);
+	void	build(int n, int first, int count, int depth);
+	bool	leaf(int n) const;
+	void	closest(int n, const point& p, double& best) const;
+	int	crossings(int n, const point& p, const vector& d) const;
+	bool	self_pairs(int n, std::vector<triangle_pair> *result) const;
+	bool	pairs(int n, const AABBTree& other, int m, double margin,
+			std::vector<triangle_pair> *result) const;
+	double	distance(int n, const AABBTree& other, int m,
+			double best) const;
+	bool	contains_any(const AABBTree& other) const;
+public:
+	AABBTree(const IndexedMesh& mesh);
+	AABBTree(const Polyhedron& p);
+	int	size() const { return _triangles.size(); }
+	bounds	box() const;
+	bool	self_intersects() const;
+	std::vector<triangle_pair>	self_intersections() const;
+	bool	intersects(const AABBTree& other, double margin = 0) const;
+	std::vector<triangle_pair>	intersections(const AABBTree& other,
+						double margin = 0) const;
+	double	distance(const point& p) const;
+	double	distance(const AABBTree& other) const;
+	bool	inside(const point& p) const;
+	bool	separated(const AABBTree& other, double margin) const;
+};
+
+extern double	segment_distance2(const point& p, const point& a,
+			const point& b);
+extern double	triangle_distance2(const point& p, const point& a,
+			const point& b, const point& c);
+
+} // namespace csg
+
+#endif /* _AABBTree_h */
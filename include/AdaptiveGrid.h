@@ -0,0 +1,80 @@
+/*
+ * AdaptiveGrid.h -- adaptive triangulation of a rectangular parameter domain
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _AdaptiveGrid_h
+#define _AdaptiveGrid_h
+
+#include <common.h>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace csg {
+
+/**
+ * \brief Quadtree triangulation of a parameter domain with bounded error
+ *
+ * The domain urange x vrange is divided into a quadtree whose cells are
+ * unions of cells of a usteps x vsteps grid. A cell is split while the
+ * surface deviates from the bilinear interpolation of the cell corners
+ * by more than the tolerance at the cell center or at an edge midpoint,
+ * and while it is larger than a grid cell. Cells with neighbours that
+ * are split further get a center node and a triangle fan through all
+ * nodes on their boundary, so the triangulation has no cracks.
+ *
+ * If wrapv is set, v = vmax is identified with v = vmin, if collapseu is
+ * set, all nodes at u = umin are the same node, as in polar coordinates
+ * on a domain containing r = 0. Triangles degenerated by these
+ * identifications are dropped.
+ */
+class AdaptiveGrid {
+public:
+	typedef std::function<point(double u, double v)>	surface;
+private:
+	Interval	_urange, _vrange;
+	int	_usteps, _vsteps;
+	double	_tolerance;
+	bool	_wrapv, _collapseu;
+	class cell {
+	public:
+		int	i0, i1, j0, j1;
+		cell(int _i0, int _i1, int _j0, int _j1)
+			: i0(_i0), i1(_i1), j0(_j0), j1(_j1) { }
+	};
+	// surface points at half grid positions, keyed by doubled indices
+	std::map<std::pair<int, int>, point>	_samples;
+	std::vector<cell>	_leaves;
+	std::vector<int>	_nodeids;
+	const point&	sample(const surface& f, int i2, int j2);
+	double	error(const surface& f, const cell& c);
+	void	refine(const surface& f, const cell& c);
+	void	canonical(int& i, int& j) const;
+	int	gridnode(int i, int j) const;
+	int	addnode(int i2, int j2);
+	void	triangulate(const cell& c);
+	void	addtriangle(int a, int b, int c);
+	void	findboundary();
+public:
+	AdaptiveGrid(const Interval& urange, const Interval& vrange,
+		int usteps, int vsteps, double tolerance,
+		bool wrapv = false, bool collapseu = false);
+	void	build(const surface& f);
+
+	// parameter values of the nodes
+	std::vector<double>	u;
+	std::vector<double>	v;
+	// triangles, counterclockwise in the parameter domain
+	std::vector<int>	triangles;
+	// boundary edges as pairs of nodes, in the triangles' direction
+	std::vector<int>	boundary;
+
+	int	number_of_nodes() const { return u.size(); }
+	int	number_of_triangles() const { return triangles.size() / 3; }
+	int	number_of_boundary_edges() const { return boundary.size() / 2; }
+};
+
+} // namespace csg
+
+#endif /* _AdaptiveGrid_h */
@@ -0,0 +1,43 @@
+/*
+ * AngleTable.h -- shared tables of equidistant angles and their sin/cos
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _AngleTable_h
+#define _AngleTable_h
+
+#include <common.h>
+#include <vector>
+
+namespace csg {
+
+/**
+ * \brief Equidistant angles in an interval together with sine and cosine
+ *
+ * The table for a range and a number of steps contains the steps + 1
+ * angles range.min() + i * range.length() / steps. Tables are created
+ * once per distinct range and step count and shared by all builders for
+ * the lifetime of the process, get() is safe to call from several
+ * threads.
+ */
+class AngleTable {
+	std::vector<double>	_angles;
+	std::vector<double>	_cosines;
+	std::vector<double>	_sines;
+	AngleTable(const Interval& range, int steps);
+	AngleTable(const AngleTable& other);
+	AngleTable&	operator=(const AngleTable& other);
+public:
+	static const AngleTable&	get(const Interval& range, int steps);
+	int	size() const { return _angles.size(); }
+	double	angle(int i) const { return _angles[i]; }
+	double	cosine(int i) const { return _cosines[i]; }
+	double	sine(int i) const { return _sines[i]; }
+	const double	*angles() const { return &_angles[0]; }
+	const double	*cosines() const { return &_cosines[0]; }
+	const double	*sines() const { return &_sines[0]; }
+};
+
+} // namespace csg
+
+#endif /* _AngleTable_h */
@@ -22,7 +22,10 @@ public:
 		int steps = 4)
 		: _from(from), _to(to), _radius(radius), _steps(steps) {
 	}
-	void	operator()(Polyhedron::HalfedgeDS& hds);
+	virtual int	expected_vertices() const;
+	virtual int	expected_facets() const;
+protected:
+	virtual void	build();
 };
 
 } // namespace csg
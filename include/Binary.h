@@ -0,0 +1,61 @@
+/*
+ * Binary.h -- compact binary files for polyhedra and Nef polyhedra
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Binary_h
+#define _Binary_h
+
+#include <common.h>
+#include <Mesh.h>
+#include <ostream>
+#include <string>
+
+namespace csg {
+
+/**
+ * \brief Binary format for polyhedra and Nef polyhedra
+ *
+ * All numbers are little endian. Coordinates that are doubles, which
+ * is the case for everything the builders create, take one tag byte
+ * and eight bytes, other coordinates are stored as the exact rational,
+ * with numerator and denominator as length prefixed GMP limb bytes.
+ * Files are mapped into memory for reading. The data can also be read
+ * directly from memory, e.g. from shared memory, when models are handed
+ * between processes.
+ *
+ * A Nef polyhedron bounding a simple solid is stored as its boundary
+ * polyhedron, from which the Nef polyhedron has to be constructed again
+ * when it is read. All other Nef polyhedra are embedded in the CGAL Nef
+ * stream format. So the format is compact for Nef polyhedra too, but
+ * reading them costs about as much as building them in the first place.
+ */
+extern void	write_binary(std::ostream& out, const Polyhedron& p);
+extern void	write_binary(std::ostream& out, const Nef_polyhedron& n);
+extern void	write_binary(std::ostream& out, const IndexedMesh& mesh);
+extern void	write_binary(const std::string& filename, const Polyhedron& p);
+extern void	write_binary(const std::string& filename,
+			const Nef_polyhedron& n);
+extern void	read_binary(const void *data, size_t size, Polyhedron& p);
+extern void	read_binary(const void *data, size_t size, Nef_polyhedron& n);
+extern void	read_binary(const std::string& filename, Polyhedron& p);
+extern void	read_binary(const std::string& filename, Nef_polyhedron& n);
+
+/**
+ * \brief Read only memory mapping of a whole file
+ */
+class mappedfile {
+	void	*_data;
+	size_t	_size;
+	mappedfile(const mappedfile& other);
+	mappedfile&	operator=(const mappedfile& other);
+public:
+	mappedfile(const std::string& filename);
+	~mappedfile();
+	const void	*data() const { return _data; }
+	size_t	size() const { return _size; }
+};
+
+} // namespace csg
+
+#endif /* _Binary_h */
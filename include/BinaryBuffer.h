@@ -0,0 +1,126 @@
+/*
+ * BinaryBuffer.h -- little endian binary output and input
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _BinaryBuffer_h
+#define _BinaryBuffer_h
+
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <stdint.h>
+#include <string.h>
+
+namespace csg {
+
+/**
+ * \brief Buffer for little endian binary data
+ */
+class binarybuffer {
+	std::ostream&	_out;
+	std::string	_buffer;
+	static const size_t	buffersize = 1 << 20;
+public:
+	binarybuffer(std::ostream& out) : _out(out) {
+		_buffer.reserve(buffersize);
+	}
+	~binarybuffer() {
+		flush();
+	}
+	void	flush() {
+		_out.write(_buffer.data(), _buffer.size());
+		_buffer.clear();
+	}
+	void	bytes(const char *data, size_t length) {
+		_buffer.append(data, length);
+		if (_buffer.size() >= buffersize) {
+			flush();
+		}
+	}
+	void	uint8(uint8_t v) {
+		char	b = (char)v;
+		bytes(&b, 1);
+	}
+	void	uint16(uint16_t v) {
+		char	b[2] = { (char)(v & 0xff), (char)((v >> 8) & 0xff) };
+		bytes(b, 2);
+	}
+	void	uint32(uint32_t v) {
+		char	b[4] = { (char)(v & 0xff), (char)((v >> 8) & 0xff),
+				(char)((v >> 16) & 0xff), (char)((v >> 24) & 0xff) };
+		bytes(b, 4);
+	}
+	void	uint64(uint64_t v) {
+		uint32(v & 0xffffffff);
+		uint32(v >> 32);
+	}
+	void	float32(float f) {
+		uint32_t	v;
+		memcpy(&v, &f, 4);
+		uint32(v);
+	}
+	void	float64(double d) {
+		uint64_t	v;
+		memcpy(&v, &d, 8);
+		uint64(v);
+	}
+	void	string(const std::string& s) {
+		uint32(s.size());
+		bytes(s.data(), s.size());
+	}
+};
+
+/**
+ * \brief Reader for little endian binary data in memory
+ *
+ * All reads are bounds checked, reading past the end throws.
+ */
+class binaryreader {
+	const unsigned char	*_data;
+	size_t	_size;
+	size_t	_position;
+	const unsigned char	*take(size_t length) {
+		if (length > _size - _position) {
+			throw std::runtime_error("truncated binary data");
+		}
+		const unsigned char	*p = _data + _position;
+		_position += length;
+		return p;
+	}
+public:
+	binaryreader(const void *data, size_t size)
+		: _data((const unsigned char *)data), _size(size),
+		  _position(0) { }
+	size_t	remaining() const { return _size - _position; }
+	const char	*bytes(size_t length) {
+		return (const char *)take(length);
+	}
+	uint8_t	uint8() {
+		return *take(1);
+	}
+	uint32_t	uint32() {
+		const unsigned char	*b = take(4);
+		return (uint32_t)b[0] | ((uint32_t)b[1] << 8)
+			| ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+	}
+	uint64_t	uint64() {
+		uint64_t	low = uint32();
+		uint64_t	high = uint32();
+		return low | (high << 32);
+	}
+	double	float64() {
+		uint64_t	v = uint64();
+		double	d;
+		memcpy(&d, &v, 8);
+		return d;
+	}
+	std::string	string() {
+		uint32_t	length = uint32();
+		return std::string(bytes(length), length);
+	}
+};
+
+} // namespace csg
+
+#endif /* _BinaryBuffer_h */
@@ -0,0 +1,124 @@
+/*
+ * Boolean.h -- boolean operations on closed triangle meshes
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Boolean_h
+#define _Boolean_h
+
+#include <common.h>
+#include <Bounds.h>
+#include <list>
+#include <memory>
+
+namespace csg {
+
+class AABBTree;
+
+/**
+ * \brief Boolean operations on polyhedra with selectable engine
+ *
+ * The NEF_ENGINE converts both operands to Nef polyhedra, computes the
+ * result there and converts back. The MESH_ENGINE computes the result
+ * by corefinement of the triangle meshes, which is much faster and
+ * needs much less memory, but only works for closed, triangulated and
+ * not self intersecting operands. Whenever the mesh engine cannot
+ * handle the operands or the result, the Nef engine is used instead.
+ * A Nef result can only be converted back to a polyhedron if it is
+ * simple, i.e. a 2-manifold. The compute() and evaluate() methods keep
+ * non simple results as Nef polyhedra, the methods returning a
+ * Polyhedron throw an exception for them.
+ * The extended kernel does not support corefinement, so with this kernel
+ * all operations use the Nef engine. Operands that are apart, i.e. whose
+ * surfaces do not meet and neither of which contains the other, are
+ * handled directly by both engines, e.g. their union is the
+ * concatenation of the meshes.
+ */
+class Boolean {
+public:
+	typedef enum engine { NEF_ENGINE, MESH_ENGINE } engine_type;
+	typedef enum operation { JOIN, INTERSECTION, DIFFERENCE } operation_type;
+	/**
+	 * \brief What is known about an operand
+	 *
+	 * A validated operand is known to be suitable for the mesh engine,
+	 * e.g. because the engine produced it, and is not checked again. The
+	 * bounding box and the bounding box tree of the operand are kept once
+	 * they have been computed, so that they are not rebuilt for further
+	 * operations with the same operand.
+	 */
+	class operand_info {
+	public:
+		bool	validated;
+		bool	boxed;
+		bounds	box;
+		std::shared_ptr<const AABBTree>	tree;
+		operand_info() : validated(false), boxed(false) { }
+	};
+private:
+	engine_type	_engine;
+	Nef_polyhedron	nef(const Polyhedron& a, const Polyhedron& b,
+				operation_type op) const;
+	bool	mesh(const Polyhedron& a, const Polyhedron& b,
+				operation_type op, Polyhedron& result,
+				operand_info& ainfo, operand_info& binfo) const;
+public:
+	Boolean(engine_type engine = MESH_ENGINE) : _engine(engine) { }
+	const engine_type&	engine() const { return _engine; }
+	static bool	mesh_applicable(const Polyhedron& p);
+	static bool	apart(const Polyhedron& a, const Polyhedron& b);
+	static bool	apart(const Polyhedron& a, const Polyhedron& b,
+				operand_info& ainfo, operand_info& binfo);
+	bool	compute(const Polyhedron& a, const Polyhedron& b,
+			operation_type op, Polyhedron& result,
+			Nef_polyhedron& nefresult) const;
+	bool	compute(const Polyhedron& a, const Polyhedron& b,
+			operation_type op, Polyhedron& result,
+			Nef_polyhedron& nefresult, operand_info& ainfo,
+			operand_info& binfo, operand_info& resultinfo) const;
+	Nef_polyhedron	evaluate(const Polyhedron& a, const Polyhedron& b,
+				operation_type op) const;
+	Polyhedron	operator()(const Polyhedron& a, const Polyhedron& b,
+				operation_type op) const;
+	Polyhedron	join(const Polyhedron& a, const Polyhedron& b) const;
+	Polyhedron	intersection(const Polyhedron& a,
+				const Polyhedron& b) const;
+	Polyhedron	difference(const Polyhedron& a,
+				const Polyhedron& b) const;
+};
+
+/**
+ * \brief Union of many polyhedra, the mesh counterpart of Nef_nary_union
+ *
+ * Polyhedra are merged pairwise as they are added, so that the operands
+ * of each merge have similar size, just like Nef_nary_union_3 does.
+ * Partial unions that are not simple are kept as Nef polyhedra, and all
+ * further merges involving them are done with Nef polyhedra. Partial
+ * unions produced by the engine are not checked again before they are
+ * merged.
+ */
+class Mesh_nary_union {
+	class operand {
+	public:
+		bool	isnef;
+		Polyhedron	polyhedron;
+		Boolean::operand_info	info;
+		Nef_polyhedron	nef;
+		operand() : isnef(false) { }
+		Nef_polyhedron	to_nef() const;
+	};
+	Boolean	_boolean;
+	std::list<operand>	queue;
+	size_t	_count;
+	void	unite();
+public:
+	Mesh_nary_union(Boolean::engine_type engine = Boolean::MESH_ENGINE)
+		: _boolean(engine), _count(0) { }
+	void	add_polyhedron(const Polyhedron& p);
+	bool	get_union(Polyhedron& result, Nef_polyhedron& nefresult);
+	Polyhedron	get_union();
+};
+
+} // namespace csg
+
+#endif /* _Boolean_h */
@@ -0,0 +1,47 @@
+/*
+ * Bounds.h -- axis aligned bounding boxes
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Bounds_h
+#define _Bounds_h
+
+#include <common.h>
+
+namespace csg {
+
+/**
+ * \brief Axis aligned bounding box in double precision
+ *
+ * A default constructed bounds object is empty, adding points or other
+ * bounds extends it.
+ */
+class bounds {
+	point	_min, _max;
+	bool	_empty;
+public:
+	bounds() : _empty(true) { }
+	bounds(const point& p) : _min(p), _max(p), _empty(false) { }
+	bounds(const point& a, const point& b);
+	const point&	min() const { return _min; }
+	const point&	max() const { return _max; }
+	bool	empty() const { return _empty; }
+	void	add(const point& p);
+	void	add(const bounds& other);
+	point	center() const;
+	vector	extent() const;
+	bool	overlaps(const bounds& other) const;
+	bool	contains(const bounds& other) const;
+	bounds	intersection(const bounds& other) const;
+	double	distance(const bounds& other) const;
+};
+
+extern bounds	bounding_box(const Polyhedron& p);
+extern bounds	bounding_box(const Nef_polyhedron& n);
+extern bool	unbounded(const Nef_polyhedron& n);
+extern bool	grid_window(const double *vertices, int usteps, int vsteps,
+			const bounds& box, int window[4]);
+
+} // namespace csg
+
+#endif /* _Bounds_h */
@@ -18,9 +18,37 @@ public:
 	Build_Box(const point& a, const point& b) : _a(a), _b(b) {
 		standardize();
 	}
-	void	operator()(Polyhedron::HalfedgeDS& hds);
+	virtual int	expected_vertices() const { return 8; }
+	virtual int	expected_facets() const { return 12; }
+protected:
+	virtual void	build();
 };
 
+/**
+ * \brief Build a large box approximating a half space
+ *
+ * The box contains the points with a x + b y + c z + d <= 0 within
+ * distance extent of the point on the plane closest to the origin.
+ * This is used as a replacement of half spaces for kernels that cannot
+ * represent unbounded objects.
+ */
+class Build_HalfSpace : public Build_Surface {
+	vector	_n;
+	double	_d;
+	double	_extent;
+public:
+	Build_HalfSpace(double a, double b, double c, double d,
+		double extent = 10000)
+		: _n(a, b, c), _d(d), _extent(extent) {
+	}
+	virtual int	expected_vertices() const { return 8; }
+	virtual int	expected_facets() const { return 12; }
+protected:
+	virtual void	build();
+};
+
+extern Nef_polyhedron	halfspace(double a, double b, double c, double d);
+
 } // namespace csg
 
 #endif /* _Box_h */
@@ -8,26 +8,63 @@
 
 #include <common.h>
 #include <Surface.h>
+#include <AdaptiveGrid.h>
+#include <Bounds.h>
+#include <memory>
+#include <vector>
 
 namespace csg {
 
 /**
  * \brief Build surfaces parametrized by cartesian coordinate 
+ *
+ * By default, the surface is sampled on a uniform xsteps x ysteps grid.
+ * If a tolerance is set, the grid is only refined up to that resolution
+ * where the surface deviates from a planar triangulation by more than
+ * the tolerance. If a clip box is set, the domain is trimmed to the grid
+ * cells that may meet the box before the sheet is built, so that the
+ * sheet covers the part of the surface inside the box with as few grid
+ * cells as possible. The sheet is still closed, and it still has to be
+ * intersected with the box to get the exact clipped surface.
  */
 class Build_Cartesian : public Build_Surface {
+	CartesianDomain	_fulldomain;
 	CartesianDomain	_domain;
 protected:
 	virtual point	p(double x, double y, double h) = 0;
+	virtual void	row(double x, const double *y, int n, double h,
+				double *vertices);
 private:
+	int	_fullxsteps, _fullysteps;
 	int	_xsteps, _ysteps;
 	double	_h;
+	double	_tolerance;
+	std::unique_ptr<AdaptiveGrid>	_grid;
+	bounds	_clip;
+	bool	_outside;
+	// full grid sampled by trim(), and the window of it that is kept
+	std::vector<double>	_samples;
+	int	_window[4];
 	int	vertex(const int x, const int y) const;
+	void	trim();
+	void	build_adaptive();
 public:
 	Build_Cartesian(const CartesianDomain& domain,
 		int xsteps, int ysteps, double h)
-		: _domain(domain), _xsteps(xsteps), _ysteps(ysteps), _h(h) {
+		: _fulldomain(domain), _domain(domain),
+		  _fullxsteps(xsteps), _fullysteps(ysteps),
+		  _xsteps(xsteps), _ysteps(ysteps), _h(h),
+		  _tolerance(0), _outside(false) {
 	}
-	void	operator()(Polyhedron::HalfedgeDS& hds);
+	double	tolerance() const { return _tolerance; }
+	void	tolerance(double t) { _tolerance = t; _grid.reset(); }
+	const bounds&	clip() const { return _clip; }
+	void	clip(const bounds& box) { _clip = box; }
+	virtual int	expected_vertices() const;
+	virtual int	expected_facets() const;
+protected:
+	virtual void	prepare();
+	virtual void	build();
 };
 
 /**
@@ -37,6 +74,8 @@ class Build_CartesianFunction : public Build_Cartesian {
 	Function&	_f;
 protected:
 	virtual point	p(double x, double y, double h);
+	virtual void	row(double x, const double *y, int n, double h,
+				double *vertices);
 public:
 	Build_CartesianFunction(Function& f, const CartesianDomain& domain,
 		int xsteps, int ysteps, double h)
@@ -51,6 +90,8 @@ class Build_CartesianPointFunction : public Build_Cartesian {
 	PointFunction&	_f;
 protected:
 	virtual point	p(double x, double y, double h);
+	virtual void	row(double x, const double *y, int n, double h,
+				double *vertices);
 public:
 	Build_CartesianPointFunction(PointFunction& f,
 		const CartesianDomain& domain, int xsteps, int ysteps, double h)
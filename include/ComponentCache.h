@@ -0,0 +1,48 @@
+/*
+ * ComponentCache.h -- keep Nef polyhedra of model components on disk
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _ComponentCache_h
+#define _ComponentCache_h
+
+#include <common.h>
+#include <functional>
+#include <string>
+
+namespace csg {
+
+/**
+ * \brief Directory of Nef polyhedra addressed by their description
+ *
+ * The description of a component must name the builder and contain all
+ * parameters it depends on. The file name is a hash of the description
+ * and the kernel name, the file also contains the full description, so
+ * that a hash collision is detected when loading. A cache without a
+ * directory is disabled, get() then just calls the builder. Files are
+ * written to a temporary name and renamed, so concurrent processes never
+ * see partial files. The cache cannot know about changes of the code,
+ * the directory must be cleared when the builders change. The Nef
+ * polyhedra are stored in the binary format of Binary.h, files that
+ * cannot be read are treated as missing.
+ */
+class ComponentCache {
+	std::string	_directory;
+	std::string	filename(const std::string& description) const;
+public:
+	typedef std::function<Nef_polyhedron()>	builder_type;
+	ComponentCache() { }
+	ComponentCache(const std::string& directory);
+	const std::string&	directory() const { return _directory; }
+	bool	enabled() const { return _directory.size() > 0; }
+	static std::string	key(const std::string& description);
+	bool	load(const std::string& description, Nef_polyhedron& n) const;
+	void	store(const std::string& description,
+			const Nef_polyhedron& n) const;
+	Nef_polyhedron	get(const std::string& description,
+				const builder_type& builder) const;
+};
+
+} // namespace csg
+
+#endif /* _ComponentCache_h */
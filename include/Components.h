@@ -0,0 +1,65 @@
+/*
+ * Components.h -- build independent model components in parallel
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Components_h
+#define _Components_h
+
+#include <common.h>
+#include <ThreadPool.h>
+#include <Union.h>
+#include <ComponentCache.h>
+#include <Expression.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace csg {
+
+/**
+ * \brief Collection of independent components of a model
+ *
+ * Each component is described by a function constructing its Nef
+ * polyhedron. The build() method constructs all components concurrently
+ * on the thread pool, add_to() then adds the components that could be
+ * built to a Nef_nary_union in the order they were added. A component
+ * that throws an exception is reported and left out of the union.
+ * get_union() forms the union with a Parallel_nary_union. If a cache
+ * is set, components are looked up by their name and the parameter
+ * string of the model before they are built. expression() returns the
+ * components as a deferred union, to be combined with other expressions
+ * before anything is built.
+ */
+class Components {
+public:
+	typedef std::function<Nef_polyhedron()>	builder_type;
+private:
+	class component {
+	public:
+		std::string	name;
+		builder_type	builder;
+		Nef_polyhedron	result;
+		bool	valid;
+		component(const std::string& _name, const builder_type& _builder)
+			: name(_name), builder(_builder), valid(false) { }
+	};
+	std::vector<component>	_components;
+	ComponentCache	_cache;
+	std::string	_parameters;
+	void	build_component(component& c) const;
+public:
+	void	cache(const ComponentCache& cache,
+			const std::string& parameters);
+	void	add(const std::string& name, const builder_type& builder);
+	size_t	size() const { return _components.size(); }
+	void	build();
+	void	add_to(Nef_nary_union& unioner) const;
+	void	add_to(Parallel_nary_union& unioner) const;
+	Nef_polyhedron	get_union();
+	Expression	expression() const;
+};
+
+} // namespace csg
+
+#endif /* _Components_h */
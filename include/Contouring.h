@@ -0,0 +1,104 @@
+/*
+ * Contouring.h -- block parallel dual contouring of a scalar grid
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Contouring_h
+#define _Contouring_h
+
+#include <common.h>
+#include <vector>
+
+namespace csg {
+
+/**
+ * \brief Surface cell, with the vertex of the piece of surface through
+ *        each crossed edge
+ */
+class dccell {
+public:
+	int	index;		// cell number within the block
+	int	mask;		// bit c set if corner c is inside
+	int	vertex[12];	// vertex number within the block, or -1
+	bool	operator<(const dccell& other) const {
+		return index < other.index;
+	}
+};
+
+/**
+ * \brief Block of blocksize^3 cells, contoured by a single task
+ */
+class dcblock {
+public:
+	int	i0, j0, k0;
+	std::vector<double>	values;
+	std::vector<double>	samples;	// for use by derived classes
+	std::vector<dccell>	cells;
+	std::vector<double>	vertices;
+	std::vector<int>	triangles;
+	int	firstvertex;
+	const dccell	*cell(int i, int j, int k) const;
+};
+
+/**
+ * \brief Dual contouring of the zero level set of a function on a grid
+ *
+ * The grid of nx x ny x nz cells starts at origin and has cells of size
+ * h. The solid is the set where the value is negative, the values on the
+ * boundary of the grid must be positive for the surface to be closed.
+ * Cells are grouped in blocks, which are contoured concurrently on the
+ * thread pool, each cell crossed by the surface gets one vertex for each
+ * piece of surface passing through it, and each crossed grid edge two
+ * triangles connecting the vertices of the four cells around it. Faces
+ * with two diagonal inside corners are resolved by the asymptotic
+ * decider, which both cells sharing the face agree on, so that the mesh
+ * is a closed manifold.
+ *
+ * Derived classes provide the values at the grid points, the normals at
+ * the crossings of the edges, and optionally a test that allows to skip
+ * octants of a block that are far from the surface. They may also fill
+ * the samples of a block before it is contoured, they are released
+ * afterwards.
+ */
+class Contouring {
+	std::vector<dcblock>	_blocks;
+	int	_nb[3];
+	double	value(dcblock& b, int i, int j, int k) const;
+	void	visit(dcblock& b, int i, int j, int k, int size) const;
+	void	contour(dcblock& b, int i, int j, int k) const;
+	point	place(const std::vector<point>& points,
+			const std::vector<vector>& normals,
+			int i, int j, int k) const;
+	const dccell	*cell(int i, int j, int k) const;
+	int	vertex(int i, int j, int k, int e, point& p) const;
+	void	triangulate(dcblock& b) const;
+protected:
+	point	_origin;
+	double	_h;
+	int	_n[3];
+	point	gridpoint(double i, double j, double k) const {
+		return _origin + vector(i * _h, j * _h, k * _h);
+	}
+	virtual void	sample(dcblock& b) const { }
+	virtual double	evaluate(const dcblock& b, int i, int j, int k)
+				const = 0;
+	virtual vector	normal(const point& p) const = 0;
+	virtual bool	far(int i, int j, int k, int size) const;
+public:
+	/**
+	 * \brief Number of cells along each side of a block
+	 *
+	 * Must be a power of two, as blocks are subdivided as octrees.
+	 */
+	static const int	blocksize = 16;
+	Contouring(const point& origin, double h, int nx, int ny, int nz);
+	virtual ~Contouring() { }
+	void	build();
+	int	number_of_vertices() const;
+	void	copy_vertices(double *vertices) const;
+	std::vector<int>	triangles() const;
+};
+
+} // namespace csg
+
+#endif /* _Contouring_h */
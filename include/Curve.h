@@ -8,16 +8,42 @@
 
 #include <common.h>
 #include <Surface.h>
+#include <Dual.h>
+#include <Bounds.h>
+#include <vector>
 
 namespace csg {
 
+/**
+ * \brief Position and derivatives of a curve at a parameter value
+ *
+ * d1 and d2 are the first and second derivative. Only the plane spanned
+ * by d1 and d2 is used to orient tubes around the curve, so a curve
+ * preferring a different orientation, e.g. because its second derivative
+ * vanishes, may use any vector not parallel to d1 as d2.
+ */
+class curvepoint {
+public:
+	point	p;
+	vector	d1;
+	vector	d2;
+};
+
 /**
  * \brief Base class for curves
+ *
+ * Derived classes implement position() and should provide the exact
+ * derivatives by overriding evaluate(), or by deriving from
+ * AutoCurveFunction. Otherwise evaluate() falls back to central
+ * differences with step deltat(). tangent() and normal() return the
+ * d1 and d2 members of evaluate(), so normal() is the second derivative
+ * and is not normalized.
  */
 class CurveFunction {
 	double	_deltat;
 public:
 	CurveFunction(double deltat = 0) : _deltat(deltat) { }
+	virtual ~CurveFunction() { }
 
 	const double&	deltat() const { return _deltat; }
 	void	deltat(double d) { _deltat = d; }
@@ -26,26 +52,98 @@ public:
 
 	virtual vector	tangent(double t) const;
 	virtual vector	normal(double t) const;
+	virtual curvepoint	evaluate(double t) const;
 	frame	frenetframe(double t) const;
 };
 
+/**
+ * \brief Curve with derivatives computed by automatic differentiation
+ *
+ * The derived class F implements a template method
+ *
+ *	template<typename T>
+ *	void	coordinates(const T& t, T& x, T& y, T& z) const;
+ *
+ * which is instantiated for double to get positions, and for dual<double>
+ * to get the exact first and second derivative in the same evaluation.
+ */
+template<typename F>
+class AutoCurveFunction : public CurveFunction {
+public:
+	AutoCurveFunction() : CurveFunction() { }
+	virtual point	position(double t) const {
+		double	x, y, z;
+		static_cast<const F *>(this)->coordinates(t, x, y, z);
+		return point(x, y, z);
+	}
+	virtual curvepoint	evaluate(double t) const {
+		dual<double>	x, y, z;
+		static_cast<const F *>(this)->coordinates(
+			dual<double>::variable(t), x, y, z);
+		curvepoint	c;
+		c.p = point(x.value(), y.value(), z.value());
+		c.d1 = vector(x.d1(), y.d1(), z.d1());
+		c.d2 = vector(x.d2(), y.d2(), z.d2());
+		return c;
+	}
+	virtual vector	tangent(double t) const { return evaluate(t).d1; }
+	virtual vector	normal(double t) const { return evaluate(t).d2; }
+};
+
 /**
  * \brief Class to build space curves
+ *
+ * The tube around the curve consists of rings of phisteps vertices. By
+ * default, the rings are placed at steps + 1 equidistant parameter values
+ * and oriented by the Frenet frame. Rotation minimizing frames avoid the
+ * twist of the Frenet frame near inflection points, and with a maximum
+ * angle set, rings are only placed where the tangent has turned by that
+ * angle, but never closer than the spacing of the equidistant rings.
+ * If a clip box is set, the tube starts at the last ring before and ends
+ * at the first ring after the part of the curve that may meet the box.
  */
 class Build_Curve : public Build_Surface {
+public:
+	typedef enum frames {
+		FRENET_FRAMES, ROTATION_MINIMIZING_FRAMES
+	} frame_type;
+private:
 	CurveFunction&	_f;
 	Interval	_interval;
 	int	_steps;
 	int	_phisteps;
 	double	_r;
+	frame_type	_frames;
+	double	_maxangle;
+	bounds	_clip;
+	// parameter values and curve points of the rings, computed on demand
+	mutable bool	_sampled;
+	mutable std::vector<double>	_parameters;
+	mutable std::vector<curvepoint>	_points;
+	void	sample() const;
+	void	refine(double t0, const curvepoint& c0,
+			double t1, const curvepoint& c1) const;
+	void	trim() const;
+	std::vector<frame>	ringframes() const;
+	int	rings() const;
 	int	vertex(int t, int phi) const;
 public:
 	Build_Curve(CurveFunction& f, const Interval& interval,
 		int steps, int phisteps, double r)
 		: _f(f), _interval(interval),
-		_steps(steps), _phisteps(phisteps), _r(r) {
+		_steps(steps), _phisteps(phisteps), _r(r),
+		_frames(FRENET_FRAMES), _maxangle(0), _sampled(false) {
 	}
-	void	operator()(Polyhedron::HalfedgeDS& hds);
+	frame_type	frames() const { return _frames; }
+	void	frames(frame_type f) { _frames = f; }
+	double	maxangle() const { return _maxangle; }
+	void	maxangle(double a) { _maxangle = a; _sampled = false; }
+	const bounds&	clip() const { return _clip; }
+	void	clip(const bounds& box) { _clip = box; _sampled = false; }
+	virtual int	expected_vertices() const;
+	virtual int	expected_facets() const;
+protected:
+	virtual void	build();
 };
 
 } // namespace csg
@@ -0,0 +1,42 @@
+/*
+ * Decimation.h -- reduce the number of triangles of a mesh
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Decimation_h
+#define _Decimation_h
+
+#include <common.h>
+#include <Mesh.h>
+
+namespace csg {
+
+/**
+ * \brief Quadric error metric decimation of closed triangle meshes
+ *
+ * Edges are collapsed in the order of the quadric error of Garland and
+ * Heckbert, i.e. the sum of squared distances of the new vertex from the
+ * planes of all original triangles merged into it. A collapse is only
+ * done if the new vertex is within maxdeviation of each of these planes,
+ * if it does not change the topology (link condition) and if no triangle
+ * is flipped. Decimation stops when no such collapse is left or when the
+ * number of triangles has dropped to ratio times the original number.
+ *
+ * Top and bottom of a sheet may interpenetrate if maxdeviation exceeds
+ * half the sheet thickness, so it should be chosen smaller than that.
+ */
+class Decimation {
+	double	_maxdeviation;
+	double	_ratio;
+public:
+	Decimation(double maxdeviation, double ratio = 0)
+		: _maxdeviation(maxdeviation), _ratio(ratio) { }
+	const double&	maxdeviation() const { return _maxdeviation; }
+	const double&	ratio() const { return _ratio; }
+	void	operator()(IndexedMesh& mesh) const;
+	void	operator()(Polyhedron& polyhedron) const;
+};
+
+} // namespace csg
+
+#endif /* _Decimation_h */
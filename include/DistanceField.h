@@ -0,0 +1,145 @@
+/*
+ * DistanceField.h -- signed distance fields of sheets, tubes and boxes
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _DistanceField_h
+#define _DistanceField_h
+
+#include <common.h>
+#include <Bounds.h>
+#include <Curve.h>
+#include <memory>
+#include <vector>
+
+namespace csg {
+
+/**
+ * \brief Signed distance field of a solid
+ *
+ * The value is negative inside the solid and positive outside. Fields
+ * need not be exact distances, but they must not change faster than the
+ * distance, i.e. |f(p) - f(q)| <= |p - q|, so that a cell can be skipped
+ * when the absolute value at its center exceeds its half diagonal. The
+ * value at a point is at least the distance of the point from box(),
+ * which allows unions to skip operands far from the point.
+ */
+class DistanceField {
+public:
+	virtual ~DistanceField() { }
+	virtual double	operator()(const point& p) const = 0;
+	virtual bounds	box() const = 0;
+	vector	gradient(const point& p, double h) const;
+};
+
+typedef std::shared_ptr<const DistanceField>	distancefield_ptr;
+
+/**
+ * \brief Solid of all points within some distance of triangles and segments
+ *
+ * The field is the exact distance from a set of triangles and segments,
+ * less the offset. A sheet of thickness h is the set of points within
+ * h/2 of its triangulated middle surface, a tube of radius r the set of
+ * points within r of a polygon. The nearest primitive is found with a
+ * bounding volume hierarchy.
+ */
+class MeshDistanceField : public DistanceField {
+	class primitive {
+	public:
+		point	a, b, c;
+		bool	segment;
+		bounds	box;
+		point	center;
+	};
+	class node {
+	public:
+		bounds	box;
+		int	first, count;
+		int	left, right;
+	};
+	std::vector<primitive>	_primitives;
+	std::vector<node>	_nodes;
+	double	_offset;
+	int	build(int first, int count);
+	void	nearest(int n, const point& p, double& best) const;
+public:
+	MeshDistanceField(const std::vector<point>& points,
+		const std::vector<int>& triangles,
+		const std::vector<int>& segments, double offset);
+	virtual double	operator()(const point& p) const;
+	virtual bounds	box() const;
+};
+
+/**
+ * \brief Exact signed distance field of an axis aligned box
+ */
+class BoxDistanceField : public DistanceField {
+	bounds	_box;
+public:
+	BoxDistanceField(const bounds& box) : _box(box) { }
+	virtual double	operator()(const point& p) const;
+	virtual bounds	box() const { return _box; }
+};
+
+/**
+ * \brief Union of fields, the minimum of the operands
+ */
+class UnionDistanceField : public DistanceField {
+	std::vector<distancefield_ptr>	_operands;
+	std::vector<bounds>	_boxes;
+	bounds	_box;
+public:
+	UnionDistanceField(const std::vector<distancefield_ptr>& operands);
+	virtual double	operator()(const point& p) const;
+	virtual bounds	box() const { return _box; }
+};
+
+/**
+ * \brief Intersection of two fields, the maximum of the operands
+ */
+class IntersectionDistanceField : public DistanceField {
+	distancefield_ptr	_a, _b;
+public:
+	IntersectionDistanceField(distancefield_ptr a, distancefield_ptr b)
+		: _a(a), _b(b) { }
+	virtual double	operator()(const point& p) const;
+	virtual bounds	box() const;
+};
+
+/**
+ * \brief Difference of two fields, the maximum of a and -b
+ */
+class DifferenceDistanceField : public DistanceField {
+	distancefield_ptr	_a, _b;
+public:
+	DifferenceDistanceField(distancefield_ptr a, distancefield_ptr b)
+		: _a(a), _b(b) { }
+	virtual double	operator()(const point& p) const;
+	virtual bounds	box() const { return _a->box(); }
+};
+
+extern distancefield_ptr	sheet_field(Function& f,
+	const CartesianDomain& domain, int xsteps, int ysteps,
+	double thickness);
+extern distancefield_ptr	sheet_field(const PointFunction& f,
+	const CartesianDomain& domain, int xsteps, int ysteps,
+	double thickness);
+extern distancefield_ptr	sheet_field(Function& f,
+	const PolarDomain& domain, int rsteps, int phisteps,
+	double thickness);
+extern distancefield_ptr	sheet_field(const PointFunction& f,
+	const PolarDomain& domain, int rsteps, int phisteps,
+	double thickness);
+extern distancefield_ptr	tube_field(const CurveFunction& f,
+	const Interval& interval, int steps, double radius);
+extern distancefield_ptr	box_field(const bounds& box);
+extern distancefield_ptr	union_field(
+	const std::vector<distancefield_ptr>& operands);
+extern distancefield_ptr	intersection_field(distancefield_ptr a,
+	distancefield_ptr b);
+extern distancefield_ptr	difference_field(distancefield_ptr a,
+	distancefield_ptr b);
+
+} // namespace csg
+
+#endif /* _DistanceField_h */
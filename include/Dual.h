@@ -0,0 +1,103 @@
+/*
+ * Dual.h -- dual numbers for automatic differentiation
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Dual_h
+#define _Dual_h
+
+#include <math.h>
+
+namespace csg {
+
+/**
+ * \brief Dual number carrying a value and its first two derivatives
+ *
+ * Arithmetic on dual numbers applies the chain rule, so evaluating a
+ * function on dual<double>::variable(t) yields the function value and
+ * its first and second derivative with respect to t, exact up to
+ * rounding. The elementary functions are friends found by argument
+ * dependent lookup, so the same template code works for double and dual
+ * arguments.
+ */
+template<typename T>
+class dual {
+	T	_v, _d1, _d2;
+	// result of an elementary function f with derivatives f1, f2 at _v
+	dual	chain(T f, T f1, T f2) const {
+		return dual(f, f1 * _d1, f2 * _d1 * _d1 + f1 * _d2);
+	}
+public:
+	dual(T v = 0, T d1 = 0, T d2 = 0) : _v(v), _d1(d1), _d2(d2) { }
+	static dual	variable(T v) { return dual(v, 1, 0); }
+	const T&	value() const { return _v; }
+	const T&	d1() const { return _d1; }
+	const T&	d2() const { return _d2; }
+
+	dual	operator-() const { return dual(-_v, -_d1, -_d2); }
+
+	friend dual	operator+(const dual& a, const dual& b) {
+		return dual(a._v + b._v, a._d1 + b._d1, a._d2 + b._d2);
+	}
+	friend dual	operator-(const dual& a, const dual& b) {
+		return dual(a._v - b._v, a._d1 - b._d1, a._d2 - b._d2);
+	}
+	friend dual	operator*(const dual& a, const dual& b) {
+		return dual(a._v * b._v, a._d1 * b._v + a._v * b._d1,
+			a._d2 * b._v + 2 * a._d1 * b._d1 + a._v * b._d2);
+	}
+	friend dual	operator/(const dual& a, const dual& b) {
+		return a * b.chain(1 / b._v, -1 / (b._v * b._v),
+			2 / (b._v * b._v * b._v));
+	}
+	friend dual	operator+(const dual& a, T b) {
+		return dual(a._v + b, a._d1, a._d2);
+	}
+	friend dual	operator+(T a, const dual& b) { return b + a; }
+	friend dual	operator-(const dual& a, T b) {
+		return dual(a._v - b, a._d1, a._d2);
+	}
+	friend dual	operator-(T a, const dual& b) { return -b + a; }
+	friend dual	operator*(const dual& a, T b) {
+		return dual(a._v * b, a._d1 * b, a._d2 * b);
+	}
+	friend dual	operator*(T a, const dual& b) { return b * a; }
+	friend dual	operator/(const dual& a, T b) { return a * (1 / b); }
+	friend dual	operator/(T a, const dual& b) { return dual(a) / b; }
+
+	friend dual	sin(const dual& a) {
+		T	s = ::sin(a._v);
+		return a.chain(s, ::cos(a._v), -s);
+	}
+	friend dual	cos(const dual& a) {
+		T	c = ::cos(a._v);
+		return a.chain(c, -::sin(a._v), -c);
+	}
+	friend dual	exp(const dual& a) {
+		T	e = ::exp(a._v);
+		return a.chain(e, e, e);
+	}
+	friend dual	log(const dual& a) {
+		return a.chain(::log(a._v), 1 / a._v, -1 / (a._v * a._v));
+	}
+	friend dual	sqrt(const dual& a) {
+		T	s = ::sqrt(a._v);
+		return a.chain(s, 1 / (2 * s), -1 / (4 * s * a._v));
+	}
+	friend dual	sinh(const dual& a) {
+		T	s = ::sinh(a._v);
+		return a.chain(s, ::cosh(a._v), s);
+	}
+	friend dual	cosh(const dual& a) {
+		T	c = ::cosh(a._v);
+		return a.chain(c, ::sinh(a._v), c);
+	}
+	friend dual	pow(const dual& a, T e) {
+		T	p = ::pow(a._v, e - 2);
+		return a.chain(p * a._v * a._v, e * p * a._v, e * (e - 1) * p);
+	}
+};
+
+} // namespace csg
+
+#endif /* _Dual_h */
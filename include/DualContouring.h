@@ -0,0 +1,37 @@
+/*
+ * DualContouring.h -- mesh the zero level set of a distance field
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _DualContouring_h
+#define _DualContouring_h
+
+#include <common.h>
+#include <Surface.h>
+#include <DistanceField.h>
+
+namespace csg {
+
+/**
+ * \brief Build the surface of the part of a distance field inside a box
+ *
+ * The box is covered by a grid of cubical cells of the given size and
+ * meshed by the block parallel dual contouring of Contouring. As the
+ * field does not change faster than the distance, only cells near the
+ * surface are visited: an octant of a block is skipped when the value at
+ * its center exceeds its half diagonal.
+ */
+class Build_DistanceField : public Build_Surface {
+	distancefield_ptr	_field;
+	bounds	_box;
+	double	_resolution;
+public:
+	Build_DistanceField(distancefield_ptr field, const bounds& box,
+		double resolution);
+protected:
+	virtual void	build();
+};
+
+} // namespace csg
+
+#endif /* _DualContouring_h */
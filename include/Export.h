@@ -0,0 +1,41 @@
+/*
+ * Export.h -- write meshes in binary STL and 3MF format
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Export_h
+#define _Export_h
+
+#include <common.h>
+#include <Mesh.h>
+#include <string>
+#include <ostream>
+
+namespace csg {
+
+/**
+ * \brief Output formats for models and parts
+ *
+ * OFF is the text format written by CGAL, STL is binary STL and 3MF
+ * is the zip packaged XML format of the 3MF consortium. The STL and 3MF
+ * writers convert every vertex to double exactly once and write through
+ * a buffer, they never print exact numbers. CSGB is the binary format
+ * of Binary.h, which keeps exact coordinates and can be read back.
+ */
+typedef enum output_format_e {
+	OFF_FORMAT, STL_FORMAT, THREEMF_FORMAT, CSGB_FORMAT
+} output_format;
+
+extern output_format	format_from_string(const std::string& name);
+extern std::string	format_extension(output_format format);
+
+extern void	write_stl(std::ostream& out, const IndexedMesh& mesh);
+extern void	write_3mf(std::ostream& out, const IndexedMesh& mesh);
+extern void	write_mesh(const std::string& filename, const IndexedMesh& mesh,
+			output_format format);
+extern void	write_polyhedron(const std::string& filename,
+			const Polyhedron& p, output_format format);
+
+} // namespace csg
+
+#endif /* _Export_h */
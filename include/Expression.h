@@ -0,0 +1,82 @@
+/*
+ * Expression.h -- deferred CSG expressions and their evaluation
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Expression_h
+#define _Expression_h
+
+#include <common.h>
+#include <Bounds.h>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace csg {
+
+/**
+ * \brief Deferred CSG expression
+ *
+ * An expression is a handle to a node of a directed acyclic graph, the
+ * leaves are builders of Nef polyhedra or meshes and boxes, the inner
+ * nodes are unions, intersections, differences, transformations and
+ * clips to axis aligned boxes. Building an expression computes nothing.
+ * evaluate() first rewrites the graph into a plan:
+ *
+ *  - nested unions and intersections are flattened, empty operands are
+ *    removed, differences collect all subtrahends into one union
+ *  - intersections with boxes become clips, which are pushed down to
+ *    the leaves through unions, intersections and differences
+ *  - transformations are pushed down to the leaves, mesh leaves are
+ *    transformed before they are converted to Nef polyhedra
+ *  - operands whose bounding boxes are known and show that they cannot
+ *    contribute are dropped
+ *
+ * Then the plan is evaluated level by level, each node after all its
+ * operands, the nodes of a level concurrently on the thread pool.
+ * Bounded results whose bounding boxes show that an operation is not
+ * needed, e.g. a clip of a leaf that lies inside the box, skip the
+ * operation. Leaves used in several places are built only once per
+ * evaluation. With the extended kernel, transformations of Nef leaves
+ * are limited to those supported by Nef_polyhedron_3::transform.
+ */
+class Expression {
+public:
+	typedef std::function<Nef_polyhedron()>	builder_type;
+	typedef std::function<Polyhedron()>	mesh_builder_type;
+	typedef enum node_e {
+		EMPTY_NODE, LEAF_NODE, MESH_NODE, BOX_NODE,
+		UNION_NODE, INTERSECTION_NODE, DIFFERENCE_NODE,
+		TRANSFORM_NODE, CLIP_NODE
+	} node_type;
+	class node;
+	typedef std::shared_ptr<const node>	nodeptr;
+private:
+	nodeptr	_node;
+public:
+	Expression();
+	Expression(const nodeptr& n) : _node(n) { }
+	const nodeptr&	root() const { return _node; }
+	node_type	type() const;
+	bool	empty() const { return type() == EMPTY_NODE; }
+	static Expression	leaf(const std::string& name,
+					const builder_type& builder);
+	static Expression	leaf(const std::string& name,
+					const builder_type& builder,
+					const bounds& box);
+	static Expression	mesh(const std::string& name,
+					const mesh_builder_type& builder);
+	static Expression	box(const point& a, const point& b);
+	Expression	operator+(const Expression& other) const;
+	Expression	operator*(const Expression& other) const;
+	Expression	operator-(const Expression& other) const;
+	Expression	transform(const Aff_transformation& t) const;
+	Expression	clip(const bounds& box) const;
+	Expression	plan() const;
+	std::string	str() const;
+	Nef_polyhedron	evaluate() const;
+};
+
+} // namespace csg
+
+#endif /* _Expression_h */
@@ -0,0 +1,56 @@
+/*
+ * GridKernels.h -- vectorized vertex generation for grid surfaces
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _GridKernels_h
+#define _GridKernels_h
+
+namespace csg {
+
+/**
+ * \brief Name of the instruction set the grid kernels were compiled for
+ *
+ * "avx", "sse2" or "scalar", depending on the compiler flags. The
+ * kernels are written once against a four lane abstraction, so all
+ * variants produce the same vertices.
+ */
+extern const char	*grid_kernel_isa();
+
+/**
+ * \brief Equidistant grid coordinates c[i] = min + i * delta, 0 <= i < n
+ */
+extern void	grid_coordinates(double min, double delta, int n, double *c);
+
+/**
+ * \brief Vertices of a row of a z-function surface
+ *
+ * For every i < n, writes the top vertex (x, y[i], z[i] + offset) and the
+ * bottom vertex (x, y[i], z[i] - offset) to vertices[6 * i ... 6 * i + 5].
+ */
+extern void	cartesian_vertices(double x, const double *y, const double *z,
+			int n, double offset, double *vertices);
+
+/**
+ * \brief Vertices of a ring of a polar z-function surface
+ *
+ * Like cartesian_vertices, but the vertices are at r * cosphi[i],
+ * r * sinphi[i] in the xy-plane.
+ */
+extern void	polar_vertices(double r, const double *cosphi,
+			const double *sinphi, const double *z,
+			int n, double offset, double *vertices);
+
+/**
+ * \brief Vertices offset from surface points along the normal
+ *
+ * p and v contain n points and normal vectors as consecutive coordinate
+ * triples. Writes p[i] + offset * v[i] and p[i] - offset * v[i] to
+ * vertices[6 * i ... 6 * i + 5].
+ */
+extern void	offset_vertices(const double *p, const double *v,
+			int n, double offset, double *vertices);
+
+} // namespace csg
+
+#endif /* _GridKernels_h */
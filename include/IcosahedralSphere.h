@@ -1,5 +1,5 @@
 /*
- * IcosahedralSphere.h
+ * IcosahedralSphere.h -- geodesic sphere from a subdivided icosahedron
  *
  * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
@@ -7,17 +7,30 @@
 #define _IcosahedralSphere_h
 
 #include <common.h>
+#include <Surface.h>
 
 namespace csg {
 
-class Build_IcosahedralSphere : public CGAL::Modifier_base<Polyhedron::HalfedgeDS> {
+/**
+ * \brief Build a geodesic sphere
+ *
+ * The faces of an icosahedron are subdivided level times into four
+ * triangles each, the new vertices are projected onto the sphere. Unlike
+ * the spherical sphere, all triangles have almost the same size, and
+ * there are no poles. Level n gives 20 * 4^n triangles, the distance
+ * between the sphere and the mesh is at most 0.3 * radius / 4^n.
+ */
+class Build_IcosahedralSphere : public Build_Surface {
 	double	_radius;
-	int	_steps;
+	int	_level;
 public:
-	Build_IcosahedralSphere(double radius, int steps)
-		: _radius(radius), _steps(steps) {
+	Build_IcosahedralSphere(double radius, int level)
+		: _radius(radius), _level(level) {
 	}
-	void	operator()(Polyhedron::HalfedgeDS& hds);
+	virtual int	expected_vertices() const;
+	virtual int	expected_facets() const;
+protected:
+	virtual void	build();
 };
 
 } // namespace csg
@@ -0,0 +1,67 @@
+/*
+ * Implicit.h -- build thickened implicit surfaces F(x,y,z) = 0
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Implicit_h
+#define _Implicit_h
+
+#include <common.h>
+#include <Surface.h>
+#include <Bounds.h>
+
+namespace csg {
+
+/**
+ * \brief Function of three variables defining a surface F(x,y,z) = 0
+ *
+ * Derived classes may override evaluate() to compute a whole row of
+ * values at once, and gradient() if the derivatives are known. The row
+ * evaluate() stores the values at p + i * dx for from <= i < to in
+ * values[i - from], the points must be computed from p and i like this,
+ * so that parts of the same row give identical values.
+ */
+class ImplicitFunction {
+public:
+	virtual ~ImplicitFunction() { }
+	virtual double	operator()(const point& p) const = 0;
+	virtual void	evaluate(const point& p, double dx, int from, int to,
+				double *values) const;
+	virtual vector	gradient(const point& p, double h) const;
+};
+
+/**
+ * \brief Build the part of a thickened implicit surface inside a box
+ *
+ * The function is sampled on a grid of cubical cells of the given size
+ * covering the box, block by block as the blocks are contoured, so the
+ * memory needed does not grow with the number of grid points.
+ * Dividing the values by the length of the gradient estimated from the
+ * neighbouring grid points gives the approximate distance from the
+ * surface, and the solid is the set of points within thickness / 2 of the
+ * surface. A thickness of 0 builds the solid F(x,y,z) < 0 instead. The
+ * solid is clipped to the box and meshed by block parallel dual
+ * contouring, so the mesh is closed and combinatorially a manifold.
+ * Vertices that would lie outside their cell fall back to the mass point
+ * of the crossings, so triangles may still intersect where the surface is
+ * not resolved, set validation() to reject such meshes. The thickness
+ * should be a few cells for the sheet to be resolved.
+ */
+class Build_Implicit : public Build_Surface {
+	const ImplicitFunction&	_f;
+	bounds	_box;
+	double	_resolution;
+	double	_thickness;
+public:
+	Build_Implicit(const ImplicitFunction& f, const bounds& box,
+		double resolution, double thickness)
+		: _f(f), _box(box), _resolution(resolution),
+		  _thickness(thickness) {
+	}
+protected:
+	virtual void	build();
+};
+
+} // namespace csg
+
+#endif /* _Implicit_h */
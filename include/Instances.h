@@ -0,0 +1,69 @@
+/*
+ * Instances.h -- build primitives once and place copies of them
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Instances_h
+#define _Instances_h
+
+#include <common.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace csg {
+
+/**
+ * \brief Cache of primitives placed by affine transformations
+ *
+ * A primitive is identified by a key that must encode all parameters of
+ * its builder. The first request for a key builds the polyhedron, the
+ * first request for a Nef polyhedron converts it, all later requests
+ * only copy and transform the cached geometry. The process wide cache
+ * returned by cache() is safe to use from several threads, different
+ * primitives are built concurrently.
+ */
+class PrimitiveCache {
+public:
+	typedef std::function<void(Polyhedron&)>	builder_type;
+private:
+	class primitive {
+	public:
+		std::mutex	mutex;
+		bool	built;
+		Polyhedron	polyhedron;
+		bool	converted;
+		Nef_polyhedron	nef;
+		primitive() : built(false), converted(false) { }
+	};
+	typedef std::shared_ptr<primitive>	primitiveptr;
+	std::mutex	_mutex;
+	std::map<std::string, primitiveptr>	_primitives;
+	primitiveptr	find(const std::string& key, const builder_type& builder,
+				std::unique_lock<std::mutex>& lock);
+	PrimitiveCache(const PrimitiveCache& other);
+	PrimitiveCache&	operator=(const PrimitiveCache& other);
+public:
+	PrimitiveCache() { }
+	static PrimitiveCache&	cache();
+	size_t	size();
+	void	clear();
+	Polyhedron	polyhedron(const std::string& key,
+				const builder_type& builder,
+				const Aff_transformation& t);
+	Nef_polyhedron	nef(const std::string& key,
+				const builder_type& builder,
+				const Aff_transformation& t);
+};
+
+extern Aff_transformation	placement(const point& from, const point& to);
+extern Polyhedron	arrow_polyhedron(const point& from, const point& to,
+				double radius, int steps = 4);
+extern Nef_polyhedron	arrow_nef(const point& from, const point& to,
+				double radius, int steps = 4);
+
+} // namespace csg
+
+#endif /* _Instances_h */
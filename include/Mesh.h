@@ -0,0 +1,40 @@
+/*
+ * Mesh.h -- flat indexed triangle meshes
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Mesh_h
+#define _Mesh_h
+
+#include <common.h>
+#include <vector>
+
+namespace csg {
+
+/**
+ * \brief Triangle mesh stored as contiguous vertex and index arrays
+ *
+ * Vertex i has coordinates vertices[3 * i], vertices[3 * i + 1] and
+ * vertices[3 * i + 2], triangle j consists of the vertices with indices
+ * triangles[3 * j], triangles[3 * j + 1] and triangles[3 * j + 2],
+ * oriented counterclockwise when seen from the outside.
+ */
+class IndexedMesh {
+public:
+	std::vector<double>	vertices;
+	std::vector<int>	triangles;
+	IndexedMesh() { }
+	IndexedMesh(const Polyhedron& p);
+	int	number_of_vertices() const { return vertices.size() / 3; }
+	int	number_of_triangles() const { return triangles.size() / 3; }
+	void	reserve(int nvertices, int ntriangles);
+	int	add_vertex(double x, double y, double z);
+	int	add_vertex(const point& p);
+	double	*append_vertices(int n);
+	void	add_triangle(int a, int b, int c);
+	point	vertex(int i) const;
+};
+
+} // namespace csg
+
+#endif /* _Mesh_h */
@@ -7,23 +7,32 @@
 #define _Parts_h
 
 #include <common.h>
+#include <Export.h>
 #include <string>
+#include <vector>
 
 namespace csg {
 
 class PartWriter {
 	std::string	prefix;
-	void	write_part(Nef_polyhedron& image, const std::string& part,
+	output_format	_format;
+	void	write_part(const Nef_polyhedron& image, const std::string& part,
 			const Nef_polyhedron& halfspace) const;
 public:
-	PartWriter(const std::string& prefix);
+	PartWriter(const std::string& prefix,
+		output_format format = OFF_FORMAT);
 	typedef enum parts {
 		LEFT_PART, RIGHT_PART,
 		FRONT_PART, BACK_PART,
 		TOP_PART, BOTTOM_PART
 	} object_part;
+	static std::string	partname(const object_part& part);
+	static Nef_polyhedron	parthalfspace(const object_part& part,
+					double offset = 0);
 	void	operator()(const object_part& part, Nef_polyhedron& image,
 			double offset = 0) const;
+	void	operator()(const std::vector<object_part>& parts,
+			Nef_polyhedron& image, double offset = 0) const;
 };
 
 } // namespace csg
@@ -8,31 +8,54 @@
 
 #include <common.h>
 #include <Surface.h>
+#include <AdaptiveGrid.h>
+#include <Bounds.h>
+#include <memory>
+#include <vector>
 
 namespace csg {
 
 /**
  * \brief build a surface on a polar domain
+ *
+ * As for cartesian surfaces, a tolerance can be set to refine the grid
+ * only where needed, and a clip box trims the domain to the grid cells
+ * that may meet the box. A trimmed domain no longer closes around or
+ * contains the origin unless it keeps all angles or the innermost ring.
  */
 class Build_Polar : public Build_Surface {
+	PolarDomain	_fulldomain;
 	PolarDomain	_domain;
 protected:
 	virtual point	p(double r, double phi, double h) = 0;
+	virtual void	ring(double r, const double *phi, const double *cosphi,
+				const double *sinphi, int n, double h,
+				double *vertices);
 private:
 	// grid parametrization
+	int	_fullrsteps, _fullphisteps;
 	int	_rsteps, _phisteps;
 	double	_h;
+	double	_tolerance;
+	std::unique_ptr<AdaptiveGrid>	_grid;
+	bounds	_clip;
+	bool	_outside;
+	// full grid sampled by trim(), and the window of it that is kept
+	std::vector<double>	_samples;
+	int	_window[4];
+	void	trim();
+	void	build_adaptive();
 
 	// members used during constrution
 	double	deltar, deltaphi;
 	double	_phi, _r;
 
 	// add vertices
-	void	add_vertices(Builder& B);
-	void	add_surface_triangles(Builder& B);
-	void	add_surface_fan(Builder& B);
-	void	add_radius_surface(Builder& B);
-	void	add_perimeter(Builder& B);
+	void	add_vertices();
+	void	add_surface_triangles();
+	void	add_surface_fan();
+	void	add_radius_surface();
+	void	add_perimeter();
 
 	// information about the structure
 	bool	closed() const;
@@ -43,11 +66,22 @@ private:
 public:
 	Build_Polar(const PolarDomain& domain,
 		int rsteps, int phisteps, double h)
-		: _domain(domain), _rsteps(rsteps), _phisteps(phisteps), _h(h) {
+		: _fulldomain(domain), _domain(domain),
+		  _fullrsteps(rsteps), _fullphisteps(phisteps),
+		  _rsteps(rsteps), _phisteps(phisteps), _h(h),
+		  _tolerance(0), _outside(false) {
 		deltar = _domain.rrange().length() / _rsteps;
 		deltaphi = _domain.phirange().length() / _phisteps;
 	}
-	void	operator()(Polyhedron::HalfedgeDS& hds);
+	double	tolerance() const { return _tolerance; }
+	void	tolerance(double t) { _tolerance = t; _grid.reset(); }
+	const bounds&	clip() const { return _clip; }
+	void	clip(const bounds& box) { _clip = box; }
+	virtual int	expected_vertices() const;
+	virtual int	expected_facets() const;
+protected:
+	virtual void	prepare();
+	virtual void	build();
 };
 
 /**
@@ -57,6 +91,9 @@ class Build_PolarFunction : public Build_Polar {
 	Function&	_f;
 protected:
 	virtual point	p(double r, double phi, double h);
+	virtual void	ring(double r, const double *phi, const double *cosphi,
+				const double *sinphi, int n, double h,
+				double *vertices);
 public:
 	Build_PolarFunction(Function& f, const PolarDomain& domain,
 		int rsteps, int phisteps, double h)
@@ -71,6 +108,9 @@ class Build_PolarPointFunction : public Build_Polar {
 	PointFunction&	_f;
 protected:
 	virtual point	p(double r, double phi, double h);
+	virtual void	ring(double r, const double *phi, const double *cosphi,
+				const double *sinphi, int n, double h,
+				double *vertices);
 public:
 	Build_PolarPointFunction(PointFunction& f, const PolarDomain& domain,
 		int rsteps, int phisteps, double h)
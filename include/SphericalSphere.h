@@ -18,7 +18,10 @@ public:
 	Build_SphericalSphere(double radius, int steps)
 		: _radius(radius), _steps(steps) {
 	}
-	void	operator()(Polyhedron::HalfedgeDS& hds);
+	virtual int	expected_vertices() const;
+	virtual int	expected_facets() const;
+protected:
+	virtual void	build();
 };
 
 } // namespace csg
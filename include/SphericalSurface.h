@@ -23,7 +23,10 @@ public:
 	Build_SphericalSurface(SphericalFunction& f, int steps)
 		: _f(f), _steps(steps) {
 	}
-	void	operator()(Polyhedron::HalfedgeDS& hds);
+	virtual int	expected_vertices() const;
+	virtual int	expected_facets() const;
+protected:
+	virtual void	build();
 };
 
 } // namespace csg
@@ -7,13 +7,33 @@
 #define _Surface_h
 
 #include <common.h>
+#include <Mesh.h>
+#include <Decimation.h>
 
 namespace csg {
 
 /**
  * \brief Build a surface
+ *
+ * Derived classes implement the build() method, which creates the
+ * surface as an indexed triangle mesh using add_vertex() and add_facet().
+ * The mesh can be retrieved directly with the mesh() method, e.g. for
+ * export, or bulk loaded into a polyhedron by delegating the builder
+ * to the polyhedron. Builders knowing the size of the mesh in advance
+ * report it through expected_vertices() and expected_facets(), so that
+ * the arrays can be allocated once. Since all surfaces are closed
+ * triangle meshes, every facet has three halfedges. Builders that only
+ * know their size after some preparation, e.g. trimming their domain to
+ * a clip box, do that preparation in prepare(), which is called before
+ * the arrays are allocated. If a maximum
+ * deviation is set with decimation(), the mesh is decimated after it
+ * has been built, before it is handed to the polyhedron. If validation()
+ * is set, a mesh with intersecting triangles is rejected with an
+ * exception, long before the conversion to a Nef polyhedron would fail
+ * or produce garbage.
  */
 class Build_Surface : public CGAL::Modifier_base<Polyhedron::HalfedgeDS> {
+	IndexedMesh	*_mesh;
 	int	_vertexnumber;
 public:
 	const int&	vertexnumber() const { return _vertexnumber; }
@@ -21,17 +41,59 @@ private:
 	int	_facetnumber;
 public:
 	const int&	facetnumber() const { return _facetnumber; }
+private:
+	double	_maxdeviation;
+public:
+	const double&	decimation() const { return _maxdeviation; }
+	void	decimation(double maxdeviation) {
+		_maxdeviation = maxdeviation;
+	}
+private:
+	bool	_validation;
+public:
+	const bool&	validation() const { return _validation; }
+	void	validation(bool v) { _validation = v; }
 public:
 	Build_Surface() {
+		_mesh = NULL;
 		_vertexnumber = 0;
 		_facetnumber = 0;
+		_maxdeviation = 0;
+		_validation = false;
 	}
+	virtual ~Build_Surface() { }
+	virtual int	expected_vertices() const { return 0; }
+	virtual int	expected_facets() const { return 0; }
+	int	expected_halfedges() const { return 3 * expected_facets(); }
+	void	mesh(IndexedMesh& m);
+	IndexedMesh	mesh();
+	void	operator()(Polyhedron::HalfedgeDS& hds);
 protected:
-	void	add_vertex(Builder& B, const point& p);
-	void	add_vertex(Builder& B, double x, double y, double z);
-	void	add_facet(Builder& B, int a, int b, int c);
+	virtual void	prepare() { }
+	virtual void	build() = 0;
+	void	add_vertex(double x, double y, double z) {
+		_mesh->add_vertex(x, y, z);
+		_vertexnumber++;
+	}
+	void	add_vertex(const point& p) {
+		add_vertex(p.x(), p.y(), p.z());
+	}
+	double	*append_vertices(int n) {
+		_vertexnumber += n;
+		return _mesh->append_vertices(n);
+	}
+	void	add_facet(int a, int b, int c) {
+		_mesh->add_triangle(a, b, c);
+		_facetnumber++;
+	}
+	void	add_sheet(const std::vector<point>& top,
+			const std::vector<point>& bottom,
+			const std::vector<int>& triangles,
+			const std::vector<int>& boundary);
 };
 
+extern void	load(Polyhedron::HalfedgeDS& hds, const IndexedMesh& mesh);
+
 } // namespace csg
 
 #endif /* _Surface_h */
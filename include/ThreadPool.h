@@ -0,0 +1,77 @@
+/*
+ * ThreadPool.h -- worker threads for independent construction tasks
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _ThreadPool_h
+#define _ThreadPool_h
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace csg {
+
+/**
+ * \brief A pool of worker threads executing queued tasks
+ *
+ * There is a process wide pool returned by ThreadPool::pool(), its size
+ * can be set with ThreadPool::concurrency() before it is first used.
+ * A concurrency of 0 means one thread per hardware thread.
+ */
+class ThreadPool {
+public:
+	typedef std::function<void()>	task_type;
+private:
+	std::mutex	_mutex;
+	std::condition_variable	_cond;
+	std::deque<task_type>	_queue;
+	std::vector<std::thread>	_workers;
+	bool	_stop;
+	void	work();
+	static unsigned	_concurrency;
+	// pools cannot be copied
+	ThreadPool(const ThreadPool& other);
+	ThreadPool&	operator=(const ThreadPool& other);
+public:
+	ThreadPool(unsigned threads = 0);
+	~ThreadPool();
+	unsigned	size() const { return _workers.size(); }
+	void	submit(const task_type& task);
+	bool	run_one();
+	static ThreadPool&	pool();
+	static void	concurrency(unsigned threads);
+	static unsigned	concurrency();
+};
+
+/**
+ * \brief A group of tasks that can be waited for
+ *
+ * A thread waiting for a group executes queued tasks of the pool
+ * itself, so tasks may create and wait for groups of their own without
+ * blocking the pool. The first exception thrown by a task of the group
+ * is rethrown by wait().
+ */
+class TaskGroup {
+	ThreadPool&	_pool;
+	std::mutex	_mutex;
+	std::condition_variable	_cond;
+	int	_pending;
+	std::exception_ptr	_exception;
+	void	done(std::exception_ptr x);
+	TaskGroup(const TaskGroup& other);
+	TaskGroup&	operator=(const TaskGroup& other);
+public:
+	TaskGroup(ThreadPool& pool = ThreadPool::pool());
+	~TaskGroup();
+	void	run(const ThreadPool::task_type& task);
+	void	wait();
+};
+
+} // namespace csg
+
+#endif /* _ThreadPool_h */
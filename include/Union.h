@@ -0,0 +1,75 @@
+/*
+ * Union.h -- parallel union of many Nef polyhedra
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Union_h
+#define _Union_h
+
+#include <common.h>
+#include <Bounds.h>
+#include <vector>
+
+namespace csg {
+
+/**
+ * \brief Union of many Nef polyhedra reduced as a balanced tree
+ *
+ * This class has the same interface as Nef_nary_union_3, but the union
+ * is only computed when get_union() is called. The operands are then
+ * merged pairwise in rounds, the merges of each round run concurrently
+ * on the thread pool. Within a round, operands are paired with their
+ * neighbours in the order of their bounding box centers along the
+ * longest axis of the total bounding box, so that nearby pieces are
+ * merged first and disjoint pieces are combined while they are small.
+ *
+ * Polyhedra added as meshes are first grouped into clusters of pieces
+ * that are pairwise apart, i.e. whose surfaces do not meet and neither
+ * of which contains the other. The union of such a cluster is just the
+ * concatenation of the meshes, so it needs no overlay.
+ *
+ * Likewise, two bounded operands with disjoint bounding boxes are merged
+ * by concatenating their meshes, if both are simple. Operands are kept
+ * as meshes as long as possible, and only converted to Nef polyhedra
+ * once, when they are merged with an operand they may overlap.
+ */
+class Parallel_nary_union {
+	class operand {
+	public:
+		bool	ismesh;
+		bool	unbounded;
+		Nef_polyhedron	nef;
+		Polyhedron	polyhedron;
+		bounds	box;
+		operand() : ismesh(false), unbounded(false) { }
+		operand(const Nef_polyhedron& _nef);
+		Nef_polyhedron	to_nef() const;
+		bool	to_mesh(Polyhedron& p) const;
+	};
+	class mesh {
+	public:
+		Polyhedron	polyhedron;
+		bounds	box;
+		mesh(const Polyhedron& _polyhedron, const bounds& _box)
+			: polyhedron(_polyhedron), box(_box) { }
+	};
+	std::vector<operand>	_operands;
+	std::vector<mesh>	_meshes;
+	void	convert_meshes();
+	void	sort();
+	static void	merge(const operand& a, const operand& b,
+				operand& result);
+	void	reduce();
+public:
+	void	add_polyhedron(const Nef_polyhedron& n);
+	void	add_polyhedron(const Polyhedron& p);
+	size_t	size() const { return _operands.size() + _meshes.size(); }
+	Nef_polyhedron	get_union();
+};
+
+extern void	append(Polyhedron& target, const Polyhedron& source);
+extern Polyhedron	concatenate(const Polyhedron& a, const Polyhedron& b);
+
+} // namespace csg
+
+#endif /* _Union_h */
@@ -6,8 +6,24 @@
 #ifndef _common_h
 #define _common_h
 
+/*
+ * The geometric kernel is selected at configure time. The default is the
+ * filtered lazy exact kernel, which only falls back to exact arithmetic
+ * when the floating point filter cannot decide a predicate. Configuring
+ * with --with-kernel=gmpq selects the unfiltered Extended_cartesian<Gmpq>
+ * kernel as a reference. Only the extended kernel can represent unbounded
+ * half spaces, code that needs them should use the halfspace() function
+ * from Box.h, which works with both kernels.
+ */
+#ifdef CSG_KERNEL_GMPQ
 #include <CGAL/Gmpq.h>
 #include <CGAL/Extended_cartesian.h>
+#define CSG_EXTENDED_KERNEL	1
+#define CSG_KERNEL_NAME		"gmpq"
+#else /* CSG_KERNEL_GMPQ */
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#define CSG_KERNEL_NAME		"lazy"
+#endif /* CSG_KERNEL_GMPQ */
 #include <CGAL/Polyhedron_3.h>
 #include <CGAL/Nef_polyhedron_3.h>
 #include <CGAL/Polyhedron_incremental_builder_3.h>
@@ -16,7 +32,11 @@
 
 namespace csg {
 
+#ifdef CSG_KERNEL_GMPQ
 typedef CGAL::Extended_cartesian<CGAL::Gmpq>	Kernel;
+#else /* CSG_KERNEL_GMPQ */
+typedef CGAL::Exact_predicates_exact_constructions_kernel	Kernel;
+#endif /* CSG_KERNEL_GMPQ */
 typedef CGAL::Polyhedron_3<Kernel>		Polyhedron;
 typedef typename Polyhedron::HalfedgeDS::Vertex Vertex;
 typedef typename Vertex::Point  		Point;
@@ -33,6 +53,7 @@ public:
 	const double&	min() const { return _min; }
 	const double&	max() const { return _max; }
 	double	length() const { return _max - _min; }
+	Interval	subinterval(int steps, int a, int b) const;
 	bool	operator==(const Interval& other) const {
 		return (_min == other.min()) && (_max == other.max());
 	}
@@ -43,9 +64,18 @@ public:
 
 extern const Interval	Interval2Pi;
 
+/**
+ * \brief A real valued function of two variables
+ *
+ * Builders evaluate functions a whole grid row at a time through the
+ * evaluate method. The default implementation just calls the function
+ * operator for each point, derived classes may override it when values
+ * along a row can be computed more cheaply together.
+ */
 class Function {
 public:
 	virtual double	operator()(const double, const double) = 0;
+	virtual void	evaluate(double x, const double *y, int n, double *z);
 };
 
 class point;
@@ -114,12 +144,45 @@ public:
  *
  * The method p represents the points of the surface, and v represents the
  * normal vector. This is used to create a 3D-object representing the
- * surface.
+ * surface. The evaluate method computes points and normals for a row of
+ * arguments, stored as consecutive coordinate triples in p and v.
  */
 class PointFunction {
 public:
 	virtual	point	p(double, double) const = 0;
 	virtual vector	v(double, double) const = 0;
+	virtual void	pv(double x, double y, point& p, vector& v) const;
+	virtual void	evaluate(double x, const double *y, int n,
+				double *p, double *v) const;
+};
+
+/**
+ * \brief Devirtualized row evaluation for a concrete point function
+ *
+ * A class F deriving from BatchPointFunction<F> gets an evaluate method
+ * that calls F's p and v (or F's own pv, if it has one) without going
+ * through the virtual function table, so the compiler can inline them
+ * into the loop over the row.
+ */
+template<typename F>
+class BatchPointFunction : public PointFunction {
+public:
+	virtual void	pv(double x, double y, point& p, vector& v) const {
+		const F	*f = static_cast<const F *>(this);
+		p = f->F::p(x, y);
+		v = f->F::v(x, y);
+	}
+	virtual void	evaluate(double x, const double *y, int n,
+				double *p, double *v) const {
+		const F	*f = static_cast<const F *>(this);
+		point	_p;
+		vector	_v;
+		for (int i = 0; i < n; i++) {
+			f->F::pv(x, y[i], _p, _v);
+			p[3 * i] = _p.x(); p[3 * i + 1] = _p.y(); p[3 * i + 2] = _p.z();
+			v[3 * i] = _v.x(); v[3 * i + 1] = _v.y(); v[3 * i + 2] = _v.z();
+		}
+	}
 };
 
 class point_z : public PointFunction {
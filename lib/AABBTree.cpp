@@ -0,0 +1,713 @@
+/*
+ * AABBTree.cpp -- bounding box hierarchy over the triangles of a mesh
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AABBTree.h>
+#include <ThreadPool.h>
+#include <debug.h>
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+namespace csg {
+
+/**
+ * \brief Maximum number of triangles in a leaf
+ */
+static const int	leafsize = 4;
+
+/**
+ * \brief Levels of the tree whose subtrees are built concurrently
+ */
+static const int	paralleldepth = 3;
+
+//////////////////////////////////////////////////////////////////////
+// distances from triangles and segments
+//////////////////////////////////////////////////////////////////////
+
+double	segment_distance2(const point& p, const point& a, const point& b) {
+	vector	ab = b - a;
+	vector	ap = p - a;
+	double	l = ab * ab;
+	double	t = (l > 0) ? (ap * ab) / l : 0;
+	t = std::min(1., std::max(0., t));
+	vector	d = ap - t * ab;
+	return d * d;
+}
+
+/**
+ * \brief Squared distance of a point from a triangle
+ *
+ * This is the closest point computation from Ericson, Real-Time Collision
+ * Detection, which classifies the point by the Voronoi regions of the
+ * vertices, edges and face of the triangle.
+ */
+double	triangle_distance2(const point& p, const point& a, const point& b,
+		const point& c) {
+	vector	ab = b - a, ac = c - a, ap = p - a;
+	double	d1 = ab * ap, d2 = ac * ap;
+	if ((d1 <= 0) && (d2 <= 0)) {
+		return ap * ap;
+	}
+	vector	bp = p - b;
+	double	d3 = ab * bp, d4 = ac * bp;
+	if ((d3 >= 0) && (d4 <= d3)) {
+		return bp * bp;
+	}
+	double	vc = d1 * d4 - d3 * d2;
+	if ((vc <= 0) && (d1 >= 0) && (d3 <= 0)) {
+		vector	d = ap - (d1 / (d1 - d3)) * ab;
+		return d * d;
+	}
+	vector	cp = p - c;
+	double	d5 = ab * cp, d6 = ac * cp;
+	if ((d6 >= 0) && (d5 <= d6)) {
+		return cp * cp;
+	}
+	double	vb = d5 * d2 - d1 * d6;
+	if ((vb <= 0) && (d2 >= 0) && (d6 <= 0)) {
+		vector	d = ap - (d2 / (d2 - d6)) * ac;
+		return d * d;
+	}
+	double	va = d3 * d6 - d5 * d4;
+	if ((va <= 0) && ((d4 - d3) >= 0) && ((d5 - d6) >= 0)) {
+		double	w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		vector	d = bp - w * (c - b);
+		return d * d;
+	}
+	double	denominator = 1 / (va + vb + vc);
+	vector	d = ap - (vb * denominator) * ab - (vc * denominator) * ac;
+	return d * d;
+}
+
+/**
+ * \brief Squared distance between two segments
+ *
+ * Also from Ericson, the closest points are found by clamping the
+ * parameters of the closest points of the lines to the segments.
+ */
+static double	segment_segment_distance2(const point& p1, const point& q1,
+			const point& p2, const point& q2) {
+	vector	d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+	double	a = d1 * d1, e = d2 * d2, f = d2 * r;
+	double	s = 0, t = 0;
+	if ((a <= 0) && (e <= 0)) {
+		return r * r;
+	}
+	if (a <= 0) {
+		t = std::min(1., std::max(0., f / e));
+	} else {
+		double	c = d1 * r;
+		if (e <= 0) {
+			s = std::min(1., std::max(0., -c / a));
+		} else {
+			double	b = d1 * d2;
+			double	denominator = a * e - b * b;
+			if (denominator > 0) {
+				s = std::min(1., std::max(0.,
+					(b * f - c * e) / denominator));
+			}
+			t = (b * s + f) / e;
+			if (t < 0) {
+				t = 0;
+				s = std::min(1., std::max(0., -c / a));
+			} else if (t > 1) {
+				t = 1;
+				s = std::min(1., std::max(0., (b - c) / a));
+			}
+		}
+	}
+	vector	d = r + s * d1 - t * d2;
+	return d * d;
+}
+
+//////////////////////////////////////////////////////////////////////
+// intersection of triangles
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Whether x lies in the triangle abc with normal n, x in its plane
+ */
+static bool	in_triangle(const point& x, const point& a, const point& b,
+			const point& c, const vector& n) {
+	return ((b - a).cross(x - a) * n >= 0)
+		&& ((c - b).cross(x - b) * n >= 0)
+		&& ((a - c).cross(x - c) * n >= 0);
+}
+
+/**
+ * \brief Whether two segments in a plane with normal n meet
+ */
+static bool	coplanar_segments(const point& p, const point& q,
+			const point& u, const point& w, const vector& n) {
+	double	o1 = (q - p).cross(u - p) * n;
+	double	o2 = (q - p).cross(w - p) * n;
+	double	o3 = (w - u).cross(p - u) * n;
+	double	o4 = (w - u).cross(q - u) * n;
+	if ((o1 == 0) && (o2 == 0)) {
+		// collinear, compare the projections onto the line
+		vector	d = q - p;
+		double	s0 = (u - p) * d, s1 = (w - p) * d;
+		return (std::max(s0, s1) >= 0)
+			&& (std::min(s0, s1) <= d * d);
+	}
+	return (o1 * o2 <= 0) && (o3 * o4 <= 0);
+}
+
+/**
+ * \brief Whether the segment pq meets the triangle abc
+ */
+static bool	segment_meets_triangle(const point& p, const point& q,
+			const point& a, const point& b, const point& c) {
+	vector	n = (b - a).cross(c - a);
+	if (!(n * n > 0)) {
+		return false;
+	}
+	double	dp = n * (p - a), dq = n * (q - a);
+	if (((dp > 0) && (dq > 0)) || ((dp < 0) && (dq < 0))) {
+		return false;
+	}
+	if ((dp == 0) && (dq == 0)) {
+		return in_triangle(p, a, b, c, n) || in_triangle(q, a, b, c, n)
+			|| coplanar_segments(p, q, a, b, n)
+			|| coplanar_segments(p, q, b, c, n)
+			|| coplanar_segments(p, q, c, a, n);
+	}
+	point	x = p + (dp / (dp - dq)) * (q - p);
+	return in_triangle(x, a, b, c, n);
+}
+
+/**
+ * \brief Whether two triangles meet
+ *
+ * If two triangles meet, an edge of one of them meets the other one.
+ */
+static bool	triangles_meet(const point *t, const point *u) {
+	for (int i = 0; i < 3; i++) {
+		if (segment_meets_triangle(t[i], t[(i + 1) % 3],
+			u[0], u[1], u[2])) {
+			return true;
+		}
+		if (segment_meets_triangle(u[i], u[(i + 1) % 3],
+			t[0], t[1], t[2])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * \brief Squared distance between two triangles
+ */
+static double	triangle_triangle_distance2(const point *t, const point *u) {
+	if (triangles_meet(t, u)) {
+		return 0;
+	}
+	double	d = std::numeric_limits<double>::infinity();
+	for (int i = 0; i < 3; i++) {
+		d = std::min(d, triangle_distance2(t[i], u[0], u[1], u[2]));
+		d = std::min(d, triangle_distance2(u[i], t[0], t[1], t[2]));
+		for (int j = 0; j < 3; j++) {
+			d = std::min(d, segment_segment_distance2(t[i],
+				t[(i + 1) % 3], u[j], u[(j + 1) % 3]));
+		}
+	}
+	return d;
+}
+
+//////////////////////////////////////////////////////////////////////
+// construction
+//////////////////////////////////////////////////////////////////////
+
+AABBTree::AABBTree(const IndexedMesh& mesh) {
+	setup(mesh);
+}
+
+AABBTree::AABBTree(const Polyhedron& p) {
+	setup(IndexedMesh(p));
+}
+
+/**
+ * \brief Collect the triangles and build the tree
+ *
+ * The depth is the smallest one for which halving the triangles at every
+ * level leaves at most leafsize triangles in each leaf.
+ */
+void	AABBTree::setup(const IndexedMesh& mesh) {
+	for (int i = 0; i < mesh.number_of_vertices(); i++) {
+		_vertices.push_back(mesh.vertex(i));
+	}
+	int	n = mesh.number_of_triangles();
+	_triangles.resize(n);
+	for (int i = 0; i < n; i++) {
+		triangle&	t = _triangles[i];
+		t.index = i;
+		for (int k = 0; k < 3; k++) {
+			t.v[k] = mesh.triangles[3 * i + k];
+		}
+		t.a = _vertices[t.v[0]];
+		t.b = _vertices[t.v[1]];
+		t.c = _vertices[t.v[2]];
+		t.box = bounds(t.a, t.b);
+		t.box.add(t.c);
+	}
+	if (n == 0) {
+		_depth = 0;
+		return;
+	}
+	_depth = 0;
+	while (((n - 1) >> _depth) + 1 > leafsize) {
+		_depth++;
+	}
+	_nodes.resize((2 << _depth) - 1);
+	build(0, 0, n, 0);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "tree of %d triangles, depth %d", n,
+		_depth);
+}
+
+/**
+ * \brief Build the subtree of node n for count triangles
+ */
+void	AABBTree::build(int n, int first, int count, int depth) {
+	node&	nd = _nodes[n];
+	nd.first = first;
+	nd.count = count;
+	std::vector<triangle>::iterator	begin = _triangles.begin() + first;
+	if (depth == _depth) {
+		for (int i = 0; i < count; i++) {
+			nd.box.add(begin[i].box);
+		}
+		return;
+	}
+	bounds	centers;
+	for (int i = 0; i < count; i++) {
+		centers.add(begin[i].box.center());
+	}
+	vector	e = centers.extent();
+	int	axis = 0;
+	if ((e.y() >= e.x()) && (e.y() >= e.z())) {
+		axis = 1;
+	}
+	if ((e.z() >= e.x()) && (e.z() >= e.y())) {
+		axis = 2;
+	}
+	int	half = count / 2;
+	std::nth_element(begin, begin + half, begin + count,
+		[axis](const triangle& s, const triangle& t) {
+			point	cs = s.box.center();
+			point	ct = t.box.center();
+			switch (axis) {
+			case 0:	return cs.x() < ct.x();
+			case 1:	return cs.y() < ct.y();
+			}
+			return cs.z() < ct.z();
+		});
+	if ((depth < paralleldepth) && (count > 1024)) {
+		TaskGroup	group;
+		group.run([this, n, first, half, depth]() {
+			build(2 * n + 1, first, half, depth + 1);
+		});
+		build(2 * n + 2, first + half, count - half, depth + 1);
+		group.wait();
+	} else {
+		build(2 * n + 1, first, half, depth + 1);
+		build(2 * n + 2, first + half, count - half, depth + 1);
+	}
+	nd.box.add(_nodes[2 * n + 1].box);
+	nd.box.add(_nodes[2 * n + 2].box);
+}
+
+bool	AABBTree::leaf(int n) const {
+	return 2 * n + 1 >= (int)_nodes.size();
+}
+
+bounds	AABBTree::box() const {
+	return (_nodes.empty()) ? bounds() : _nodes[0].box;
+}
+
+//////////////////////////////////////////////////////////////////////
+// intersection queries
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Whether two triangles of the same mesh intersect
+ *
+ * Triangles sharing an edge are neighbours and never reported. Triangles
+ * sharing a single vertex intersect if the opposite edge of one of them
+ * meets the other one.
+ */
+static bool	self_meet(const point *t, const int *tv, const point *u,
+			const int *uv) {
+	int	shared = 0, ti = 0, ui = 0;
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			if (tv[i] == uv[j]) {
+				shared++;
+				ti = i;
+				ui = j;
+			}
+		}
+	}
+	if (shared == 0) {
+		return triangles_meet(t, u);
+	}
+	if (shared > 1) {
+		return false;
+	}
+	return segment_meets_triangle(t[(ti + 1) % 3], t[(ti + 2) % 3],
+			u[0], u[1], u[2])
+		|| segment_meets_triangle(u[(ui + 1) % 3], u[(ui + 2) % 3],
+			t[0], t[1], t[2]);
+}
+
+/**
+ * \brief Find intersecting pairs of triangles within the subtree of node n
+ *
+ * If result is NULL, the search stops at the first pair found.
+ */
+bool	AABBTree::self_pairs(int n, std::vector<triangle_pair> *result) const {
+	if (leaf(n)) {
+		const node&	nd = _nodes[n];
+		bool	found = false;
+		for (int i = nd.first; i < nd.first + nd.count; i++) {
+			const triangle&	t = _triangles[i];
+			point	tp[3] = { t.a, t.b, t.c };
+			for (int j = i + 1; j < nd.first + nd.count; j++) {
+				const triangle&	u = _triangles[j];
+				if (!t.box.overlaps(u.box)) {
+					continue;
+				}
+				point	up[3] = { u.a, u.b, u.c };
+				if (self_meet(tp, t.v, up, u.v)) {
+					if (NULL == result) {
+						return true;
+					}
+					result->push_back(triangle_pair(t.index,
+						u.index));
+					found = true;
+				}
+			}
+		}
+		return found;
+	}
+	bool	found = self_pairs(2 * n + 1, result);
+	if (found && (NULL == result)) {
+		return true;
+	}
+	found = self_pairs(2 * n + 2, result) || found;
+	if (found && (NULL == result)) {
+		return true;
+	}
+	return pairs(2 * n + 1, *this, 2 * n + 2, 0, result) || found;
+}
+
+/**
+ * \brief Find pairs of triangles of node n and of node m of other tree
+ *        closer than the margin
+ *
+ * If other is this tree, triangles are tested as in self intersection.
+ * If result is NULL, the search stops at the first pair found.
+ */
+bool	AABBTree::pairs(int n, const AABBTree& other, int m, double margin,
+		std::vector<triangle_pair> *result) const {
+	const node&	a = _nodes[n];
+	const node&	b = other._nodes[m];
+	if (a.box.distance(b.box) > margin) {
+		return false;
+	}
+	if (leaf(n) && other.leaf(m)) {
+		bool	same = (&other == this);
+		bool	found = false;
+		for (int i = a.first; i < a.first + a.count; i++) {
+			const triangle&	t = _triangles[i];
+			point	tp[3] = { t.a, t.b, t.c };
+			for (int j = b.first; j < b.first + b.count; j++) {
+				const triangle&	u = other._triangles[j];
+				if (t.box.distance(u.box) > margin) {
+					continue;
+				}
+				point	up[3] = { u.a, u.b, u.c };
+				bool	meet;
+				if (same) {
+					meet = self_meet(tp, t.v, up, u.v);
+				} else if (margin > 0) {
+					meet = triangle_triangle_distance2(tp, up)
+						<= margin * margin;
+				} else {
+					meet = triangles_meet(tp, up);
+				}
+				if (!meet) {
+					continue;
+				}
+				if (NULL == result) {
+					return true;
+				}
+				result->push_back(triangle_pair(t.index, u.index));
+				found = true;
+			}
+		}
+		return found;
+	}
+	// descend into the node with the larger box
+	bool	split = other.leaf(m) || ((!leaf(n))
+		&& (a.box.extent().norm() > b.box.extent().norm()));
+	bool	found;
+	if (split) {
+		found = pairs(2 * n + 1, other, m, margin, result);
+		if (found && (NULL == result)) {
+			return true;
+		}
+		return pairs(2 * n + 2, other, m, margin, result) || found;
+	}
+	found = pairs(n, other, 2 * m + 1, margin, result);
+	if (found && (NULL == result)) {
+		return true;
+	}
+	return pairs(n, other, 2 * m + 2, margin, result) || found;
+}
+
+bool	AABBTree::self_intersects() const {
+	if (_nodes.empty()) {
+		return false;
+	}
+	return self_pairs(0, NULL);
+}
+
+/**
+ * \brief Pairs of intersecting triangles of the mesh that are not
+ *        neighbours
+ */
+std::vector<AABBTree::triangle_pair>	AABBTree::self_intersections() const {
+	std::vector<triangle_pair>	result;
+	if (!_nodes.empty()) {
+		self_pairs(0, &result);
+	}
+	return result;
+}
+
+/**
+ * \brief Whether a triangle of this mesh is within margin of one of other
+ */
+bool	AABBTree::intersects(const AABBTree& other, double margin) const {
+	if (_nodes.empty() || other._nodes.empty()) {
+		return false;
+	}
+	return pairs(0, other, 0, margin, NULL);
+}
+
+/**
+ * \brief Pairs of triangles of this mesh and other within margin
+ *
+ * The first index of each pair is a triangle of this mesh, the second
+ * one a triangle of other.
+ */
+std::vector<AABBTree::triangle_pair>	AABBTree::intersections(
+		const AABBTree& other, double margin) const {
+	std::vector<triangle_pair>	result;
+	if (!(_nodes.empty() || other._nodes.empty())) {
+		pairs(0, other, 0, margin, &result);
+	}
+	return result;
+}
+
+//////////////////////////////////////////////////////////////////////
+// distance queries
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Update the smallest squared distance of p from a triangle
+ */
+void	AABBTree::closest(int n, const point& p, double& best) const {
+	const node&	nd = _nodes[n];
+	double	d = bounds(p).distance(nd.box);
+	if (d * d >= best) {
+		return;
+	}
+	if (leaf(n)) {
+		for (int i = nd.first; i < nd.first + nd.count; i++) {
+			const triangle&	t = _triangles[i];
+			best = std::min(best, triangle_distance2(p, t.a, t.b, t.c));
+		}
+		return;
+	}
+	// the nearer child first, it is more likely to reduce best
+	int	l = 2 * n + 1, r = 2 * n + 2;
+	if (bounds(p).distance(_nodes[r].box)
+		< bounds(p).distance(_nodes[l].box)) {
+		std::swap(l, r);
+	}
+	closest(l, p, best);
+	closest(r, p, best);
+}
+
+/**
+ * \brief Distance of a point from the surface
+ */
+double	AABBTree::distance(const point& p) const {
+	double	best = std::numeric_limits<double>::infinity();
+	if (!_nodes.empty()) {
+		closest(0, p, best);
+	}
+	return sqrt(best);
+}
+
+/**
+ * \brief Smallest distance between triangles of node n and of node m of
+ *        other tree, if it is smaller than best
+ */
+double	AABBTree::distance(int n, const AABBTree& other, int m,
+		double best) const {
+	const node&	a = _nodes[n];
+	const node&	b = other._nodes[m];
+	if (a.box.distance(b.box) >= best) {
+		return best;
+	}
+	if (leaf(n) && other.leaf(m)) {
+		for (int i = a.first; i < a.first + a.count; i++) {
+			const triangle&	t = _triangles[i];
+			point	tp[3] = { t.a, t.b, t.c };
+			for (int j = b.first; j < b.first + b.count; j++) {
+				const triangle&	u = other._triangles[j];
+				if (t.box.distance(u.box) >= best) {
+					continue;
+				}
+				point	up[3] = { u.a, u.b, u.c };
+				best = std::min(best,
+					sqrt(triangle_triangle_distance2(tp, up)));
+			}
+		}
+		return best;
+	}
+	bool	split = other.leaf(m) || ((!leaf(n))
+		&& (a.box.extent().norm() > b.box.extent().norm()));
+	if (split) {
+		best = distance(2 * n + 1, other, m, best);
+		return distance(2 * n + 2, other, m, best);
+	}
+	best = distance(n, other, 2 * m + 1, best);
+	return distance(n, other, 2 * m + 2, best);
+}
+
+/**
+ * \brief Smallest distance between the surfaces of two meshes
+ *
+ * The distance is 0 if the surfaces intersect, even if one of the solids
+ * contains the other.
+ */
+double	AABBTree::distance(const AABBTree& other) const {
+	double	best = std::numeric_limits<double>::infinity();
+	if (_nodes.empty() || other._nodes.empty()) {
+		return best;
+	}
+	return distance(0, other, 0, best);
+}
+
+//////////////////////////////////////////////////////////////////////
+// containment queries
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Number of triangles of the subtree of node n hit by the ray
+ *        from p in direction d
+ */
+int	AABBTree::crossings(int n, const point& p, const vector& d) const {
+	const node&	nd = _nodes[n];
+	// slab test of the ray against the box of the node
+	double	lo[3] = { nd.box.min().x(), nd.box.min().y(), nd.box.min().z() };
+	double	hi[3] = { nd.box.max().x(), nd.box.max().y(), nd.box.max().z() };
+	double	o[3] = { p.x(), p.y(), p.z() };
+	double	v[3] = { d.x(), d.y(), d.z() };
+	double	tmin = 0, tmax = std::numeric_limits<double>::infinity();
+	for (int a = 0; a < 3; a++) {
+		if (v[a] == 0) {
+			if ((o[a] < lo[a]) || (o[a] > hi[a])) {
+				return 0;
+			}
+			continue;
+		}
+		double	t0 = (lo[a] - o[a]) / v[a];
+		double	t1 = (hi[a] - o[a]) / v[a];
+		tmin = std::max(tmin, std::min(t0, t1));
+		tmax = std::min(tmax, std::max(t0, t1));
+	}
+	if (tmin > tmax) {
+		return 0;
+	}
+	if (!leaf(n)) {
+		return crossings(2 * n + 1, p, d) + crossings(2 * n + 2, p, d);
+	}
+	// Moeller-Trumbore ray triangle intersection
+	int	result = 0;
+	for (int i = nd.first; i < nd.first + nd.count; i++) {
+		const triangle&	t = _triangles[i];
+		vector	e1 = t.b - t.a, e2 = t.c - t.a;
+		vector	q = d.cross(e2);
+		double	det = e1 * q;
+		if (det == 0) {
+			continue;
+		}
+		vector	s = p - t.a;
+		double	u = (s * q) / det;
+		if ((u < 0) || (u > 1)) {
+			continue;
+		}
+		vector	r = s.cross(e1);
+		double	w = (d * r) / det;
+		if ((w < 0) || (u + w > 1)) {
+			continue;
+		}
+		if ((e2 * r) / det > 0) {
+			result++;
+		}
+	}
+	return result;
+}
+
+/**
+ * \brief Whether a point is inside the closed mesh
+ *
+ * Counts the crossings of a ray in a direction unlikely to be parallel
+ * to any edge of a mesh built on a grid, so the answer may be wrong for
+ * points very close to the surface.
+ */
+bool	AABBTree::inside(const point& p) const {
+	if (_nodes.empty() || !_nodes[0].box.contains(bounds(p))) {
+		return false;
+	}
+	static const vector	d(0.8017836, 0.5345225, 0.2672612);
+	return crossings(0, p, d) & 1;
+}
+
+/**
+ * \brief Whether a vertex of other is inside this mesh
+ */
+bool	AABBTree::contains_any(const AABBTree& other) const {
+	bounds	b = box();
+	for (size_t i = 0; i < other._vertices.size(); i++) {
+		if (b.contains(bounds(other._vertices[i]))
+			&& inside(other._vertices[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * \brief Whether the solids of two closed meshes are apart
+ *
+ * This is the case if no triangles are closer than the margin and no
+ * vertex of one mesh is inside the other one. The union of separated
+ * solids is just the concatenation of their meshes.
+ */
+bool	AABBTree::separated(const AABBTree& other, double margin) const {
+	if (box().distance(other.box()) > margin) {
+		return true;
+	}
+	if (intersects(other, margin)) {
+		return false;
+	}
+	return !(contains_any(other) || other.contains_any(*this));
+}
+
+} // namespace csg
@@ -0,0 +1,250 @@
+/*
+ * AdaptiveGrid.cpp -- adaptive triangulation of a rectangular parameter domain
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AdaptiveGrid.h>
+#include <debug.h>
+#include <set>
+
+namespace csg {
+
+AdaptiveGrid::AdaptiveGrid(const Interval& urange, const Interval& vrange,
+	int usteps, int vsteps, double tolerance, bool wrapv, bool collapseu)
+	: _urange(urange), _vrange(vrange),
+	  _usteps(usteps), _vsteps(vsteps), _tolerance(tolerance),
+	  _wrapv(wrapv), _collapseu(collapseu) {
+}
+
+/**
+ * \brief Surface point at doubled grid indices i2, j2
+ *
+ * Points are computed only once, as neighbouring cells share corners and
+ * the midpoints of a cell become the corners of its children.
+ */
+const point&	AdaptiveGrid::sample(const surface& f, int i2, int j2) {
+	std::pair<int, int>	key(i2, j2);
+	std::map<std::pair<int, int>, point>::const_iterator	i
+		= _samples.find(key);
+	if (i != _samples.end()) {
+		return i->second;
+	}
+	double	du = _urange.length() / _usteps;
+	double	dv = _vrange.length() / _vsteps;
+	point	p = f(_urange.min() + i2 * (du / 2), _vrange.min() + j2 * (dv / 2));
+	return _samples.insert(std::make_pair(key, p)).first->second;
+}
+
+static point	mean(const point& a, const point& b) {
+	return a + (b - a) / 2;
+}
+
+/**
+ * \brief Deviation of the surface from the bilinear interpolation of a cell
+ */
+double	AdaptiveGrid::error(const surface& f, const cell& c) {
+	const point&	p00 = sample(f, 2 * c.i0, 2 * c.j0);
+	const point&	p10 = sample(f, 2 * c.i1, 2 * c.j0);
+	const point&	p01 = sample(f, 2 * c.i0, 2 * c.j1);
+	const point&	p11 = sample(f, 2 * c.i1, 2 * c.j1);
+	int	im2 = c.i0 + c.i1;
+	int	jm2 = c.j0 + c.j1;
+	double	result = (sample(f, im2, jm2)
+			- mean(mean(p00, p10), mean(p01, p11))).norm();
+	double	e[4] = {
+		(sample(f, im2, 2 * c.j0) - mean(p00, p10)).norm(),
+		(sample(f, im2, 2 * c.j1) - mean(p01, p11)).norm(),
+		(sample(f, 2 * c.i0, jm2) - mean(p00, p01)).norm(),
+		(sample(f, 2 * c.i1, jm2) - mean(p10, p11)).norm()
+	};
+	for (int k = 0; k < 4; k++) {
+		if (e[k] > result) {
+			result = e[k];
+		}
+	}
+	return result;
+}
+
+/**
+ * \brief Split a cell until the error is within the tolerance
+ */
+void	AdaptiveGrid::refine(const surface& f, const cell& c) {
+	bool	splitu = (c.i1 - c.i0) > 1;
+	bool	splitv = (c.j1 - c.j0) > 1;
+	if ((!splitu && !splitv) || (error(f, c) <= _tolerance)) {
+		_leaves.push_back(c);
+		return;
+	}
+	int	im = splitu ? (c.i0 + c.i1) / 2 : c.i1;
+	int	jm = splitv ? (c.j0 + c.j1) / 2 : c.j1;
+	refine(f, cell(c.i0, im, c.j0, jm));
+	if (splitu) {
+		refine(f, cell(im, c.i1, c.j0, jm));
+	}
+	if (splitv) {
+		refine(f, cell(c.i0, im, jm, c.j1));
+	}
+	if (splitu && splitv) {
+		refine(f, cell(im, c.i1, jm, c.j1));
+	}
+}
+
+/**
+ * \brief Replace grid indices by those of the identified node
+ */
+void	AdaptiveGrid::canonical(int& i, int& j) const {
+	if (_wrapv && (j == _vsteps)) {
+		j = 0;
+	}
+	if (_collapseu && (i == 0)) {
+		j = 0;
+	}
+}
+
+/**
+ * \brief Index of a grid node in _nodeids
+ */
+int	AdaptiveGrid::gridnode(int i, int j) const {
+	canonical(i, j);
+	return i * (_vsteps + 1) + j;
+}
+
+/**
+ * \brief Add a node at doubled grid indices i2, j2
+ */
+int	AdaptiveGrid::addnode(int i2, int j2) {
+	double	du = _urange.length() / _usteps;
+	double	dv = _vrange.length() / _vsteps;
+	u.push_back(_urange.min() + i2 * (du / 2));
+	v.push_back(_vrange.min() + j2 * (dv / 2));
+	return u.size() - 1;
+}
+
+void	AdaptiveGrid::addtriangle(int a, int b, int c) {
+	if ((a == b) || (b == c) || (c == a)) {
+		return;
+	}
+	triangles.push_back(a);
+	triangles.push_back(b);
+	triangles.push_back(c);
+}
+
+/**
+ * \brief Triangulate a leaf cell
+ *
+ * The nodes on the boundary of the cell are collected counterclockwise.
+ * A cell without hanging nodes is split into two triangles, otherwise a
+ * fan around a new center node is created.
+ */
+void	AdaptiveGrid::triangulate(const cell& c) {
+	std::vector<int>	ring;
+	for (int k = 0; k < 4; k++) {
+		int	length = (k % 2) ? (c.j1 - c.j0) : (c.i1 - c.i0);
+		for (int s = 0; s < length; s++) {
+			int	i, j;
+			switch (k) {
+			case 0:	i = c.i0 + s; j = c.j0; break;
+			case 1:	i = c.i1; j = c.j0 + s; break;
+			case 2:	i = c.i1 - s; j = c.j1; break;
+			default: i = c.i0; j = c.j1 - s; break;
+			}
+			int	id = _nodeids[gridnode(i, j)];
+			if ((id >= 0) && (ring.empty() || (ring.back() != id))) {
+				ring.push_back(id);
+			}
+		}
+	}
+	while ((ring.size() > 1) && (ring.back() == ring.front())) {
+		ring.pop_back();
+	}
+	switch (ring.size()) {
+	case 3:
+		addtriangle(ring[0], ring[1], ring[2]);
+		return;
+	case 4:
+		addtriangle(ring[0], ring[1], ring[3]);
+		addtriangle(ring[3], ring[1], ring[2]);
+		return;
+	}
+	int	center = addnode(c.i0 + c.i1, c.j0 + c.j1);
+	for (unsigned int k = 0; k < ring.size(); k++) {
+		addtriangle(center, ring[k], ring[(k + 1) % ring.size()]);
+	}
+}
+
+/**
+ * \brief Find the edges that belong to only one triangle
+ */
+void	AdaptiveGrid::findboundary() {
+	std::set<std::pair<int, int> >	edges;
+	for (unsigned int t = 0; t < triangles.size(); t += 3) {
+		for (int k = 0; k < 3; k++) {
+			edges.insert(std::make_pair(triangles[t + k],
+				triangles[t + (k + 1) % 3]));
+		}
+	}
+	for (unsigned int t = 0; t < triangles.size(); t += 3) {
+		for (int k = 0; k < 3; k++) {
+			int	a = triangles[t + k];
+			int	b = triangles[t + (k + 1) % 3];
+			if (edges.find(std::make_pair(b, a)) == edges.end()) {
+				boundary.push_back(a);
+				boundary.push_back(b);
+			}
+		}
+	}
+}
+
+/**
+ * \brief Refine the grid for the surface f and triangulate it
+ */
+void	AdaptiveGrid::build(const surface& f) {
+	_samples.clear();
+	_leaves.clear();
+	u.clear();
+	v.clear();
+	triangles.clear();
+	boundary.clear();
+
+	// refine a coarse grid of at most 4 x 4 cells
+	int	cu = (_usteps < 4) ? _usteps : 4;
+	int	cv = (_vsteps < 4) ? _vsteps : 4;
+	for (int a = 0; a < cu; a++) {
+		for (int b = 0; b < cv; b++) {
+			refine(f, cell(a * _usteps / cu, (a + 1) * _usteps / cu,
+				b * _vsteps / cv, (b + 1) * _vsteps / cv));
+		}
+	}
+	_samples.clear();
+
+	// number the cell corners, these are the only grid nodes used
+	_nodeids.assign((_usteps + 1) * (_vsteps + 1), -1);
+	std::vector<cell>::const_iterator	c;
+	for (c = _leaves.begin(); c != _leaves.end(); c++) {
+		int	corners[4][2] = {
+			{ c->i0, c->j0 }, { c->i1, c->j0 },
+			{ c->i0, c->j1 }, { c->i1, c->j1 }
+		};
+		for (int k = 0; k < 4; k++) {
+			int	i = corners[k][0];
+			int	j = corners[k][1];
+			canonical(i, j);
+			int&	id = _nodeids[gridnode(i, j)];
+			if (id < 0) {
+				id = addnode(2 * i, 2 * j);
+			}
+		}
+	}
+
+	for (c = _leaves.begin(); c != _leaves.end(); c++) {
+		triangulate(*c);
+	}
+	findboundary();
+	debug(LOG_DEBUG, DEBUG_LOG, 0,
+		"%d cells, %d nodes, %d triangles, %d boundary edges "
+		"(grid %d x %d)", (int)_leaves.size(), number_of_nodes(),
+		number_of_triangles(), number_of_boundary_edges(),
+		_usteps, _vsteps);
+}
+
+} // namespace csg
@@ -0,0 +1,49 @@
+/*
+ * AngleTable.cpp -- shared tables of equidistant angles and their sin/cos
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AngleTable.h>
+#include <GridKernels.h>
+#include <debug.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace csg {
+
+AngleTable::AngleTable(const Interval& range, int steps)
+	: _angles(steps + 1), _cosines(steps + 1), _sines(steps + 1) {
+	grid_coordinates(range.min(), range.length() / steps, steps + 1,
+		&_angles[0]);
+	for (int i = 0; i <= steps; i++) {
+		_cosines[i] = cos(_angles[i]);
+		_sines[i] = sin(_angles[i]);
+	}
+}
+
+typedef std::tuple<double, double, int>	anglekey;
+typedef std::map<anglekey, std::unique_ptr<AngleTable> >	anglemap;
+
+static std::mutex	tables_mutex;
+
+/**
+ * \brief Get the table for a range and a number of steps
+ */
+const AngleTable&	AngleTable::get(const Interval& range, int steps) {
+	static anglemap	tables;
+	anglekey	key(range.min(), range.max(), steps);
+	std::unique_lock<std::mutex>	lock(tables_mutex);
+	anglemap::iterator	i = tables.find(key);
+	if (i != tables.end()) {
+		return *i->second;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "new angle table [%f,%f], %d steps",
+		range.min(), range.max(), steps);
+	AngleTable	*table = new AngleTable(range, steps);
+	tables[key] = std::unique_ptr<AngleTable>(table);
+	return *table;
+}
+
+} // namespace csg
@@ -4,6 +4,7 @@
  * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
 #include <Arrow.h>
+#include <AngleTable.h>
 
 namespace csg {
 
@@ -11,96 +12,101 @@ int	Build_Arrow::vertex(int phi, int z) const {
 	return 3 * phi + z + 1;
 }
 
-void	Build_Arrow::operator()(Polyhedron::HalfedgeDS& hds) {
-	Builder	B(hds, true);
-	B.begin_surface(0, 0, 0);
+int	Build_Arrow::expected_vertices() const {
+	return 3 * _steps + 2;
+}
+
+int	Build_Arrow::expected_facets() const {
+	return 6 * _steps;
+}
+
+void	Build_Arrow::build() {
 
 	// initial point
-	add_vertex(B, _from);
+	add_vertex(_from);
 
 	// create the frame
 	vector	t(_from, _to);
 	frame	f(t);
 	point	head = _to - (3 * _radius) * f.v1();
 
-	double	deltaphi = 2 * M_PI / _steps;
+	const AngleTable&	angles = AngleTable::get(Interval2Pi, _steps);
 	for (int phi = 0; phi < _steps; phi++) {
-		double	_phi = phi * deltaphi;
-		vector	o = _radius * (cos(_phi) * f.v3() + sin(_phi) * f.v2());
-		add_vertex(B, _from + o);
-		add_vertex(B, head + o);
-		add_vertex(B, head + (2 * o));
+		vector	o = _radius * (angles.cosine(phi) * f.v3()
+				+ angles.sine(phi) * f.v2());
+		add_vertex(_from + o);
+		add_vertex(head + o);
+		add_vertex(head + (2 * o));
 	}
 
 	// final point
-	add_vertex(B, _to);
+	add_vertex(_to);
 
 	// add triangles
 	for (int phi = 0; phi < _steps - 1; phi++) {
 		// end cap
-		add_facet(B,
+		add_facet(
 			0,
 			vertex(phi, 0),
 			vertex(phi + 1, 0));
 
 		// shaft
-		add_facet(B,
+		add_facet(
 			vertex(phi, 0),
 			vertex(phi, 1),
 			vertex(phi + 1, 0));
-		add_facet(B,
+		add_facet(
 			vertex(phi + 1, 0),
 			vertex(phi, 1),
 			vertex(phi + 1, 1));
 
 		// arrow back side
-		add_facet(B,
+		add_facet(
 			vertex(phi, 1),
 			vertex(phi, 2),
 			vertex(phi + 1, 1));
-		add_facet(B,
+		add_facet(
 			vertex(phi + 1, 1),
 			vertex(phi, 2),
 			vertex(phi + 1, 2));
 
 		// arrow head
-		add_facet(B,
+		add_facet(
 			vertex(phi, 2),
 			vertexnumber() - 1,
 			vertex(phi + 1, 2));
 	}
 
-	add_facet(B,
+	add_facet(
 		0,
 		vertex(_steps - 1, 0),
 		vertex(0, 0));
 
-	add_facet(B,
+	add_facet(
 		vertex(_steps - 1, 0),
 		vertex(_steps - 1, 1),
 		vertex(0, 0));
-	add_facet(B,
+	add_facet(
 		vertex(0, 0),
 		vertex(_steps - 1, 1),
 		vertex(0, 1));
 
 	// arrow back side
-	add_facet(B,
+	add_facet(
 		vertex(_steps - 1, 1),
 		vertex(_steps - 1, 2),
 		vertex(0, 1));
-	add_facet(B,
+	add_facet(
 		vertex(0, 1),
 		vertex(_steps - 1, 2),
 		vertex(0, 2));
 
 	// arrow head
-	add_facet(B,
+	add_facet(
 		vertex(_steps - 1, 2),
 		vertexnumber() - 1,
 		vertex(0, 2));
 
-	B.end_surface();
 }
 
 } // namespace csg
@@ -0,0 +1,434 @@
+/*
+ * Binary.cpp -- compact binary files for polyhedra and Nef polyhedra
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Binary.h>
+#include <BinaryBuffer.h>
+#include <debug.h>
+#include <CGAL/IO/Nef_polyhedron_iostream_3.h>
+#include <cerrno>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <gmp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace csg {
+
+#define BINARY_MAGIC	"CSGB"
+#define BINARY_VERSION	2
+
+typedef enum binary_type_e {
+	POLYHEDRON_TYPE = 'P', NEF_TYPE = 'N'
+} binary_type;
+
+typedef enum nef_record_e {
+	EMPTY_NEF = 0, SIMPLE_NEF = 1, STREAM_NEF = 2
+} nef_record;
+
+typedef enum coordinate_tag_e {
+	DOUBLE_COORDINATE = 0, EXACT_COORDINATE = 1
+} coordinate_tag;
+
+//////////////////////////////////////////////////////////////////////
+// coordinates
+//////////////////////////////////////////////////////////////////////
+
+#ifdef CSG_EXTENDED_KERNEL
+typedef CGAL::Gmpq	exact_number;
+
+static exact_number	exact_value(const Kernel::FT& x) {
+	if (x.degree() > 0) {
+		throw std::runtime_error("cannot write unbounded coordinate");
+	}
+	return x[0];
+}
+#else /* CSG_EXTENDED_KERNEL */
+typedef Kernel::Exact_kernel::FT	exact_number;
+
+static exact_number	exact_value(const Kernel::FT& x) {
+	return CGAL::exact(x);
+}
+#endif /* CSG_EXTENDED_KERNEL */
+
+// access to the GMP rational behind the exact number type
+static mpq_srcptr	rational(const CGAL::Gmpq& q) {
+	return q.mpq();
+}
+
+#ifdef CGAL_USE_GMPXX
+static mpq_srcptr	rational(const mpq_class& q) {
+	return q.get_mpq_t();
+}
+#endif /* CGAL_USE_GMPXX */
+
+/**
+ * \brief Write the absolute value of an integer as little endian bytes
+ */
+static void	write_integer(binarybuffer& b, mpz_srcptr z) {
+	std::string	data((mpz_sizeinbase(z, 2) + 7) / 8, '\0');
+	size_t	count = 0;
+	mpz_export(&data[0], &count, -1, 1, -1, 0, z);
+	data.resize(count);
+	b.string(data);
+}
+
+static void	read_integer(binaryreader& r, mpz_ptr z) {
+	uint32_t	count = r.uint32();
+	if (count > r.remaining()) {
+		throw std::runtime_error("truncated exact coordinate");
+	}
+	mpz_import(z, count, -1, 1, -1, 0, r.bytes(count));
+}
+
+/**
+ * \brief Write an exact rational as sign, numerator and denominator
+ *
+ * Numerator and denominator are exported as GMP does internally, so
+ * no conversion to and from decimal text is needed.
+ */
+static void	write_exact(binarybuffer& b, const exact_number& e) {
+	mpq_srcptr	q = rational(e);
+	b.uint8((mpq_sgn(q) < 0) ? 1 : 0);
+	write_integer(b, mpq_numref(q));
+	write_integer(b, mpq_denref(q));
+}
+
+static exact_number	read_exact(binaryreader& r) {
+	bool	negative = (r.uint8() != 0);
+	mpq_t	q;
+	mpq_init(q);
+	try {
+		read_integer(r, mpq_numref(q));
+		read_integer(r, mpq_denref(q));
+	} catch (...) {
+		mpq_clear(q);
+		throw;
+	}
+	if (mpz_sgn(mpq_denref(q)) == 0) {
+		mpq_clear(q);
+		throw std::runtime_error("bad exact coordinate");
+	}
+	mpq_canonicalize(q);
+	if (negative) {
+		mpq_neg(q, q);
+	}
+	exact_number	e(q);
+	mpq_clear(q);
+	return e;
+}
+
+/**
+ * \brief Write a coordinate, as a double whenever this is exact
+ *
+ * With the lazy kernel, a coordinate whose interval approximation is a
+ * single double is that double, so the exact value is only computed
+ * for coordinates constructed by boolean operations.
+ */
+static void	write_coordinate(binarybuffer& b, const Kernel::FT& x) {
+	double	d = CGAL::to_double(x);
+#ifndef CSG_EXTENDED_KERNEL
+	if ((x.approx().inf() == d) && (x.approx().sup() == d)) {
+		b.uint8(DOUBLE_COORDINATE);
+		b.float64(d);
+		return;
+	}
+#endif /* CSG_EXTENDED_KERNEL */
+	exact_number	e = exact_value(x);
+	if (e == exact_number(d)) {
+		b.uint8(DOUBLE_COORDINATE);
+		b.float64(d);
+		return;
+	}
+	b.uint8(EXACT_COORDINATE);
+	write_exact(b, e);
+}
+
+static Kernel::FT	read_coordinate(binaryreader& r) {
+	switch (r.uint8()) {
+	case DOUBLE_COORDINATE:
+		return Kernel::FT(r.float64());
+	case EXACT_COORDINATE:
+		return Kernel::FT(read_exact(r));
+	}
+	throw std::runtime_error("bad coordinate tag");
+}
+
+//////////////////////////////////////////////////////////////////////
+// polyhedra
+//////////////////////////////////////////////////////////////////////
+
+static void	write_header(binarybuffer& b, binary_type type) {
+	b.bytes(BINARY_MAGIC, 4);
+	b.uint32(BINARY_VERSION);
+	b.uint8(type);
+	b.string(CSG_KERNEL_NAME);
+}
+
+static void	read_header(binaryreader& r, binary_type type) {
+	if (std::string(r.bytes(4), 4) != BINARY_MAGIC) {
+		throw std::runtime_error("not a binary csg file");
+	}
+	if (r.uint32() != BINARY_VERSION) {
+		throw std::runtime_error("unknown binary csg version");
+	}
+	if (r.uint8() != type) {
+		throw std::runtime_error("binary csg file of wrong type");
+	}
+	std::string	kernel = r.string();
+	if ((type == NEF_TYPE) && (kernel != CSG_KERNEL_NAME)) {
+		throw std::runtime_error("Nef polyhedron for kernel " + kernel);
+	}
+}
+
+static void	write_polyhedron_record(binarybuffer& b, const Polyhedron& p) {
+	b.uint32(p.size_of_vertices());
+	b.uint32(p.size_of_facets());
+	std::map<const Polyhedron::Vertex *, uint32_t>	index;
+	Polyhedron::Vertex_const_iterator	v;
+	for (v = p.vertices_begin(); v != p.vertices_end(); v++) {
+		uint32_t	i = index.size();
+		index[&*v] = i;
+		const Point&	q = v->point();
+		write_coordinate(b, q.x());
+		write_coordinate(b, q.y());
+		write_coordinate(b, q.z());
+	}
+	Polyhedron::Facet_const_iterator	f;
+	for (f = p.facets_begin(); f != p.facets_end(); f++) {
+		b.uint32(f->facet_degree());
+		Polyhedron::Halfedge_const_handle	h = f->halfedge();
+		do {
+			b.uint32(index[&*(h->vertex())]);
+			h = h->next();
+		} while (h != f->halfedge());
+	}
+}
+
+/**
+ * \brief Modifier loading a polyhedron record
+ *
+ * The whole record is decoded and checked before the incremental
+ * builder is started, so that errors in the data never leave the
+ * builder in the middle of a surface.
+ */
+class Build_Binary : public CGAL::Modifier_base<Polyhedron::HalfedgeDS> {
+	std::vector<Point>	_points;
+	std::vector<uint32_t>	_facets;
+	uint32_t	_nfacets;
+public:
+	Build_Binary(binaryreader& r);
+	void	operator()(Polyhedron::HalfedgeDS& hds);
+};
+
+Build_Binary::Build_Binary(binaryreader& r) {
+	uint32_t	nvertices = r.uint32();
+	_nfacets = r.uint32();
+	// each vertex takes at least 3 * 9 bytes, each facet 16 bytes,
+	// so corrupt counts are caught before anything is allocated
+	if ((uint64_t)nvertices * 27 + (uint64_t)_nfacets * 16
+		> r.remaining()) {
+		throw std::runtime_error("truncated polyhedron");
+	}
+	_points.reserve(nvertices);
+	for (uint32_t i = 0; i < nvertices; i++) {
+		Kernel::FT	x = read_coordinate(r);
+		Kernel::FT	y = read_coordinate(r);
+		Kernel::FT	z = read_coordinate(r);
+		_points.push_back(Point(x, y, z));
+	}
+	for (uint32_t f = 0; f < _nfacets; f++) {
+		uint32_t	degree = r.uint32();
+		if ((degree < 3) || (degree > nvertices)) {
+			throw std::runtime_error("bad facet degree");
+		}
+		_facets.push_back(degree);
+		for (uint32_t i = 0; i < degree; i++) {
+			uint32_t	v = r.uint32();
+			if (v >= nvertices) {
+				throw std::runtime_error("bad vertex number");
+			}
+			_facets.push_back(v);
+		}
+	}
+}
+
+void	Build_Binary::operator()(Polyhedron::HalfedgeDS& hds) {
+	Builder	B(hds, true);
+	B.begin_surface(_points.size(), _nfacets);
+	for (size_t i = 0; i < _points.size(); i++) {
+		B.add_vertex(_points[i]);
+	}
+	const uint32_t	*f = (_facets.size() > 0) ? &_facets[0] : NULL;
+	for (uint32_t i = 0; i < _nfacets; i++) {
+		uint32_t	degree = *f++;
+		B.add_facet(f, f + degree);
+		f += degree;
+	}
+	B.end_surface();
+	if (B.error()) {
+		throw std::runtime_error("cannot build polyhedron from file");
+	}
+}
+
+static void	read_polyhedron_record(binaryreader& r, Polyhedron& p) {
+	Build_Binary	builder(r);
+	p.clear();
+	p.delegate(builder);
+}
+
+//////////////////////////////////////////////////////////////////////
+// memory mapped files
+//////////////////////////////////////////////////////////////////////
+
+mappedfile::mappedfile(const std::string& filename) {
+	int	fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error("cannot open " + filename);
+	}
+	struct stat	sb;
+	if (fstat(fd, &sb) < 0) {
+		close(fd);
+		throw std::runtime_error("cannot stat " + filename);
+	}
+	_size = sb.st_size;
+	if (_size == 0) {
+		close(fd);
+		throw std::runtime_error(filename + " is empty");
+	}
+	_data = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (_data == MAP_FAILED) {
+		throw std::runtime_error("cannot map " + filename);
+	}
+}
+
+mappedfile::~mappedfile() {
+	munmap(_data, _size);
+}
+
+//////////////////////////////////////////////////////////////////////
+// public interface
+//////////////////////////////////////////////////////////////////////
+
+void	write_binary(std::ostream& out, const Polyhedron& p) {
+	binarybuffer	b(out);
+	write_header(b, POLYHEDRON_TYPE);
+	write_polyhedron_record(b, p);
+}
+
+/**
+ * \brief Write a mesh as a polyhedron with double coordinates
+ */
+void	write_binary(std::ostream& out, const IndexedMesh& mesh) {
+	binarybuffer	b(out);
+	write_header(b, POLYHEDRON_TYPE);
+	b.uint32(mesh.number_of_vertices());
+	b.uint32(mesh.number_of_triangles());
+	for (size_t i = 0; i < mesh.vertices.size(); i++) {
+		b.uint8(DOUBLE_COORDINATE);
+		b.float64(mesh.vertices[i]);
+	}
+	for (int t = 0; t < mesh.number_of_triangles(); t++) {
+		b.uint32(3);
+		b.uint32(mesh.triangles[3 * t]);
+		b.uint32(mesh.triangles[3 * t + 1]);
+		b.uint32(mesh.triangles[3 * t + 2]);
+	}
+}
+
+void	write_binary(std::ostream& out, const Nef_polyhedron& n) {
+	binarybuffer	b(out);
+	write_header(b, NEF_TYPE);
+	if (n.is_empty()) {
+		b.uint8(EMPTY_NEF);
+	} else if (n.is_simple()) {
+		Polyhedron	p;
+		n.convert_to_polyhedron(p);
+		b.uint8(SIMPLE_NEF);
+		write_polyhedron_record(b, p);
+	} else {
+		std::ostringstream	stream;
+		stream << n;
+		std::string	s = stream.str();
+		b.uint8(STREAM_NEF);
+		b.uint64(s.size());
+		b.bytes(s.data(), s.size());
+	}
+}
+
+static void	write_file(const std::string& filename,
+			const std::function<void(std::ostream&)>& writer) {
+	std::ofstream	out(filename.c_str(), std::ios::out | std::ios::binary);
+	if (!out) {
+		throw std::runtime_error("cannot open " + filename);
+	}
+	writer(out);
+	out.close();
+	if (!out) {
+		throw std::runtime_error("cannot write " + filename);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s written", filename.c_str());
+}
+
+void	write_binary(const std::string& filename, const Polyhedron& p) {
+	write_file(filename, [&p](std::ostream& out) { write_binary(out, p); });
+}
+
+void	write_binary(const std::string& filename, const Nef_polyhedron& n) {
+	write_file(filename, [&n](std::ostream& out) { write_binary(out, n); });
+}
+
+void	read_binary(const void *data, size_t size, Polyhedron& p) {
+	binaryreader	r(data, size);
+	read_header(r, POLYHEDRON_TYPE);
+	read_polyhedron_record(r, p);
+}
+
+void	read_binary(const void *data, size_t size, Nef_polyhedron& n) {
+	binaryreader	r(data, size);
+	read_header(r, NEF_TYPE);
+	switch (r.uint8()) {
+	case EMPTY_NEF:
+		n = Nef_polyhedron(Nef_polyhedron::EMPTY);
+		return;
+	case SIMPLE_NEF: {
+		Polyhedron	p;
+		read_polyhedron_record(r, p);
+		n = Nef_polyhedron(p);
+		return;
+		}
+	case STREAM_NEF: {
+		uint64_t	length = r.uint64();
+		if (length > r.remaining()) {
+			throw std::runtime_error("truncated Nef polyhedron");
+		}
+		std::istringstream	in(std::string(r.bytes(length), length));
+		in >> n;
+		if (!in) {
+			throw std::runtime_error("bad Nef polyhedron");
+		}
+		return;
+		}
+	}
+	throw std::runtime_error("bad Nef polyhedron record");
+}
+
+void	read_binary(const std::string& filename, Polyhedron& p) {
+	mappedfile	file(filename);
+	read_binary(file.data(), file.size(), p);
+}
+
+void	read_binary(const std::string& filename, Nef_polyhedron& n) {
+	mappedfile	file(filename);
+	read_binary(file.data(), file.size(), n);
+}
+
+} // namespace csg
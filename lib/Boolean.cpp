@@ -0,0 +1,402 @@
+/*
+ * Boolean.cpp -- boolean operations on closed triangle meshes
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Boolean.h>
+#include <Bounds.h>
+#include <AABBTree.h>
+#include <Union.h>
+#include <debug.h>
+#include <stdexcept>
+#ifndef CSG_EXTENDED_KERNEL
+#include <CGAL/boost/graph/helpers.h>
+#include <CGAL/Polygon_mesh_processing/corefinement.h>
+#include <CGAL/Polygon_mesh_processing/self_intersections.h>
+#include <CGAL/Polygon_mesh_processing/triangulate_faces.h>
+#endif /* CSG_EXTENDED_KERNEL */
+
+namespace csg {
+
+#ifndef CSG_EXTENDED_KERNEL
+namespace PMP = CGAL::Polygon_mesh_processing;
+#endif /* CSG_EXTENDED_KERNEL */
+
+static const char	*opname(Boolean::operation_type op) {
+	switch (op) {
+	case Boolean::JOIN:		return "join";
+	case Boolean::INTERSECTION:	return "intersection";
+	case Boolean::DIFFERENCE:	return "difference";
+	}
+	return "unknown";
+}
+
+/**
+ * \brief Find out whether a polyhedron can be handled by corefinement
+ */
+bool	Boolean::mesh_applicable(const Polyhedron& p) {
+#ifdef CSG_EXTENDED_KERNEL
+	return false;
+#else /* CSG_EXTENDED_KERNEL */
+	if (p.empty()) {
+		return false;
+	}
+	if (!CGAL::is_closed(p)) {
+		return false;
+	}
+	if (!CGAL::is_triangle_mesh(p)) {
+		return false;
+	}
+	if (PMP::does_self_intersect(p)) {
+		return false;
+	}
+	return true;
+#endif /* CSG_EXTENDED_KERNEL */
+}
+
+/**
+ * \brief Convert a Nef polyhedron to a polyhedron
+ *
+ * Returns false if the Nef polyhedron is not simple, convert_to_polyhedron
+ * requires a 2-manifold and would fail for such a Nef polyhedron.
+ */
+static bool	nef_to_polyhedron(const Nef_polyhedron& nef, Polyhedron& result) {
+	if (!nef.is_simple()) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "Nef result is not simple");
+		return false;
+	}
+	nef.convert_to_polyhedron(result);
+#ifndef CSG_EXTENDED_KERNEL
+	// keep the result usable for the mesh engine
+	PMP::triangulate_faces(result);
+#endif /* CSG_EXTENDED_KERNEL */
+	return true;
+}
+
+/**
+ * \brief Compute the operation using Nef polyhedra
+ */
+Nef_polyhedron	Boolean::nef(const Polyhedron& a, const Polyhedron& b,
+			operation_type op) const {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "Nef %s", opname(op));
+	// the Nef_polyhedron constructor needs nonconst polyhedra
+	Polyhedron	acopy(a);
+	Polyhedron	bcopy(b);
+	Nef_polyhedron	na(acopy);
+	Nef_polyhedron	nb(bcopy);
+	Nef_polyhedron	nresult;
+	switch (op) {
+	case JOIN:
+		nresult = na + nb;
+		break;
+	case INTERSECTION:
+		nresult = na * nb;
+		break;
+	case DIFFERENCE:
+		nresult = na - nb;
+		break;
+	}
+	return nresult;
+}
+
+/**
+ * \brief Check an operand for the mesh engine, unless it is known to be ok
+ */
+static bool	applicable(const Polyhedron& p, Boolean::operand_info& info) {
+	if (!info.validated) {
+		info.validated = Boolean::mesh_applicable(p);
+	}
+	return info.validated;
+}
+
+/**
+ * \brief Compute the operation by corefinement
+ *
+ * Returns false if the mesh engine could not produce a valid result.
+ */
+bool	Boolean::mesh(const Polyhedron& a, const Polyhedron& b,
+			operation_type op, Polyhedron& result,
+			operand_info& ainfo, operand_info& binfo) const {
+#ifdef CSG_EXTENDED_KERNEL
+	return false;
+#else /* CSG_EXTENDED_KERNEL */
+	if (!(applicable(a, ainfo) && applicable(b, binfo))) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0,
+			"operands not suitable for mesh %s", opname(op));
+		return false;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "mesh %s", opname(op));
+	// corefinement modifies the operands
+	Polyhedron	acopy(a);
+	Polyhedron	bcopy(b);
+	bool	valid = false;
+	switch (op) {
+	case JOIN:
+		valid = PMP::corefine_and_compute_union(acopy, bcopy, result);
+		break;
+	case INTERSECTION:
+		valid = PMP::corefine_and_compute_intersection(acopy, bcopy,
+			result);
+		break;
+	case DIFFERENCE:
+		valid = PMP::corefine_and_compute_difference(acopy, bcopy,
+			result);
+		break;
+	}
+	if (!valid) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "mesh %s not manifold",
+			opname(op));
+		result.clear();
+	}
+	return valid;
+#endif /* CSG_EXTENDED_KERNEL */
+}
+
+/**
+ * \brief Find out whether the solids of two polyhedra are apart
+ *
+ * This is certainly the case if the bounding boxes are disjoint. If
+ * they overlap, the surfaces are compared using bounding box trees. As
+ * this is done in double precision, surfaces closer than a millionth
+ * of the size of the boxes are considered to touch.
+ */
+bool	Boolean::apart(const Polyhedron& a, const Polyhedron& b) {
+	operand_info	ainfo, binfo;
+	return apart(a, b, ainfo, binfo);
+}
+
+/**
+ * \brief Find out whether two operands are apart, keeping boxes and trees
+ */
+bool	Boolean::apart(const Polyhedron& a, const Polyhedron& b,
+		operand_info& ainfo, operand_info& binfo) {
+	operand_info	*infos[2] = { &ainfo, &binfo };
+	const Polyhedron	*polyhedra[2] = { &a, &b };
+	for (int i = 0; i < 2; i++) {
+		if (!infos[i]->boxed) {
+			infos[i]->box = bounding_box(*polyhedra[i]);
+			infos[i]->boxed = true;
+		}
+	}
+	if (!ainfo.box.overlaps(binfo.box)) {
+		return true;
+	}
+	bounds	total(ainfo.box);
+	total.add(binfo.box);
+	double	margin = 1e-6 * total.extent().norm();
+	for (int i = 0; i < 2; i++) {
+		if (!infos[i]->tree) {
+			infos[i]->tree = std::make_shared<AABBTree>(*polyhedra[i]);
+		}
+	}
+	return ainfo.tree->separated(*binfo.tree, margin);
+}
+
+/**
+ * \brief Compute a boolean operation with the selected engine
+ *
+ * Returns true if the result is a polyhedron, it is then returned in
+ * result. If the operation had to be computed by the Nef engine and the
+ * result is not simple, false is returned and the result is left in
+ * nefresult.
+ */
+bool	Boolean::compute(const Polyhedron& a, const Polyhedron& b,
+		operation_type op, Polyhedron& result,
+		Nef_polyhedron& nefresult) const {
+	operand_info	ainfo, binfo, resultinfo;
+	return compute(a, b, op, result, nefresult, ainfo, binfo, resultinfo);
+}
+
+/**
+ * \brief Compute a boolean operation, using and updating operand info
+ *
+ * The info of the operands is updated with what was found out about
+ * them. The result info is marked validated if the result is known to
+ * be suitable for the mesh engine: results of corefinement and of
+ * conversion from Nef polyhedra are, results of operands that are apart
+ * are if the operands they consist of are.
+ */
+bool	Boolean::compute(const Polyhedron& a, const Polyhedron& b,
+		operation_type op, Polyhedron& result,
+		Nef_polyhedron& nefresult, operand_info& ainfo,
+		operand_info& binfo, operand_info& resultinfo) const {
+	resultinfo = operand_info();
+	// operands that are apart need no overlay at all
+	if (apart(a, b, ainfo, binfo)) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "disjoint %s", opname(op));
+		switch (op) {
+		case JOIN:
+			result = concatenate(a, b);
+			resultinfo.validated = ainfo.validated && binfo.validated;
+			break;
+		case INTERSECTION:
+			result = Polyhedron();
+			break;
+		case DIFFERENCE:
+			result = a;
+			resultinfo = ainfo;
+			break;
+		}
+		return true;
+	}
+	if (_engine == MESH_ENGINE) {
+		if (mesh(a, b, op, result, ainfo, binfo)) {
+			resultinfo.validated = !result.empty();
+			return true;
+		}
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "falling back to Nef engine");
+	}
+	nefresult = nef(a, b, op);
+	if (!nef_to_polyhedron(nefresult, result)) {
+		return false;
+	}
+#ifndef CSG_EXTENDED_KERNEL
+	resultinfo.validated = !result.empty();
+#endif /* CSG_EXTENDED_KERNEL */
+	return true;
+}
+
+/**
+ * \brief Compute a boolean operation, the result as a Nef polyhedron
+ *
+ * Unlike the operator, this also works if the result is not simple.
+ */
+Nef_polyhedron	Boolean::evaluate(const Polyhedron& a, const Polyhedron& b,
+			operation_type op) const {
+	Polyhedron	result;
+	Nef_polyhedron	nefresult;
+	if (compute(a, b, op, result, nefresult)) {
+		return Nef_polyhedron(result);
+	}
+	return nefresult;
+}
+
+/**
+ * \brief Compute a boolean operation, the result as a polyhedron
+ *
+ * Throws std::runtime_error if the result is not simple and thus cannot
+ * be represented as a polyhedron, use evaluate() in this case.
+ */
+Polyhedron	Boolean::operator()(const Polyhedron& a, const Polyhedron& b,
+			operation_type op) const {
+	Polyhedron	result;
+	Nef_polyhedron	nefresult;
+	if (!compute(a, b, op, result, nefresult)) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s result not simple", opname(op));
+		throw std::runtime_error("boolean result is not a simple polyhedron");
+	}
+	return result;
+}
+
+Polyhedron	Boolean::join(const Polyhedron& a, const Polyhedron& b) const {
+	return (*this)(a, b, JOIN);
+}
+
+Polyhedron	Boolean::intersection(const Polyhedron& a,
+			const Polyhedron& b) const {
+	return (*this)(a, b, INTERSECTION);
+}
+
+Polyhedron	Boolean::difference(const Polyhedron& a,
+			const Polyhedron& b) const {
+	return (*this)(a, b, DIFFERENCE);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Mesh_nary_union implementation
+//////////////////////////////////////////////////////////////////////
+
+Nef_polyhedron	Mesh_nary_union::operand::to_nef() const {
+	if (isnef) {
+		return nef;
+	}
+	// the Nef_polyhedron constructor needs a nonconst polyhedron
+	Polyhedron	copy(polyhedron);
+	return Nef_polyhedron(copy);
+}
+
+/**
+ * \brief Merge the last two operands in the queue
+ *
+ * As long as both operands are polyhedra, the merge is done by the boolean
+ * engine, otherwise with Nef polyhedra. A Nef union that is simple again
+ * is converted back, so that later merges can use the mesh engine.
+ */
+void	Mesh_nary_union::unite() {
+	operand	b = queue.back();
+	queue.pop_back();
+	operand	a = queue.back();
+	queue.pop_back();
+	operand	r;
+	if (a.isnef || b.isnef) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "Nef union of partial unions");
+		r.nef = a.to_nef() + b.to_nef();
+		r.isnef = !nef_to_polyhedron(r.nef, r.polyhedron);
+	} else {
+		r.isnef = !_boolean.compute(a.polyhedron, b.polyhedron,
+			Boolean::JOIN, r.polyhedron, r.nef, a.info, b.info,
+			r.info);
+	}
+	if (!r.isnef) {
+		r.nef = Nef_polyhedron();
+	}
+	queue.push_back(r);
+}
+
+/**
+ * \brief Add a polyhedron to the union
+ *
+ * Like Nef_nary_union_3, the queue works like a binary counter: after
+ * adding the n-th polyhedron, one merge is performed for every trailing
+ * zero bit of n.
+ */
+void	Mesh_nary_union::add_polyhedron(const Polyhedron& p) {
+	operand	o;
+	o.polyhedron = p;
+	queue.push_back(o);
+	_count++;
+	for (size_t count = _count; (count & 1) == 0; count >>= 1) {
+		unite();
+	}
+}
+
+/**
+ * \brief Retrieve the union
+ *
+ * Returns true if the union is a polyhedron, it is then returned in
+ * result. Otherwise the union is not simple and is returned in nefresult.
+ */
+bool	Mesh_nary_union::get_union(Polyhedron& result,
+		Nef_polyhedron& nefresult) {
+	if (queue.empty()) {
+		result = Polyhedron();
+		return true;
+	}
+	while (queue.size() > 1) {
+		unite();
+	}
+	_count = 1;
+	if (queue.front().isnef) {
+		nefresult = queue.front().nef;
+		return false;
+	}
+	result = queue.front().polyhedron;
+	return true;
+}
+
+/**
+ * \brief Retrieve the union as a polyhedron
+ *
+ * Throws std::runtime_error if the union is not simple.
+ */
+Polyhedron	Mesh_nary_union::get_union() {
+	Polyhedron	result;
+	Nef_polyhedron	nefresult;
+	if (!get_union(result, nefresult)) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "union not simple");
+		throw std::runtime_error("union is not a simple polyhedron");
+	}
+	return result;
+}
+
+} // namespace csg
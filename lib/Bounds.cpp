@@ -0,0 +1,217 @@
+/*
+ * Bounds.cpp -- axis aligned bounding boxes
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Bounds.h>
+#include <math.h>
+#include <algorithm>
+#ifdef CSG_EXTENDED_KERNEL
+#include <CGAL/Nef_3/Infimaximal_box.h>
+#endif /* CSG_EXTENDED_KERNEL */
+
+namespace csg {
+
+bounds::bounds(const point& a, const point& b) : _min(a), _max(a),
+	_empty(false) {
+	add(b);
+}
+
+void	bounds::add(const point& p) {
+	if (_empty) {
+		_min = p;
+		_max = p;
+		_empty = false;
+		return;
+	}
+	_min = point(fmin(_min.x(), p.x()), fmin(_min.y(), p.y()),
+		fmin(_min.z(), p.z()));
+	_max = point(fmax(_max.x(), p.x()), fmax(_max.y(), p.y()),
+		fmax(_max.z(), p.z()));
+}
+
+void	bounds::add(const bounds& other) {
+	if (other.empty()) {
+		return;
+	}
+	add(other.min());
+	add(other.max());
+}
+
+point	bounds::center() const {
+	return _min + 0.5 * vector(_min, _max);
+}
+
+vector	bounds::extent() const {
+	if (_empty) {
+		return vector();
+	}
+	return vector(_min, _max);
+}
+
+/**
+ * \brief Find out whether two boxes have a point in common
+ */
+bool	bounds::overlaps(const bounds& other) const {
+	if (_empty || other.empty()) {
+		return false;
+	}
+	if ((_max.x() < other.min().x()) || (other.max().x() < _min.x())) {
+		return false;
+	}
+	if ((_max.y() < other.min().y()) || (other.max().y() < _min.y())) {
+		return false;
+	}
+	if ((_max.z() < other.min().z()) || (other.max().z() < _min.z())) {
+		return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Find out whether a box lies in the interior of this box
+ *
+ * Since rounding to double is monotone, a box of rounded coordinates
+ * strictly inside a box with double coordinates proves that the exact
+ * coordinates are inside too. The same holds for disjoint boxes.
+ */
+bool	bounds::contains(const bounds& other) const {
+	if (_empty || other.empty()) {
+		return false;
+	}
+	return (_min.x() < other.min().x()) && (other.max().x() < _max.x())
+		&& (_min.y() < other.min().y()) && (other.max().y() < _max.y())
+		&& (_min.z() < other.min().z()) && (other.max().z() < _max.z());
+}
+
+/**
+ * \brief Common part of two boxes, empty if they do not overlap
+ */
+bounds	bounds::intersection(const bounds& other) const {
+	if (!overlaps(other)) {
+		return bounds();
+	}
+	return bounds(point(fmax(_min.x(), other.min().x()),
+			fmax(_min.y(), other.min().y()),
+			fmax(_min.z(), other.min().z())),
+		point(fmin(_max.x(), other.max().x()),
+			fmin(_max.y(), other.max().y()),
+			fmin(_max.z(), other.max().z())));
+}
+
+/**
+ * \brief Euclidean distance between two boxes, 0 if they overlap
+ */
+double	bounds::distance(const bounds& other) const {
+	double	dx = fmax(0, fmax(other.min().x() - _max.x(),
+				_min.x() - other.max().x()));
+	double	dy = fmax(0, fmax(other.min().y() - _max.y(),
+				_min.y() - other.max().y()));
+	double	dz = fmax(0, fmax(other.min().z() - _max.z(),
+				_min.z() - other.max().z()));
+	return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static point	topoint(const Point& p) {
+	return point(CGAL::to_double(p.x()), CGAL::to_double(p.y()),
+		CGAL::to_double(p.z()));
+}
+
+bounds	bounding_box(const Polyhedron& p) {
+	bounds	result;
+	Polyhedron::Vertex_const_iterator	v;
+	for (v = p.vertices_begin(); v != p.vertices_end(); v++) {
+		result.add(topoint(v->point()));
+	}
+	return result;
+}
+
+/**
+ * \brief Bounding box of the finite vertices of a Nef polyhedron
+ *
+ * With the extended kernel, the vertices of the infimaximal box are
+ * ignored.
+ */
+bounds	bounding_box(const Nef_polyhedron& n) {
+	bounds	result;
+	Nef_polyhedron::Vertex_const_iterator	v;
+	for (v = n.vertices_begin(); v != n.vertices_end(); v++) {
+#ifdef CSG_EXTENDED_KERNEL
+		typedef CGAL::Infimaximal_box<CGAL::Tag_true, Kernel>	Infi_box;
+		if (!Infi_box::is_standard(v->point())) {
+			continue;
+		}
+		Infi_box::Standard_point	s
+			= Infi_box::standard_point(v->point());
+		result.add(point(CGAL::to_double(s.x()),
+			CGAL::to_double(s.y()), CGAL::to_double(s.z())));
+#else /* CSG_EXTENDED_KERNEL */
+		result.add(topoint(v->point()));
+#endif /* CSG_EXTENDED_KERNEL */
+	}
+	return result;
+}
+
+/**
+ * \brief Find out whether the solid of a Nef polyhedron is unbounded
+ *
+ * This is the case if the outer volume belongs to the solid, or, with the
+ * extended kernel, if any vertex lies on the infimaximal box. The
+ * bounding box of an unbounded Nef polyhedron says nothing about where
+ * the solid is.
+ */
+bool	unbounded(const Nef_polyhedron& n) {
+	if ((n.volumes_begin() != n.volumes_end())
+		&& n.volumes_begin()->mark()) {
+		return true;
+	}
+#ifdef CSG_EXTENDED_KERNEL
+	typedef CGAL::Infimaximal_box<CGAL::Tag_true, Kernel>	Infi_box;
+	Nef_polyhedron::Vertex_const_iterator	v;
+	for (v = n.vertices_begin(); v != n.vertices_end(); v++) {
+		if (!Infi_box::is_standard(v->point())) {
+			return true;
+		}
+	}
+#endif /* CSG_EXTENDED_KERNEL */
+	return false;
+}
+
+/**
+ * \brief Range of grid cells of a sheet that may meet a box
+ *
+ * vertices contains the top and bottom vertex of each of the
+ * (usteps + 1) x (vsteps + 1) grid points, row by row, six coordinates
+ * per grid point, as the Cartesian and polar builders compute them. A
+ * cell may meet the box if the bounding box of its eight vertices
+ * overlaps it. window receives the smallest range u0 <= u < u1,
+ * v0 <= v < v1 of cells containing all such cells. Returns false if no
+ * cell may meet the box.
+ */
+bool	grid_window(const double *vertices, int usteps, int vsteps,
+		const bounds& box, int window[4]) {
+	window[0] = usteps; window[1] = 0;
+	window[2] = vsteps; window[3] = 0;
+	int	n = vsteps + 1;
+	for (int u = 0; u < usteps; u++) {
+		for (int v = 0; v < vsteps; v++) {
+			bounds	cell;
+			for (int corner = 0; corner < 4; corner++) {
+				const double	*c = vertices + 6 * ((u + (corner & 1)) * n
+							+ v + (corner >> 1));
+				cell.add(point(c[0], c[1], c[2]));
+				cell.add(point(c[3], c[4], c[5]));
+			}
+			if (!cell.overlaps(box)) {
+				continue;
+			}
+			window[0] = std::min(window[0], u);
+			window[1] = std::max(window[1], u + 1);
+			window[2] = std::min(window[2], v);
+			window[3] = std::max(window[3], v + 1);
+		}
+	}
+	return window[0] < window[1];
+}
+
+} // namespace csg
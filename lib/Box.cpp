@@ -4,6 +4,7 @@
  * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
 #include <Box.h>
+#include <stdexcept>
 
 namespace csg {
 
@@ -32,30 +33,84 @@ void	Build_Box::standardize() {
 	_b = point(bx, by, bz);
 }
 
-void	Build_Box::operator()(Polyhedron::HalfedgeDS& hds) {
-	Builder	B(hds, true);
-	B.begin_surface(0, 0, 0);
-	add_vertex(B, _a.x(), _a.y(), _a.z());
-	add_vertex(B, _b.x(), _a.y(), _a.z());
-	add_vertex(B, _a.x(), _b.y(), _a.z());
-	add_vertex(B, _a.x(), _a.y(), _b.z());
-	add_vertex(B, _a.x(), _b.y(), _b.z());
-	add_vertex(B, _b.x(), _a.y(), _b.z());
-	add_vertex(B, _b.x(), _b.y(), _a.z());
-	add_vertex(B, _b.x(), _b.y(), _b.z());
-	add_facet(B, 0, 1, 3); // front
-	add_facet(B, 1, 5, 3);
-	add_facet(B, 2, 4, 6); // back
-	add_facet(B, 4, 7, 6);
-	add_facet(B, 1, 6, 5); // right
-	add_facet(B, 6, 7, 5);
-	add_facet(B, 0, 3, 2); // left
-	add_facet(B, 3, 4, 2);
-	add_facet(B, 0, 2, 1); // bottom
-	add_facet(B, 2, 6, 1);
-	add_facet(B, 3, 5, 4); // top
-	add_facet(B, 4, 5, 7);
-	B.end_surface();
+void	Build_Box::build() {
+	add_vertex(_a.x(), _a.y(), _a.z());
+	add_vertex(_b.x(), _a.y(), _a.z());
+	add_vertex(_a.x(), _b.y(), _a.z());
+	add_vertex(_a.x(), _a.y(), _b.z());
+	add_vertex(_a.x(), _b.y(), _b.z());
+	add_vertex(_b.x(), _a.y(), _b.z());
+	add_vertex(_b.x(), _b.y(), _a.z());
+	add_vertex(_b.x(), _b.y(), _b.z());
+	add_facet(0, 1, 3); // front
+	add_facet(1, 5, 3);
+	add_facet(2, 4, 6); // back
+	add_facet(4, 7, 6);
+	add_facet(1, 6, 5); // right
+	add_facet(6, 7, 5);
+	add_facet(0, 3, 2); // left
+	add_facet(3, 4, 2);
+	add_facet(0, 2, 1); // bottom
+	add_facet(2, 6, 1);
+	add_facet(3, 5, 4); // top
+	add_facet(4, 5, 7);
+}
+
+/**
+ * \brief Build the half space box
+ *
+ * The vertices are numbered as in Build_Box, with the box spanned by
+ * the right handed frame (n, v2, v3) of the plane normal, so the same
+ * facets can be used.
+ */
+void	Build_HalfSpace::build() {
+	double	n2 = _n * _n;
+	if (n2 == 0) {
+		throw std::runtime_error("half space normal vector is 0");
+	}
+	frame	f(_n);
+	point	p0 = point(0, 0, 0) + (-_d / n2) * _n;
+	vector	e1 = (2 * _extent) * f.v1();
+	vector	e2 = (2 * _extent) * f.v2();
+	vector	e3 = (2 * _extent) * f.v3();
+	point	o = p0 - e1 - (0.5 * e2) - (0.5 * e3);
+	add_vertex(o);
+	add_vertex(o + e1);
+	add_vertex(o + e2);
+	add_vertex(o + e3);
+	add_vertex(o + e2 + e3);
+	add_vertex(o + e1 + e3);
+	add_vertex(o + e1 + e2);
+	add_vertex(o + e1 + e2 + e3);
+	add_facet(0, 1, 3);
+	add_facet(1, 5, 3);
+	add_facet(2, 4, 6);
+	add_facet(4, 7, 6);
+	add_facet(1, 6, 5);
+	add_facet(6, 7, 5);
+	add_facet(0, 3, 2);
+	add_facet(3, 4, 2);
+	add_facet(0, 2, 1);
+	add_facet(2, 6, 1);
+	add_facet(3, 5, 4);
+	add_facet(4, 5, 7);
+}
+
+/**
+ * \brief Construct the half space a x + b y + c z + d <= 0
+ *
+ * With the extended kernel this is the true half space, otherwise it
+ * is a large box bounded by the plane.
+ */
+Nef_polyhedron	halfspace(double a, double b, double c, double d) {
+#ifdef CSG_EXTENDED_KERNEL
+	return Nef_polyhedron(Plane(a, b, c, d), Nef_polyhedron::INCLUDED);
+#else /* CSG_EXTENDED_KERNEL */
+	Build_HalfSpace	h(a, b, c, d);
+	Polyhedron	p;
+	p.delegate(h);
+	return Nef_polyhedron(p);
+#endif /* CSG_EXTENDED_KERNEL */
 }
 
 } // namespace csg
@@ -5,6 +5,9 @@
  */
 #include <Cartesian.h>
 #include <debug.h>
+#include <GridKernels.h>
+#include <algorithm>
+#include <vector>
 
 namespace csg {
 
@@ -12,17 +15,146 @@ int	Build_Cartesian::vertex(const int x, const int y) const {
 	return 2 * (x * (_ysteps + 1) + y);
 }
 
-void	Build_Cartesian::operator()(Polyhedron::HalfedgeDS& hds) {
-	Builder	B(hds, true);
-	B.begin_surface(0, 0, 0);
+/**
+ * \brief Number of vertices
+ *
+ * The size of an adaptive mesh is only known once it has been built.
+ */
+int	Build_Cartesian::expected_vertices() const {
+	if (_outside) {
+		return 0;
+	}
+	if (_tolerance > 0) {
+		return (_grid) ? 2 * _grid->number_of_nodes() : 0;
+	}
+	return 2 * (_xsteps + 1) * (_ysteps + 1);
+}
+
+int	Build_Cartesian::expected_facets() const {
+	if (_outside) {
+		return 0;
+	}
+	if (_tolerance > 0) {
+		return (_grid) ? 2 * (_grid->number_of_triangles()
+				+ _grid->number_of_boundary_edges()) : 0;
+	}
+	return 4 * (_xsteps * _ysteps + _xsteps + _ysteps);
+}
+
+/**
+ * \brief Compute top and bottom vertices of a grid row
+ *
+ * Writes the coordinates of the top and bottom vertex of each of the n
+ * grid points to vertices. The default implementation evaluates p for
+ * every vertex, derived classes override this to evaluate their function
+ * only once per grid point.
+ */
+void	Build_Cartesian::row(double x, const double *y, int n, double h,
+		double *vertices) {
+	for (int i = 0; i < n; i++) {
+		point	top = p(x, y[i], h/2);
+		point	bottom = p(x, y[i], -h/2);
+		double	*v = vertices + 6 * i;
+		v[0] = top.x(); v[1] = top.y(); v[2] = top.z();
+		v[3] = bottom.x(); v[4] = bottom.y(); v[5] = bottom.z();
+	}
+}
+
+/**
+ * \brief Restrict the domain to the grid cells that may meet the clip box
+ *
+ * The sheet is sampled once on the full grid, then the domain and the
+ * steps are replaced by the window of cells found by grid_window(). The
+ * trimmed domain consists of cells of the full grid, so the sheet built
+ * on it coincides with the full sheet inside the box. The samples are
+ * kept, so that build() can take the vertices of the window from them.
+ */
+void	Build_Cartesian::trim() {
+	_domain = _fulldomain;
+	_xsteps = _fullxsteps;
+	_ysteps = _fullysteps;
+	_outside = false;
+	_samples.clear();
+	if (_clip.empty()) {
+		return;
+	}
 	double	deltax = _domain.xrange().length() / _xsteps;
 	double	deltay = _domain.yrange().length() / _ysteps;
+	int	n = _ysteps + 1;
+	std::vector<double>	ys(n);
+	grid_coordinates(_domain.yrange().min(), deltay, n, &ys[0]);
+	std::vector<double>	vertices(6 * n * (_xsteps + 1));
 	for (int x = 0; x <= _xsteps; x++) {
-		double	_x = _domain.xrange().min() + x * deltax;
-		for (int y = 0; y <= _ysteps; y++) {
-			double	_y = _domain.yrange().min() + y * deltay;
-			add_vertex(B, p(_x, _y, _h/2));
-			add_vertex(B, p(_x, _y, -_h/2));
+		row(_domain.xrange().min() + x * deltax, &ys[0], n, _h,
+			&vertices[6 * n * x]);
+	}
+	int	*window = _window;
+	if (!grid_window(&vertices[0], _xsteps, _ysteps, _clip, window)) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "surface outside clip box");
+		_outside = true;
+		return;
+	}
+	_domain = CartesianDomain(
+		_fulldomain.xrange().subinterval(_xsteps, window[0], window[1]),
+		_fulldomain.yrange().subinterval(_ysteps, window[2], window[3]));
+	_xsteps = window[1] - window[0];
+	_ysteps = window[3] - window[2];
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "clipped to %d x %d of %d x %d cells",
+		_xsteps, _ysteps, _fullxsteps, _fullysteps);
+	if (_tolerance <= 0) {
+		_samples.swap(vertices);
+	}
+}
+
+/**
+ * \brief Trim the domain, so that the expected counts are known
+ */
+void	Build_Cartesian::prepare() {
+	trim();
+}
+
+/**
+ * \brief Build the surface on an adaptively refined grid
+ */
+void	Build_Cartesian::build_adaptive() {
+	_grid.reset(new AdaptiveGrid(_domain.xrange(), _domain.yrange(),
+		_xsteps, _ysteps, _tolerance));
+	_grid->build([this](double x, double y) { return p(x, y, 0); });
+	std::vector<point>	top, bottom;
+	for (int k = 0; k < _grid->number_of_nodes(); k++) {
+		top.push_back(p(_grid->u[k], _grid->v[k], _h/2));
+		bottom.push_back(p(_grid->u[k], _grid->v[k], -_h/2));
+	}
+	add_sheet(top, bottom, _grid->triangles, _grid->boundary);
+}
+
+void	Build_Cartesian::build() {
+	if (_outside) {
+		return;
+	}
+	if (_tolerance > 0) {
+		build_adaptive();
+		return;
+	}
+	double	deltax = _domain.xrange().length() / _xsteps;
+	double	deltay = _domain.yrange().length() / _ysteps;
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s grid kernels", grid_kernel_isa());
+	int	n = _ysteps + 1;
+	if (_samples.size() > 0) {
+		// rows of the window, from the samples taken by trim()
+		int	fulln = _fullysteps + 1;
+		for (int x = 0; x <= _xsteps; x++) {
+			const double	*r = &_samples[6 * (fulln
+						* (_window[0] + x) + _window[2])];
+			std::copy(r, r + 6 * n, append_vertices(2 * n));
+		}
+		std::vector<double>().swap(_samples);
+	} else {
+		std::vector<double>	ys(n);
+		grid_coordinates(_domain.yrange().min(), deltay, n, &ys[0]);
+		for (int x = 0; x <= _xsteps; x++) {
+			double	_x = _domain.xrange().min() + x * deltax;
+			row(_x, &ys[0], n, _h, append_vertices(2 * n));
 		}
 	}
 	for (int x = 0; x < _xsteps; x++) {
@@ -30,78 +162,97 @@ void	Build_Cartesian::operator()(Polyhedron::HalfedgeDS& hds) {
 			debug(LOG_DEBUG, DEBUG_LOG, 0, "x = %d", x);
 		}
 		for (int y = 0; y < _ysteps; y++) {
-			add_facet(B, 
+			add_facet(
 				vertex(x,     y    )    ,
 				vertex(x + 1, y    )    ,
 				vertex(x,     y + 1)    );
 
-			add_facet(B,
+			add_facet(
 				vertex(x,     y    ) + 1,
 				vertex(x,     y + 1) + 1,
 				vertex(x + 1, y    ) + 1);
 			
-			add_facet(B,
+			add_facet(
 				vertex(x,     y + 1)    ,
 				vertex(x + 1, y    )    ,
 				vertex(x + 1, y + 1)    );
 			
-			add_facet(B,
+			add_facet(
 				vertex(x,     y + 1) + 1,
 				vertex(x + 1, y + 1) + 1,
 				vertex(x + 1, y    ) + 1);
 		}
 	}
 	for (int x = 0; x < _xsteps; x++) {
-		add_facet(B,
+		add_facet(
 			vertex(x    , 0)    ,
 			vertex(x    , 0) + 1,
 			vertex(x + 1, 0)    );
 
-		add_facet(B,
+		add_facet(
 			vertex(x + 1, 0)    ,
 			vertex(x    , 0) + 1,
 			vertex(x + 1, 0) + 1);
 
-		add_facet(B,
+		add_facet(
 			vertex(x    , _ysteps),
 			vertex(x + 1, _ysteps),
 			vertex(x    , _ysteps) + 1);
 
-		add_facet(B,
+		add_facet(
 			vertex(x + 1, _ysteps),
 			vertex(x + 1, _ysteps) + 1,
 			vertex(x    , _ysteps) + 1);
 	}
 	for (int y = 0; y < _ysteps; y++) {
-		add_facet(B,
+		add_facet(
 			vertex(0, y    )    ,
 			vertex(0, y + 1)    ,
 			vertex(0, y    ) + 1);
 
-		add_facet(B,
+		add_facet(
 			vertex(0, y + 1)    ,
 			vertex(0, y + 1) + 1,
 			vertex(0, y    ) + 1);
 
-		add_facet(B,
+		add_facet(
 			vertex(_xsteps, y    )    ,
 			vertex(_xsteps, y    ) + 1,
 			vertex(_xsteps, y + 1)    );
 
-		add_facet(B,
+		add_facet(
 			vertex(_xsteps, y    ) + 1,
 			vertex(_xsteps, y + 1) + 1,
 			vertex(_xsteps, y + 1)    );
 	}
-	B.end_surface();
 }
 
 point	Build_CartesianFunction::p(double x, double y, double h) {
 	return point(x, y, _f(x, y) + h/2);
 }
 
+/**
+ * \brief Evaluate the function once per grid point, same offsets as p
+ */
+void	Build_CartesianFunction::row(double x, const double *y, int n,
+		double h, double *vertices) {
+	std::vector<double>	z(n);
+	_f.evaluate(x, y, n, &z[0]);
+	cartesian_vertices(x, y, &z[0], n, h/4, vertices);
+}
+
 point	Build_CartesianPointFunction::p(double x, double y, double h) {
 	return _f.p(x, y) + _f.v(x, y) * (h/2);
 }
 
+/**
+ * \brief Evaluate point and normal once per grid point, same offsets as p
+ */
+void	Build_CartesianPointFunction::row(double x, const double *y, int n,
+		double h, double *vertices) {
+	std::vector<double>	points(3 * n), normals(3 * n);
+	_f.evaluate(x, y, n, &points[0], &normals[0]);
+	offset_vertices(&points[0], &normals[0], n, h/4, vertices);
+}
+
 } // namespace csg
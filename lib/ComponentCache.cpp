@@ -0,0 +1,153 @@
+/*
+ * ComponentCache.cpp -- keep Nef polyhedra of model components on disk
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <ComponentCache.h>
+#include <Binary.h>
+#include <BinaryBuffer.h>
+#include <debug.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace csg {
+
+#define CACHE_MAGIC	"csg-component-cache 2"
+
+ComponentCache::ComponentCache(const std::string& directory)
+	: _directory(directory) {
+	if ((mkdir(_directory.c_str(), 0777) < 0) && (errno != EEXIST)) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "cannot create cache %s: %s",
+			_directory.c_str(), strerror(errno));
+	}
+}
+
+/**
+ * \brief Hash of a description and the kernel as 16 hex digits
+ *
+ * 64 bit FNV-1a, which unlike std::hash is the same on all platforms.
+ */
+std::string	ComponentCache::key(const std::string& description) {
+	std::string	s = std::string(CSG_KERNEL_NAME) + "\n" + description;
+	unsigned long long	hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < s.size(); i++) {
+		hash ^= (unsigned char)s[i];
+		hash *= 1099511628211ULL;
+	}
+	char	buffer[17];
+	snprintf(buffer, sizeof(buffer), "%016llx", hash);
+	return std::string(buffer);
+}
+
+std::string	ComponentCache::filename(const std::string& description) const {
+	return _directory + "/" + key(description) + ".csgc";
+}
+
+/**
+ * \brief Load a component from the cache
+ *
+ * Returns false if the component is not in the cache, if the file
+ * belongs to a different description or kernel, or if it cannot be read,
+ * the component is then built again. All lengths in the file are checked
+ * against the size of the file.
+ */
+bool	ComponentCache::load(const std::string& description,
+		Nef_polyhedron& n) const {
+	std::string	name = filename(description);
+	if (access(name.c_str(), R_OK) < 0) {
+		return false;
+	}
+	try {
+		mappedfile	file(name);
+		binaryreader	r(file.data(), file.size());
+		std::string	magic = r.string();
+		std::string	kernel = r.string();
+		std::string	stored = r.string();
+		if ((magic != CACHE_MAGIC) || (kernel != CSG_KERNEL_NAME)
+			|| (stored != description)) {
+			debug(LOG_DEBUG, DEBUG_LOG, 0, "%s does not match",
+				name.c_str());
+			return false;
+		}
+		size_t	offset = file.size() - r.remaining();
+		read_binary((const char *)file.data() + offset, r.remaining(),
+			n);
+	} catch (const std::exception& x) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "cannot read %s: %s", name.c_str(),
+			x.what());
+		return false;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "component loaded from %s",
+		name.c_str());
+	return true;
+}
+
+static std::atomic<int>	tmpcounter(0);
+
+/**
+ * \brief Store a component in the cache
+ *
+ * The file contains the magic, the kernel and the description, followed
+ * by the Nef polyhedron in the binary format. Failures are only
+ * reported, a component that cannot be stored is built again by the next
+ * run.
+ */
+void	ComponentCache::store(const std::string& description,
+		const Nef_polyhedron& n) const {
+	std::string	name = filename(description);
+	std::string	tmpname = name + "." + std::to_string(getpid()) + "."
+				+ std::to_string(tmpcounter++);
+	try {
+		std::ofstream	out(tmpname.c_str(),
+					std::ios::out | std::ios::binary);
+		{
+			binarybuffer	b(out);
+			b.string(CACHE_MAGIC);
+			b.string(CSG_KERNEL_NAME);
+			b.string(description);
+		}
+		write_binary(out, n);
+		out.close();
+		if (!out) {
+			throw std::runtime_error("write failed");
+		}
+	} catch (const std::exception& x) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "cannot write %s: %s",
+			tmpname.c_str(), x.what());
+		unlink(tmpname.c_str());
+		return;
+	}
+	if (rename(tmpname.c_str(), name.c_str()) < 0) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "cannot rename %s: %s",
+			tmpname.c_str(), strerror(errno));
+		unlink(tmpname.c_str());
+		return;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "component stored in %s", name.c_str());
+}
+
+/**
+ * \brief Get a component from the cache or build and store it
+ */
+Nef_polyhedron	ComponentCache::get(const std::string& description,
+			const builder_type& builder) const {
+	if (!enabled()) {
+		return builder();
+	}
+	Nef_polyhedron	n;
+	if (load(description, n)) {
+		return n;
+	}
+	n = builder();
+	store(description, n);
+	return n;
+}
+
+} // namespace csg
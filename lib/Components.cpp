@@ -0,0 +1,117 @@
+/*
+ * Components.cpp -- build independent model components in parallel
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Components.h>
+#include <debug.h>
+
+namespace csg {
+
+/**
+ * \brief Use a cache for the components
+ *
+ * The parameters must contain all parameters of the model the
+ * components depend on.
+ */
+void	Components::cache(const ComponentCache& cache,
+		const std::string& parameters) {
+	_cache = cache;
+	_parameters = parameters;
+}
+
+void	Components::add(const std::string& name, const builder_type& builder) {
+	_components.push_back(component(name, builder));
+}
+
+/**
+ * \brief Build a single component, catching all exceptions
+ */
+void	Components::build_component(component& c) const {
+	try {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "building %s", c.name.c_str());
+		c.result = _cache.get(c.name + "\n" + _parameters, c.builder);
+		c.valid = true;
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "%s built", c.name.c_str());
+	} catch (std::exception& x) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "failed to build %s: %s",
+			c.name.c_str(), x.what());
+	} catch (...) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "failed to build %s",
+			c.name.c_str());
+	}
+}
+
+/**
+ * \brief Build all components on the thread pool
+ */
+void	Components::build() {
+	TaskGroup	group;
+	for (size_t i = 0; i < _components.size(); i++) {
+		component	*c = &_components[i];
+		group.run([this, c]() { build_component(*c); });
+	}
+	group.wait();
+}
+
+/**
+ * \brief Add all successfully built components to a union
+ */
+void	Components::add_to(Nef_nary_union& unioner) const {
+	for (size_t i = 0; i < _components.size(); i++) {
+		if (_components[i].valid) {
+			unioner.add_polyhedron(_components[i].result);
+		}
+	}
+}
+
+void	Components::add_to(Parallel_nary_union& unioner) const {
+	for (size_t i = 0; i < _components.size(); i++) {
+		if (_components[i].valid) {
+			unioner.add_polyhedron(_components[i].result);
+		}
+	}
+}
+
+/**
+ * \brief Build all components and return their union
+ */
+Nef_polyhedron	Components::get_union() {
+	build();
+	Parallel_nary_union	unioner;
+	add_to(unioner);
+	return unioner.get_union();
+}
+
+/**
+ * \brief Union of all components as a deferred expression
+ *
+ * Each component becomes a leaf that goes through the cache. As with
+ * build(), a component that throws is reported and left out.
+ */
+Expression	Components::expression() const {
+	Expression	result;
+	for (size_t i = 0; i < _components.size(); i++) {
+		ComponentCache	cache = _cache;
+		std::string	key = _components[i].name + "\n" + _parameters;
+		std::string	name = _components[i].name;
+		builder_type	builder = _components[i].builder;
+		result = result + Expression::leaf(name,
+			[cache, key, name, builder]() {
+			try {
+				return cache.get(key, builder);
+			} catch (std::exception& x) {
+				debug(LOG_ERR, DEBUG_LOG, 0,
+					"failed to build %s: %s",
+					name.c_str(), x.what());
+			} catch (...) {
+				debug(LOG_ERR, DEBUG_LOG, 0,
+					"failed to build %s", name.c_str());
+			}
+			return Nef_polyhedron();
+		});
+	}
+	return result;
+}
+
+} // namespace csg
@@ -0,0 +1,463 @@
+/*
+ * Contouring.cpp -- block parallel dual contouring of a scalar grid
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Contouring.h>
+#include <ThreadPool.h>
+#include <debug.h>
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <vector>
+
+namespace csg {
+
+const int	Contouring::blocksize;
+
+//////////////////////////////////////////////////////////////////////
+// cube topology
+//
+// Corner c of a cell has the coordinates (c & 1, (c >> 1) & 1, c >> 2).
+// The edges parallel to the x axis have the numbers y + 2z, those
+// parallel to the y axis 4 + x + 2z, and those parallel to the z axis
+// 8 + x + 2y, where x, y, z are the coordinates of their lower corner.
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Number of the edge connecting two adjacent corners
+ */
+static int	edge_between(int c0, int c1) {
+	int	lo = std::min(c0, c1);
+	int	x = lo & 1, y = (lo >> 1) & 1, z = (lo >> 2) & 1;
+	switch (c0 ^ c1) {
+	case 1:	return y + 2 * z;
+	case 2:	return 4 + x + 2 * z;
+	}
+	return 8 + x + 2 * y;
+}
+
+static void	edge_corners(int e, int& c0, int& c1) {
+	int	a = e & 1, b = (e >> 1) & 1;
+	switch (e >> 2) {
+	case 0:	c0 = 2 * a + 4 * b; c1 = c0 + 1; break;
+	case 1:	c0 = a + 4 * b; c1 = c0 + 2; break;
+	default: c0 = a + 2 * b; c1 = c0 + 4; break;
+	}
+}
+
+/**
+ * \brief Corners of face number f in cyclic order
+ *
+ * Faces 2a and 2a + 1 are perpendicular to axis a, at coordinate 0 and 1.
+ */
+static void	face_corners(int f, int corners[4]) {
+	int	a = f / 2, s = f % 2;
+	int	b = (a + 1) % 3, c = (a + 2) % 3;
+	static const int	cycle[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 },
+						{ 0, 1 } };
+	for (int m = 0; m < 4; m++) {
+		corners[m] = (s << a) | (cycle[m][0] << b) | (cycle[m][1] << c);
+	}
+}
+
+static int	find(int *parent, int e) {
+	while (parent[e] != e) {
+		e = parent[e] = parent[parent[e]];
+	}
+	return e;
+}
+
+static void	unite(int *parent, int a, int b) {
+	parent[find(parent, a)] = find(parent, b);
+}
+
+//////////////////////////////////////////////////////////////////////
+// blocks of cells
+//////////////////////////////////////////////////////////////////////
+
+const dccell	*dcblock::cell(int i, int j, int k) const {
+	dccell	key;
+	int	s = Contouring::blocksize;
+	key.index = (i - i0) + s * ((j - j0) + s * (k - k0));
+	std::vector<dccell>::const_iterator	c
+		= std::lower_bound(cells.begin(), cells.end(), key);
+	if ((c == cells.end()) || (c->index != key.index)) {
+		return NULL;
+	}
+	return &*c;
+}
+
+Contouring::Contouring(const point& origin, double h, int nx, int ny,
+	int nz) : _origin(origin), _h(h) {
+	_n[0] = nx; _n[1] = ny; _n[2] = nz;
+	for (int a = 0; a < 3; a++) {
+		_nb[a] = (_n[a] + blocksize - 1) / blocksize;
+	}
+	_blocks.resize((size_t)_nb[0] * _nb[1] * _nb[2]);
+	for (int bk = 0; bk < _nb[2]; bk++) {
+		for (int bj = 0; bj < _nb[1]; bj++) {
+			for (int bi = 0; bi < _nb[0]; bi++) {
+				dcblock&	b = _blocks[bi
+						+ _nb[0] * (bj + _nb[1] * bk)];
+				b.i0 = bi * blocksize;
+				b.j0 = bj * blocksize;
+				b.k0 = bk * blocksize;
+				b.firstvertex = 0;
+			}
+		}
+	}
+}
+
+/**
+ * \brief Value at a grid point of a block, evaluated at most once
+ */
+double	Contouring::value(dcblock& b, int i, int j, int k) const {
+	int	s = blocksize + 1;
+	double&	v = b.values[(i - b.i0) + s * ((j - b.j0) + s * (k - b.k0))];
+	if (v != v) {
+		v = evaluate(b, i, j, k);
+	}
+	return v;
+}
+
+/**
+ * \brief Whether an octant of size^3 cells can be skipped
+ *
+ * The default visits all cells.
+ */
+bool	Contouring::far(int /* i */, int /* j */, int /* k */,
+		int /* size */) const {
+	return false;
+}
+
+/**
+ * \brief Visit an octant of size^3 cells, skipping it if it is far from
+ *        the surface
+ */
+void	Contouring::visit(dcblock& b, int i, int j, int k, int size) const {
+	if ((i >= _n[0]) || (j >= _n[1]) || (k >= _n[2])) {
+		return;
+	}
+	if (far(i, j, k, size)) {
+		return;
+	}
+	if (size == 1) {
+		contour(b, i, j, k);
+		return;
+	}
+	int	s = size / 2;
+	for (int o = 0; o < 8; o++) {
+		visit(b, i + s * (o & 1), j + s * ((o >> 1) & 1),
+			k + s * (o >> 2), s);
+	}
+}
+
+/**
+ * \brief Vertex minimizing the distances from the tangent planes
+ *
+ * The quadratic error is regularized towards the mass point of the
+ * crossings, which also is the fallback if the minimum lies outside the
+ * cell.
+ */
+point	Contouring::place(const std::vector<point>& points,
+		const std::vector<vector>& normals, int i, int j, int k) const {
+	double	cx = 0, cy = 0, cz = 0;
+	for (size_t m = 0; m < points.size(); m++) {
+		cx += points[m].x(); cy += points[m].y(); cz += points[m].z();
+	}
+	point	c(cx / points.size(), cy / points.size(), cz / points.size());
+	const double	lambda = 0.05;
+	double	a[3][3] = { { lambda, 0, 0 }, { 0, lambda, 0 },
+				{ 0, 0, lambda } };
+	double	r[3] = { 0, 0, 0 };
+	for (size_t m = 0; m < normals.size(); m++) {
+		double	n[3] = { normals[m].x(), normals[m].y(), normals[m].z() };
+		double	d = normals[m] * (points[m] - c);
+		for (int u = 0; u < 3; u++) {
+			for (int v = 0; v < 3; v++) {
+				a[u][v] += n[u] * n[v];
+			}
+			r[u] += n[u] * d;
+		}
+	}
+	double	det = a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+		- a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+		+ a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+	if (!(fabs(det) > 0)) {
+		return c;
+	}
+	double	x[3];
+	for (int u = 0; u < 3; u++) {
+		double	m[3][3];
+		for (int s = 0; s < 3; s++) {
+			for (int t = 0; t < 3; t++) {
+				m[s][t] = (t == u) ? r[s] : a[s][t];
+			}
+		}
+		x[u] = (m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+			- m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+			+ m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]))
+			/ det;
+	}
+	point	p = c + vector(x[0], x[1], x[2]);
+	point	lo = gridpoint(i, j, k);
+	point	hi = gridpoint(i + 1, j + 1, k + 1);
+	if ((p.x() < lo.x()) || (p.x() > hi.x()) || (p.y() < lo.y())
+		|| (p.y() > hi.y()) || (p.z() < lo.z()) || (p.z() > hi.z())) {
+		return c;
+	}
+	return p;
+}
+
+/**
+ * \brief Create the vertices of a cell
+ *
+ * On each face, the crossed edges are paired by the segments of the
+ * surface crossing the face, the pieces of surface in the cell are the
+ * cycles of crossed edges formed by these pairs.
+ */
+void	Contouring::contour(dcblock& b, int i, int j, int k) const {
+	double	v[8];
+	int	mask = 0;
+	for (int c = 0; c < 8; c++) {
+		v[c] = value(b, i + (c & 1), j + ((c >> 1) & 1), k + (c >> 2));
+		if (v[c] < 0) {
+			mask |= 1 << c;
+		}
+	}
+	if ((mask == 0) || (mask == 255)) {
+		return;
+	}
+	int	parent[12];
+	bool	crossed[12];
+	for (int e = 0; e < 12; e++) {
+		int	c0, c1;
+		edge_corners(e, c0, c1);
+		parent[e] = e;
+		crossed[e] = ((mask >> c0) & 1) != ((mask >> c1) & 1);
+	}
+	for (int f = 0; f < 6; f++) {
+		int	fc[4], fe[4], count = 0;
+		face_corners(f, fc);
+		for (int m = 0; m < 4; m++) {
+			fe[m] = edge_between(fc[m], fc[(m + 1) % 4]);
+			if (crossed[fe[m]]) {
+				count++;
+			}
+		}
+		if (count == 2) {
+			int	first = -1;
+			for (int m = 0; m < 4; m++) {
+				if (crossed[fe[m]]) {
+					if (first < 0) {
+						first = fe[m];
+					} else {
+						unite(parent, first, fe[m]);
+					}
+				}
+			}
+		} else if (count == 4) {
+			// asymptotic decider: are corners 0 and 2 connected?
+			double	v0 = v[fc[0]], v1 = v[fc[1]];
+			double	v2 = v[fc[2]], v3 = v[fc[3]];
+			double	denominator = v0 + v2 - v1 - v3;
+			double	saddle = (denominator != 0)
+				? (v0 * v2 - v1 * v3) / denominator : v0;
+			if ((saddle < 0) == (v0 < 0)) {
+				unite(parent, fe[0], fe[1]);
+				unite(parent, fe[2], fe[3]);
+			} else {
+				unite(parent, fe[3], fe[0]);
+				unite(parent, fe[1], fe[2]);
+			}
+		}
+	}
+	dccell	cell;
+	cell.index = (i - b.i0) + blocksize * ((j - b.j0)
+			+ blocksize * (k - b.k0));
+	cell.mask = mask;
+	for (int e = 0; e < 12; e++) {
+		cell.vertex[e] = -1;
+	}
+	for (int e = 0; e < 12; e++) {
+		if ((!crossed[e]) || (cell.vertex[e] >= 0)) {
+			continue;
+		}
+		int	root = find(parent, e);
+		std::vector<point>	points;
+		std::vector<vector>	normals;
+		for (int f = e; f < 12; f++) {
+			if ((!crossed[f]) || (find(parent, f) != root)) {
+				continue;
+			}
+			int	c0, c1;
+			edge_corners(f, c0, c1);
+			double	t = v[c0] / (v[c0] - v[c1]);
+			point	p0 = gridpoint(i + (c0 & 1), j + ((c0 >> 1) & 1),
+					k + (c0 >> 2));
+			vector	d = gridpoint(i + (c1 & 1), j + ((c1 >> 1) & 1),
+					k + (c1 >> 2)) - p0;
+			point	p = p0 + t * d;
+			points.push_back(p);
+			vector	n = normal(p);
+			normals.push_back((n.norm() > 0) ? n.normalized() : n);
+		}
+		point	p = place(points, normals, i, j, k);
+		int	index = b.vertices.size() / 3;
+		b.vertices.push_back(p.x());
+		b.vertices.push_back(p.y());
+		b.vertices.push_back(p.z());
+		for (int f = e; f < 12; f++) {
+			if (crossed[f] && (find(parent, f) == root)) {
+				cell.vertex[f] = index;
+			}
+		}
+	}
+	b.cells.push_back(cell);
+}
+
+const dccell	*Contouring::cell(int i, int j, int k) const {
+	if ((i < 0) || (j < 0) || (k < 0)) {
+		return NULL;
+	}
+	int	bi = i / blocksize, bj = j / blocksize, bk = k / blocksize;
+	if ((bi >= _nb[0]) || (bj >= _nb[1]) || (bk >= _nb[2])) {
+		return NULL;
+	}
+	return _blocks[bi + _nb[0] * (bj + _nb[1] * bk)].cell(i, j, k);
+}
+
+/**
+ * \brief Global number and position of the vertex of a cell for edge e
+ *
+ * Returns -1 if the cell has no vertex for the edge.
+ */
+int	Contouring::vertex(int i, int j, int k, int e, point& p) const {
+	const dccell	*c = cell(i, j, k);
+	if ((c == NULL) || (c->vertex[e] < 0)) {
+		return -1;
+	}
+	const dcblock&	b = _blocks[i / blocksize
+		+ _nb[0] * (j / blocksize + _nb[1] * (k / blocksize))];
+	const double	*v = &b.vertices[3 * c->vertex[e]];
+	p = point(v[0], v[1], v[2]);
+	return b.firstvertex + c->vertex[e];
+}
+
+/**
+ * \brief Create the triangles for the crossed edges starting at the
+ *        lower corner of the cells of a block
+ *
+ * The four cells around an edge parallel to axis a are listed
+ * counterclockwise as seen from the positive a axis, which is the
+ * outside if the lower end of the edge is inside. The quadrilateral
+ * they form is split along its shorter diagonal.
+ */
+void	Contouring::triangulate(dcblock& b) const {
+	static const int	around[4][2] = { { 1, 1 }, { 0, 1 }, { 0, 0 },
+						{ 1, 0 } };
+	for (size_t m = 0; m < b.cells.size(); m++) {
+		const dccell&	c = b.cells[m];
+		int	cc[3] = { b.i0 + c.index % blocksize,
+				b.j0 + (c.index / blocksize) % blocksize,
+				b.k0 + c.index / (blocksize * blocksize) };
+		for (int a = 0; a < 3; a++) {
+			if (c.vertex[edge_between(0, 1 << a)] < 0) {
+				continue;
+			}
+			int	ab = (a + 1) % 3, ac = (a + 2) % 3;
+			int	q[4];
+			point	p[4];
+			bool	complete = true;
+			for (int r = 0; r < 4; r++) {
+				int	n[3] = { cc[0], cc[1], cc[2] };
+				n[ab] -= around[r][0];
+				n[ac] -= around[r][1];
+				int	lo = (around[r][0] << ab)
+					| (around[r][1] << ac);
+				q[r] = vertex(n[0], n[1], n[2],
+					edge_between(lo, lo | (1 << a)), p[r]);
+				complete = complete && (q[r] >= 0);
+			}
+			if (!complete) {
+				debug(LOG_ERR, DEBUG_LOG, 0,
+					"incomplete quad at %d,%d,%d",
+					cc[0], cc[1], cc[2]);
+				continue;
+			}
+			if (!(c.mask & 1)) {
+				std::swap(q[1], q[3]);
+				std::swap(p[1], p[3]);
+			}
+			int	t[6] = { q[0], q[1], q[2], q[0], q[2], q[3] };
+			if ((p[0] - p[2]).norm() > (p[1] - p[3]).norm()) {
+				int	u[6] = { q[0], q[1], q[3], q[1], q[2], q[3] };
+				std::copy(u, u + 6, t);
+			}
+			b.triangles.insert(b.triangles.end(), t, t + 6);
+		}
+	}
+}
+
+void	Contouring::build() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "contouring %d x %d x %d cells",
+		_n[0], _n[1], _n[2]);
+	{
+		TaskGroup	group;
+		for (size_t m = 0; m < _blocks.size(); m++) {
+			dcblock	*b = &_blocks[m];
+			group.run([this, b]() {
+				int	s = blocksize + 1;
+				sample(*b);
+				b->values.assign(s * s * s,
+					std::numeric_limits<double>::quiet_NaN());
+				visit(*b, b->i0, b->j0, b->k0, blocksize);
+				std::vector<double>().swap(b->values);
+				std::vector<double>().swap(b->samples);
+				std::sort(b->cells.begin(), b->cells.end());
+			});
+		}
+		group.wait();
+	}
+	int	first = 0;
+	for (size_t m = 0; m < _blocks.size(); m++) {
+		_blocks[m].firstvertex = first;
+		first += _blocks[m].vertices.size() / 3;
+	}
+	{
+		TaskGroup	group;
+		for (size_t m = 0; m < _blocks.size(); m++) {
+			dcblock	*b = &_blocks[m];
+			group.run([this, b]() { triangulate(*b); });
+		}
+		group.wait();
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%d vertices", first);
+}
+
+int	Contouring::number_of_vertices() const {
+	int	result = 0;
+	for (size_t m = 0; m < _blocks.size(); m++) {
+		result += _blocks[m].vertices.size() / 3;
+	}
+	return result;
+}
+
+void	Contouring::copy_vertices(double *vertices) const {
+	for (size_t m = 0; m < _blocks.size(); m++) {
+		std::copy(_blocks[m].vertices.begin(), _blocks[m].vertices.end(),
+			vertices + 3 * _blocks[m].firstvertex);
+	}
+}
+
+std::vector<int>	Contouring::triangles() const {
+	std::vector<int>	result;
+	for (size_t m = 0; m < _blocks.size(); m++) {
+		result.insert(result.end(), _blocks[m].triangles.begin(),
+			_blocks[m].triangles.end());
+	}
+	return result;
+}
+
+} // namespace csg
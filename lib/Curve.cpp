@@ -4,49 +4,251 @@
  * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
 #include <Curve.h>
+#include <AngleTable.h>
 #include <debug.h>
+#include <stdexcept>
+#include <algorithm>
 
 namespace csg {
 
-vector  CurveFunction::tangent(double t) const {
-	vector  result(position(t), position(t + _deltat));
-	return result.normalized();
+vector	CurveFunction::tangent(double t) const {
+	return evaluate(t).d1;
 }
 
-vector  CurveFunction::normal(double t) const {
-	vector  T = tangent(t);
-	vector  result = tangent(t + _deltat) - T;
-	return result.orthogonalto(T).normalized();
+vector	CurveFunction::normal(double t) const {
+	return evaluate(t).d2;
+}
+
+/**
+ * \brief Position and derivatives in one call
+ *
+ * The default implementation uses central differences of the positions
+ * at t - deltat, t and t + deltat, so it costs three calls to position().
+ * If no step has been set, a step relative to the size of t is used,
+ * which balances truncation and rounding errors of the second derivative.
+ */
+curvepoint	CurveFunction::evaluate(double t) const {
+	double	h = _deltat;
+	if (h <= 0) {
+		h = 1e-4 * std::max(1., fabs(t));
+	}
+	point	pminus = position(t - h);
+	point	pplus = position(t + h);
+	curvepoint	c;
+	c.p = position(t);
+	c.d1 = (1 / (2 * h)) * vector(pminus, pplus);
+	c.d2 = (1 / (h * h)) * (vector(c.p, pplus) - vector(pminus, c.p));
+	return c;
 }
 
 frame	CurveFunction::frenetframe(double t) const {
-	return frame(tangent(t), normal(t));
+	curvepoint	c = evaluate(t);
+	return frame(c.d1, c.d2);
+}
+
+/**
+ * \brief Angle between two vectors
+ */
+static double	angle(const vector& a, const vector& b) {
+	double	c = (a * b) / (a.norm() * b.norm());
+	if (c >= 1) {
+		return 0;
+	}
+	if (c <= -1) {
+		return M_PI;
+	}
+	return acos(c);
+}
+
+/**
+ * \brief Compute the parameter values and curve points of the rings
+ *
+ * The rings are only computed once, even if the clip box leaves none.
+ */
+void	Build_Curve::sample() const {
+	if (_sampled) {
+		return;
+	}
+	_sampled = true;
+	_parameters.clear();
+	_points.clear();
+	double	deltat = _interval.length() / _steps;
+	if (_maxangle <= 0) {
+		for (int t = 0; t <= _steps; t++) {
+			double	_t = _interval.min() + t * deltat;
+			_parameters.push_back(_t);
+			_points.push_back(_f.evaluate(_t));
+		}
+		trim();
+		return;
+	}
+
+	// start from a coarse grid of at most four segments and refine
+	int	coarse = (_steps < 4) ? _steps : 4;
+	double	coarsedelta = _interval.length() / coarse;
+	double	t0 = _interval.min();
+	curvepoint	c0 = _f.evaluate(t0);
+	_parameters.push_back(t0);
+	_points.push_back(c0);
+	for (int t = 1; t <= coarse; t++) {
+		double	t1 = (t == coarse) ? _interval.max()
+				: _interval.min() + t * coarsedelta;
+		curvepoint	c1 = _f.evaluate(t1);
+		refine(t0, c0, t1, c1);
+		t0 = t1;
+		c0 = c1;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%d rings for at most %d steps",
+		(int)_parameters.size(), _steps);
+	trim();
+}
+
+/**
+ * \brief Keep only the rings of segments of the tube that may meet the box
+ *
+ * The segment between two rings lies within distance r of the segment
+ * between their centers, so it may only meet the box if the bounding
+ * box of the two centers, enlarged by r, does. If no segment does, no
+ * rings are left.
+ */
+void	Build_Curve::trim() const {
+	if (_clip.empty()) {
+		return;
+	}
+	vector	margin(_r, _r, _r);
+	int	first = _parameters.size(), last = -1;
+	for (int i = 0; i + 1 < (int)_points.size(); i++) {
+		bounds	segment(_points[i].p, _points[i + 1].p);
+		segment = bounds(segment.min() - margin, segment.max() + margin);
+		if (segment.overlaps(_clip)) {
+			first = std::min(first, i);
+			last = i + 1;
+		}
+	}
+	if (last < 0) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "curve outside clip box");
+		_parameters.clear();
+		_points.clear();
+		return;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "clipped to rings %d to %d of %d",
+		first, last, (int)_parameters.size());
+	_parameters.erase(_parameters.begin() + last + 1, _parameters.end());
+	_points.erase(_points.begin() + last + 1, _points.end());
+	_parameters.erase(_parameters.begin(), _parameters.begin() + first);
+	_points.erase(_points.begin(), _points.begin() + first);
+}
+
+/**
+ * \brief Add rings in the interval (t0, t1] until the tangent turns slowly
+ *
+ * The turning angle is estimated through the midpoint, so that segments
+ * where the tangent turns back to its original direction are refined too.
+ * Segments are not split below the equidistant ring spacing.
+ */
+void	Build_Curve::refine(double t0, const curvepoint& c0,
+		double t1, const curvepoint& c1) const {
+	double	tm = (t0 + t1) / 2;
+	if ((tm - t0) >= _interval.length() / _steps) {
+		curvepoint	cm = _f.evaluate(tm);
+		if ((angle(c0.d1, cm.d1) + angle(cm.d1, c1.d1)) > _maxangle) {
+			refine(t0, c0, tm, cm);
+			refine(tm, cm, t1, c1);
+			return;
+		}
+	}
+	_parameters.push_back(t1);
+	_points.push_back(c1);
+}
+
+/**
+ * \brief Compute the frames for all rings
+ *
+ * Rotation minimizing frames are propagated from the first ring with the
+ * double reflection method of Wang, Juettler, Zheng and Liu.
+ */
+std::vector<frame>	Build_Curve::ringframes() const {
+	std::vector<frame>	result;
+	if (_frames == FRENET_FRAMES) {
+		for (unsigned int i = 0; i < _points.size(); i++) {
+			result.push_back(frame(_points[i].d1, _points[i].d2));
+		}
+		return result;
+	}
+
+	// initial frame, any normal will do if the curve is straight there
+	try {
+		result.push_back(frame(_points[0].d1, _points[0].d2));
+	} catch (const std::exception&) {
+		result.push_back(frame(_points[0].d1));
+	}
+	for (unsigned int i = 1; i < _points.size(); i++) {
+		const frame&	f0 = result[i - 1];
+		vector	t1 = _points[i].d1 / _points[i].d1.norm();
+
+		// reflect in the plane bisecting the two ring centers
+		vector	v1 = _points[i].p - _points[i - 1].p;
+		double	c1 = v1 * v1;
+		vector	r = f0.v2();
+		vector	t = f0.v1();
+		if (c1 > 0) {
+			r = r - ((2 / c1) * (v1 * r)) * v1;
+			t = t - ((2 / c1) * (v1 * t)) * v1;
+		}
+
+		// reflect the tangent onto the new tangent
+		vector	v2 = t1 - t;
+		double	c2 = v2 * v2;
+		if (c2 > 0) {
+			r = r - ((2 / c2) * (v2 * r)) * v2;
+		}
+		result.push_back(frame(t1, r));
+	}
+	return result;
+}
+
+int	Build_Curve::rings() const {
+	sample();
+	return _parameters.size();
 }
 
 int	Build_Curve::vertex(int t, int phi) const {
 	return t * _phisteps + phi + 1;
 }
 
+int	Build_Curve::expected_vertices() const {
+	int	n = rings();
+	return (n > 0) ? (n * _phisteps + 2) : 0;
+}
+
+int	Build_Curve::expected_facets() const {
+	return 2 * rings() * _phisteps;
+}
+
 /**
  * \brief Main function to create surface corresponding to space curve
  */
-void	Build_Curve::operator()(Polyhedron::HalfedgeDS& hds) {
-	Builder	B(hds, true);
-	B.begin_surface(0, 0, 0);
+void	Build_Curve::build() {
+	sample();
+	int	n = rings();
+	if (n == 0) {
+		return;
+	}
+	std::vector<frame>	framelist = ringframes();
+
 	// add all vertices
 	// initial vertex
-	add_vertex(B, _f.position(_interval.min()));
+	add_vertex(_points[0].p);
 
 	// intermediate points
-	double	deltat = _interval.length() / _steps;
-	double	deltaphi = 2 * M_PI / _phisteps;
-	for (int t = 0; t <= _steps; t++) {
-		double	_t = _interval.min() + t * deltat;
+	const AngleTable&	angles = AngleTable::get(Interval2Pi, _phisteps);
+	for (int t = 0; t < n; t++) {
 		if (debuglevel > LOG_DEBUG) {
-			debug(LOG_DEBUG, DEBUG_LOG, 0, "circle at t = %f", _t);
+			debug(LOG_DEBUG, DEBUG_LOG, 0, "circle at t = %f",
+				_parameters[t]);
 		}
-		point	w = _f.position(_t);
-		frame	fr = _f.frenetframe(_t);
+		point	w = _points[t].p;
+		const frame&	fr = framelist[t];
 		if (debuglevel > LOG_DEBUG) {
 			debug(LOG_DEBUG, DEBUG_LOG, 0,
 				"tangent (%f, %f, %f), normal (%f, %f, %f)",
@@ -54,13 +256,12 @@ void	Build_Curve::operator()(Polyhedron::HalfedgeDS& hds) {
 				fr.v2().x(), fr.v2().y(), fr.v2().z());
 		}
 		for (int phi = 0; phi < _phisteps; phi++) {
-			double	_phi = phi * deltaphi;
-			add_vertex(B, w + _r *
-				(cos(_phi) * fr.v3() + sin(_phi) * fr.v2()));
+			add_vertex(w + _r * (angles.cosine(phi) * fr.v3()
+				+ angles.sine(phi) * fr.v2()));
 		}
 	}
 
-	add_vertex(B, _f.position(_interval.max()));
+	add_vertex(_points[n - 1].p);
 
 	// add all facets
 	
@@ -69,30 +270,30 @@ void	Build_Curve::operator()(Polyhedron::HalfedgeDS& hds) {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "start cap");
 	}
 	for (int phi = 0; phi < _phisteps - 1; phi++) {
-		add_facet(B, 0, vertex(0, phi), vertex(0, phi + 1));
+		add_facet(0, vertex(0, phi), vertex(0, phi + 1));
 	}
-	add_facet(B, 0, _phisteps , 1);
+	add_facet(0, _phisteps , 1);
 
 	// intermediate zones
-	for (int t = 0; t < _steps; t++) {
+	for (int t = 0; t < n - 1; t++) {
 		if (debuglevel > LOG_DEBUG) {
 			debug(LOG_DEBUG, DEBUG_LOG, 0, "facets for t = %d", t);
 		}
 		for (int phi = 0; phi < _phisteps - 1; phi++) {
-			add_facet(B,
+			add_facet(
 				vertex(t    , phi    ),
 				vertex(t + 1, phi    ),
 				vertex(t    , phi + 1));
-			add_facet(B,
+			add_facet(
 				vertex(t    , phi + 1),
 				vertex(t + 1, phi    ),
 				vertex(t + 1, phi + 1));
 		}
-		add_facet(B,
+		add_facet(
 			vertex(t    , _phisteps - 1    ),
 			vertex(t + 1, _phisteps - 1    ),
 			vertex(t    , 0));
-		add_facet(B,
+		add_facet(
 			vertex(t    , 0),
 			vertex(t + 1, _phisteps - 1    ),
 			vertex(t + 1, 0));
@@ -103,18 +304,17 @@ void	Build_Curve::operator()(Polyhedron::HalfedgeDS& hds) {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "end cap");
 	}
 	for (int phi = 0; phi < _phisteps - 1; phi++) {
-		add_facet(B,
-			vertex(_steps, phi),
+		add_facet(
+			vertex(n - 1, phi),
 			vertexnumber() - 1,
-			vertex(_steps, phi + 1));
+			vertex(n - 1, phi + 1));
 	}
-	add_facet(B,
-		vertex(_steps, _phisteps - 1),
+	add_facet(
+		vertex(n - 1, _phisteps - 1),
 		vertexnumber() - 1,
-		vertex(_steps, 0));
+		vertex(n - 1, 0));
 
 	// that's it, we are done
-	B.end_surface();
 }
 
 } // namespace csg
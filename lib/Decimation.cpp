@@ -0,0 +1,449 @@
+/*
+ * Decimation.cpp -- quadric error metric decimation of triangle meshes
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Decimation.h>
+#include <Surface.h>
+#include <debug.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <queue>
+#include <set>
+
+namespace csg {
+
+/**
+ * \brief Symmetric 4x4 matrix of a quadric error function
+ *
+ * Only the upper triangle a11 a12 a13 a14 a22 a23 a24 a33 a34 a44 is kept.
+ */
+class Quadric {
+public:
+	double	q[10];
+	Quadric() { std::fill(q, q + 10, 0.); }
+	void	add_plane(double a, double b, double c, double d) {
+		q[0] += a * a; q[1] += a * b; q[2] += a * c; q[3] += a * d;
+		q[4] += b * b; q[5] += b * c; q[6] += b * d;
+		q[7] += c * c; q[8] += c * d;
+		q[9] += d * d;
+	}
+	Quadric&	operator+=(const Quadric& other) {
+		for (int i = 0; i < 10; i++) {
+			q[i] += other.q[i];
+		}
+		return *this;
+	}
+	double	operator()(const double *p) const {
+		double	x = p[0], y = p[1], z = p[2];
+		double	e = q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z
+			+ 2 * q[3] * x + q[4] * y * y + 2 * q[5] * y * z
+			+ 2 * q[6] * y + q[7] * z * z + 2 * q[8] * z + q[9];
+		return std::max(e, 0.);
+	}
+	bool	minimum(double *p) const;
+};
+
+/**
+ * \brief Find the point of minimal error
+ *
+ * Solves the 3x3 system with Cramer's rule, returns false if the
+ * system is close to singular, i.e. if the planes are almost parallel.
+ */
+bool	Quadric::minimum(double *p) const {
+	double	a11 = q[0], a12 = q[1], a13 = q[2];
+	double	a22 = q[4], a23 = q[5], a33 = q[7];
+	double	b1 = -q[3], b2 = -q[6], b3 = -q[8];
+	double	c11 = a22 * a33 - a23 * a23;
+	double	c12 = a13 * a23 - a12 * a33;
+	double	c13 = a12 * a23 - a13 * a22;
+	double	det = a11 * c11 + a12 * c12 + a13 * c13;
+	double	scale = a11 + a22 + a33;
+	if (fabs(det) <= 1e-6 * scale * scale * scale) {
+		return false;
+	}
+	double	c22 = a11 * a33 - a13 * a13;
+	double	c23 = a12 * a13 - a11 * a23;
+	double	c33 = a11 * a22 - a12 * a12;
+	p[0] = (c11 * b1 + c12 * b2 + c13 * b3) / det;
+	p[1] = (c12 * b1 + c22 * b2 + c23 * b3) / det;
+	p[2] = (c13 * b1 + c23 * b2 + c33 * b3) / det;
+	return true;
+}
+
+/**
+ * \brief Candidate edge collapse in the priority queue
+ *
+ * The versions of the end points at the time the candidate was computed
+ * are recorded, a candidate is stale if one of them has changed since.
+ */
+struct Collapse {
+	double	cost;
+	int	a, b;
+	int	va, vb;
+	double	p[3];
+	bool	operator<(const Collapse& other) const {
+		return cost > other.cost;
+	}
+};
+
+/**
+ * \brief Working state of a decimation run
+ */
+class Decimator {
+	std::vector<double>&	_vertices;
+	std::vector<int>&	_triangles;
+	std::vector<Quadric>	_quadrics;
+	std::vector<std::vector<int> >	_incident;
+	std::vector<int>	_version;
+	std::vector<bool>	_fixed;
+	std::vector<bool>	_removed;
+	std::vector<bool>	_dead;
+	std::priority_queue<Collapse>	_queue;
+	double	_maxcost;
+	int	_alive;
+	void	normal(int t, int from, int to, const double *p,
+			double *n) const;
+	std::set<int>	neighbours(int v) const;
+	void	push(int a, int b);
+	bool	valid(const Collapse& c, int& c1, int& c2) const;
+	void	collapse(const Collapse& c, int c1, int c2);
+public:
+	Decimator(IndexedMesh& mesh, double maxdeviation);
+	int	alive() const { return _alive; }
+	bool	step();
+	void	compact();
+};
+
+Decimator::Decimator(IndexedMesh& mesh, double maxdeviation)
+	: _vertices(mesh.vertices), _triangles(mesh.triangles) {
+	_maxcost = maxdeviation * maxdeviation;
+	int	nvertices = mesh.number_of_vertices();
+	int	ntriangles = mesh.number_of_triangles();
+	_alive = ntriangles;
+	_quadrics.resize(nvertices);
+	_incident.resize(nvertices);
+	_version.resize(nvertices, 0);
+	_fixed.resize(nvertices, false);
+	_removed.resize(nvertices, false);
+	_dead.resize(ntriangles, false);
+
+	// plane quadrics of all triangles, with unit normals, so that the
+	// error is the sum of the squared distances from the planes
+	std::map<std::pair<int, int>, int>	edges;
+	for (int t = 0; t < ntriangles; t++) {
+		double	n[3];
+		normal(t, -1, -1, NULL, n);
+		double	l = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		const int	*v = &_triangles[3 * t];
+		if (l > 0) {
+			const double	*p = &_vertices[3 * v[0]];
+			n[0] /= l; n[1] /= l; n[2] /= l;
+			double	d = -(n[0] * p[0] + n[1] * p[1] + n[2] * p[2]);
+			Quadric	q;
+			q.add_plane(n[0], n[1], n[2], d);
+			for (int i = 0; i < 3; i++) {
+				_quadrics[v[i]] += q;
+			}
+		}
+		for (int i = 0; i < 3; i++) {
+			_incident[v[i]].push_back(t);
+			int	a = v[i], b = v[(i + 1) % 3];
+			edges[std::make_pair(std::min(a, b), std::max(a, b))]++;
+		}
+	}
+
+	// vertices on edges not shared by exactly two triangles are never
+	// moved, this keeps boundaries and non manifold parts intact
+	std::map<std::pair<int, int>, int>::const_iterator	e;
+	for (e = edges.begin(); e != edges.end(); e++) {
+		if (e->second != 2) {
+			_fixed[e->first.first] = true;
+			_fixed[e->first.second] = true;
+		}
+	}
+	for (e = edges.begin(); e != edges.end(); e++) {
+		push(e->first.first, e->first.second);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%d collapse candidates",
+		(int)_queue.size());
+}
+
+/**
+ * \brief Compute the (unnormalized) normal of a triangle
+ *
+ * If from is a vertex of the triangle, it is replaced by vertex to
+ * at position p, this gives the normal after a collapse.
+ */
+void	Decimator::normal(int t, int from, int to, const double *p,
+		double *n) const {
+	const double	*q[3];
+	for (int i = 0; i < 3; i++) {
+		int	v = _triangles[3 * t + i];
+		q[i] = ((v == from) || (v == to)) ? p : &_vertices[3 * v];
+	}
+	double	u[3], w[3];
+	for (int i = 0; i < 3; i++) {
+		u[i] = q[1][i] - q[0][i];
+		w[i] = q[2][i] - q[0][i];
+	}
+	n[0] = u[1] * w[2] - u[2] * w[1];
+	n[1] = u[2] * w[0] - u[0] * w[2];
+	n[2] = u[0] * w[1] - u[1] * w[0];
+}
+
+std::set<int>	Decimator::neighbours(int v) const {
+	std::set<int>	result;
+	std::vector<int>::const_iterator	t;
+	for (t = _incident[v].begin(); t != _incident[v].end(); t++) {
+		for (int i = 0; i < 3; i++) {
+			int	w = _triangles[3 * *t + i];
+			if (w != v) {
+				result.insert(w);
+			}
+		}
+	}
+	return result;
+}
+
+/**
+ * \brief Compute the optimal collapse of an edge and queue it
+ *
+ * If the quadric has no unique minimum, the better of the end points
+ * and the midpoint is used. Collapses exceeding the maximum deviation
+ * are not queued at all.
+ */
+void	Decimator::push(int a, int b) {
+	if (_fixed[a] || _fixed[b]) {
+		return;
+	}
+	Quadric	q = _quadrics[a];
+	q += _quadrics[b];
+	Collapse	c;
+	c.a = a; c.b = b;
+	c.va = _version[a]; c.vb = _version[b];
+	if (q.minimum(c.p)) {
+		c.cost = q(c.p);
+	} else {
+		const double	*pa = &_vertices[3 * a];
+		const double	*pb = &_vertices[3 * b];
+		double	candidates[3][3];
+		for (int i = 0; i < 3; i++) {
+			candidates[0][i] = pa[i];
+			candidates[1][i] = pb[i];
+			candidates[2][i] = (pa[i] + pb[i]) / 2;
+		}
+		c.cost = -1;
+		for (int k = 0; k < 3; k++) {
+			double	cost = q(candidates[k]);
+			if ((c.cost < 0) || (cost < c.cost)) {
+				c.cost = cost;
+				std::copy(candidates[k], candidates[k] + 3, c.p);
+			}
+		}
+	}
+	if (c.cost <= _maxcost) {
+		_queue.push(c);
+	}
+}
+
+/**
+ * \brief Check whether a collapse keeps the mesh a valid manifold
+ *
+ * The edge must be shared by exactly two triangles with opposite
+ * vertices c1 and c2, which must be the only common neighbours of
+ * the end points (link condition), and which must keep at least three
+ * neighbours. No remaining triangle may flip or degenerate.
+ */
+bool	Decimator::valid(const Collapse& c, int& c1, int& c2) const {
+	std::vector<int>	shared;
+	std::vector<int>::const_iterator	t;
+	for (t = _incident[c.a].begin(); t != _incident[c.a].end(); t++) {
+		const int	*v = &_triangles[3 * *t];
+		if ((v[0] == c.b) || (v[1] == c.b) || (v[2] == c.b)) {
+			shared.push_back(*t);
+		}
+	}
+	if (shared.size() != 2) {
+		return false;
+	}
+	int	opposite[2];
+	for (int k = 0; k < 2; k++) {
+		const int	*v = &_triangles[3 * shared[k]];
+		opposite[k] = v[0] + v[1] + v[2] - c.a - c.b;
+	}
+	c1 = opposite[0];
+	c2 = opposite[1];
+	if (c1 == c2) {
+		return false;
+	}
+	std::set<int>	na = neighbours(c.a);
+	std::set<int>	nb = neighbours(c.b);
+	std::vector<int>	common;
+	std::set_intersection(na.begin(), na.end(), nb.begin(), nb.end(),
+		std::back_inserter(common));
+	if (common.size() != 2) {
+		return false;
+	}
+	if ((_incident[c1].size() <= 3) || (_incident[c2].size() <= 3)) {
+		return false;
+	}
+	for (int k = 0; k < 2; k++) {
+		int	v = (k == 0) ? c.a : c.b;
+		for (t = _incident[v].begin(); t != _incident[v].end(); t++) {
+			if ((*t == shared[0]) || (*t == shared[1])) {
+				continue;
+			}
+			double	before[3], after[3];
+			normal(*t, -1, -1, NULL, before);
+			normal(*t, c.a, c.b, c.p, after);
+			double	lb = sqrt(before[0] * before[0]
+				+ before[1] * before[1] + before[2] * before[2]);
+			double	la = sqrt(after[0] * after[0]
+				+ after[1] * after[1] + after[2] * after[2]);
+			double	dot = before[0] * after[0]
+				+ before[1] * after[1] + before[2] * after[2];
+			if ((la <= 1e-12 * lb) || (dot <= 0.1 * la * lb)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Merge vertex b into vertex a
+ */
+void	Decimator::collapse(const Collapse& c, int c1, int c2) {
+	std::vector<int>&	ia = _incident[c.a];
+	std::vector<int>&	ib = _incident[c.b];
+	std::vector<int>::iterator	t;
+	for (t = ib.begin(); t != ib.end(); t++) {
+		int	*v = &_triangles[3 * *t];
+		if ((v[0] == c.a) || (v[1] == c.a) || (v[2] == c.a)) {
+			_dead[*t] = true;
+			_alive--;
+			continue;
+		}
+		for (int i = 0; i < 3; i++) {
+			if (v[i] == c.b) {
+				v[i] = c.a;
+			}
+		}
+		ia.push_back(*t);
+	}
+	ib.clear();
+	int	others[3] = { c.a, c1, c2 };
+	for (int k = 0; k < 3; k++) {
+		std::vector<int>&	incident = _incident[others[k]];
+		incident.erase(std::remove_if(incident.begin(), incident.end(),
+			[this](int t) { return _dead[t]; }), incident.end());
+	}
+	std::copy(c.p, c.p + 3, &_vertices[3 * c.a]);
+	_quadrics[c.a] += _quadrics[c.b];
+	_removed[c.b] = true;
+	_version[c.a]++;
+	_version[c.b]++;
+	std::set<int>	n = neighbours(c.a);
+	for (std::set<int>::const_iterator i = n.begin(); i != n.end(); i++) {
+		push(c.a, *i);
+	}
+}
+
+/**
+ * \brief Perform the cheapest valid collapse
+ *
+ * Returns false if no collapse within the deviation bound is left.
+ */
+bool	Decimator::step() {
+	while (!_queue.empty()) {
+		Collapse	c = _queue.top();
+		_queue.pop();
+		if (_removed[c.a] || _removed[c.b]
+			|| (c.va != _version[c.a]) || (c.vb != _version[c.b])) {
+			continue;
+		}
+		int	c1, c2;
+		if (!valid(c, c1, c2)) {
+			continue;
+		}
+		collapse(c, c1, c2);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * \brief Remove dead triangles and unused vertices from the arrays
+ */
+void	Decimator::compact() {
+	std::vector<int>	index(_removed.size(), -1);
+	int	nvertices = 0;
+	for (unsigned int v = 0; v < _removed.size(); v++) {
+		if (!_removed[v]) {
+			index[v] = nvertices;
+			std::copy(&_vertices[3 * v], &_vertices[3 * v] + 3,
+				&_vertices[3 * nvertices]);
+			nvertices++;
+		}
+	}
+	_vertices.resize(3 * nvertices);
+	int	ntriangles = 0;
+	for (unsigned int t = 0; t < _dead.size(); t++) {
+		if (!_dead[t]) {
+			for (int i = 0; i < 3; i++) {
+				_triangles[3 * ntriangles + i]
+					= index[_triangles[3 * t + i]];
+			}
+			ntriangles++;
+		}
+	}
+	_triangles.resize(3 * ntriangles);
+}
+
+/**
+ * \brief Decimate an indexed mesh in place
+ */
+void	Decimation::operator()(IndexedMesh& mesh) const {
+	int	ntriangles = mesh.number_of_triangles();
+	if (ntriangles == 0) {
+		return;
+	}
+	Decimator	decimator(mesh, _maxdeviation);
+	int	target = (int)(_ratio * ntriangles);
+	while ((decimator.alive() > target) && decimator.step()) {
+	}
+	decimator.compact();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "decimated %d to %d triangles",
+		ntriangles, mesh.number_of_triangles());
+}
+
+/**
+ * \brief Modifier loading a mesh into a polyhedron
+ */
+class Load_Mesh : public CGAL::Modifier_base<Polyhedron::HalfedgeDS> {
+	const IndexedMesh&	_mesh;
+public:
+	Load_Mesh(const IndexedMesh& mesh) : _mesh(mesh) { }
+	void	operator()(Polyhedron::HalfedgeDS& hds) {
+		load(hds, _mesh);
+	}
+};
+
+/**
+ * \brief Decimate a polyhedron
+ *
+ * The polyhedron is converted to an indexed mesh of doubles, decimated
+ * and converted back, facets with more than three vertices are
+ * triangulated on the way.
+ */
+void	Decimation::operator()(Polyhedron& polyhedron) const {
+	IndexedMesh	mesh(polyhedron);
+	(*this)(mesh);
+	polyhedron.clear();
+	Load_Mesh	loader(mesh);
+	polyhedron.delegate(loader);
+}
+
+} // namespace csg
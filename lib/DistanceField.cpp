@@ -0,0 +1,365 @@
+/*
+ * DistanceField.cpp -- signed distance fields of sheets, tubes and boxes
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <DistanceField.h>
+#include <AABBTree.h>
+#include <debug.h>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <math.h>
+
+namespace csg {
+
+/**
+ * \brief Gradient of the field by central differences with step h
+ */
+vector	DistanceField::gradient(const point& p, double h) const {
+	const DistanceField&	f = *this;
+	return vector(
+		f(p + vector(h, 0, 0)) - f(p - vector(h, 0, 0)),
+		f(p + vector(0, h, 0)) - f(p - vector(0, h, 0)),
+		f(p + vector(0, 0, h)) - f(p - vector(0, 0, h))) / (2 * h);
+}
+
+//////////////////////////////////////////////////////////////////////
+// MeshDistanceField implementation
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Construct the field from triangles and segments
+ *
+ * triangles contains three and segments two point indices per
+ * primitive. Triangles without area are treated as their edges.
+ */
+MeshDistanceField::MeshDistanceField(const std::vector<point>& points,
+		const std::vector<int>& triangles,
+		const std::vector<int>& segments, double offset)
+		: _offset(offset) {
+	for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+		primitive	t;
+		t.a = points[triangles[i]];
+		t.b = points[triangles[i + 1]];
+		t.c = points[triangles[i + 2]];
+		vector	n = (t.b - t.a).cross(t.c - t.a);
+		t.segment = !(n * n > 0);
+		t.box = bounds(t.a, t.b);
+		t.box.add(t.c);
+		t.center = t.box.center();
+		_primitives.push_back(t);
+	}
+	for (size_t i = 0; i + 1 < segments.size(); i += 2) {
+		primitive	s;
+		s.a = points[segments[i]];
+		s.b = s.c = points[segments[i + 1]];
+		s.segment = true;
+		s.box = bounds(s.a, s.b);
+		s.center = s.box.center();
+		_primitives.push_back(s);
+	}
+	if (_primitives.size() > 0) {
+		_nodes.reserve(2 * _primitives.size());
+		build(0, _primitives.size());
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "distance field of %d primitives",
+		(int)_primitives.size());
+}
+
+/**
+ * \brief Build the hierarchy for a range of primitives
+ *
+ * The range is split at the median of the centers along the longest
+ * axis of their bounding box. Returns the index of the node.
+ */
+int	MeshDistanceField::build(int first, int count) {
+	int	index = _nodes.size();
+	_nodes.push_back(node());
+	bounds	box, centers;
+	for (int i = first; i < first + count; i++) {
+		box.add(_primitives[i].box);
+		centers.add(_primitives[i].center);
+	}
+	_nodes[index].box = box;
+	_nodes[index].first = first;
+	_nodes[index].count = count;
+	_nodes[index].left = _nodes[index].right = -1;
+	if (count <= 4) {
+		return index;
+	}
+	vector	e = centers.extent();
+	int	axis = ((e.x() >= e.y()) && (e.x() >= e.z())) ? 0
+			: ((e.y() >= e.z()) ? 1 : 2);
+	int	half = count / 2;
+	std::nth_element(_primitives.begin() + first,
+		_primitives.begin() + first + half,
+		_primitives.begin() + first + count,
+		[axis](const primitive& a, const primitive& b) {
+			switch (axis) {
+			case 0:	return a.center.x() < b.center.x();
+			case 1:	return a.center.y() < b.center.y();
+			}
+			return a.center.z() < b.center.z();
+		});
+	int	left = build(first, half);
+	int	right = build(first + half, count - half);
+	_nodes[index].left = left;
+	_nodes[index].right = right;
+	return index;
+}
+
+/**
+ * \brief Find the squared distance of the nearest primitive below a node
+ *
+ * best is the smallest squared distance found so far, subtrees whose box
+ * is farther away are skipped.
+ */
+void	MeshDistanceField::nearest(int n, const point& p, double& best) const {
+	const node&	nd = _nodes[n];
+	double	d = bounds(p).distance(nd.box);
+	if (d * d >= best) {
+		return;
+	}
+	if (nd.left < 0) {
+		for (int i = nd.first; i < nd.first + nd.count; i++) {
+			const primitive&	t = _primitives[i];
+			double	d2;
+			if (t.segment) {
+				d2 = std::min(segment_distance2(p, t.a, t.b),
+					std::min(segment_distance2(p, t.b, t.c),
+					segment_distance2(p, t.c, t.a)));
+			} else {
+				d2 = triangle_distance2(p, t.a, t.b, t.c);
+			}
+			best = std::min(best, d2);
+		}
+		return;
+	}
+	double	dl = bounds(p).distance(_nodes[nd.left].box);
+	double	dr = bounds(p).distance(_nodes[nd.right].box);
+	if (dl <= dr) {
+		nearest(nd.left, p, best);
+		nearest(nd.right, p, best);
+	} else {
+		nearest(nd.right, p, best);
+		nearest(nd.left, p, best);
+	}
+}
+
+double	MeshDistanceField::operator()(const point& p) const {
+	if (_nodes.size() == 0) {
+		return std::numeric_limits<double>::infinity();
+	}
+	double	best = std::numeric_limits<double>::infinity();
+	nearest(0, p, best);
+	return sqrt(best) - _offset;
+}
+
+bounds	MeshDistanceField::box() const {
+	if (_nodes.size() == 0) {
+		return bounds();
+	}
+	const bounds&	b = _nodes[0].box;
+	vector	o(_offset, _offset, _offset);
+	return bounds(b.min() - o, b.max() + o);
+}
+
+//////////////////////////////////////////////////////////////////////
+// BoxDistanceField implementation
+//////////////////////////////////////////////////////////////////////
+
+double	BoxDistanceField::operator()(const point& p) const {
+	point	c = _box.center();
+	vector	e = _box.extent();
+	double	qx = fabs(p.x() - c.x()) - e.x() / 2;
+	double	qy = fabs(p.y() - c.y()) - e.y() / 2;
+	double	qz = fabs(p.z() - c.z()) - e.z() / 2;
+	double	inside = std::min(0., std::max(qx, std::max(qy, qz)));
+	qx = std::max(qx, 0.);
+	qy = std::max(qy, 0.);
+	qz = std::max(qz, 0.);
+	return sqrt(qx * qx + qy * qy + qz * qz) + inside;
+}
+
+//////////////////////////////////////////////////////////////////////
+// CSG operations
+//////////////////////////////////////////////////////////////////////
+
+UnionDistanceField::UnionDistanceField(
+		const std::vector<distancefield_ptr>& operands)
+		: _operands(operands) {
+	for (size_t i = 0; i < _operands.size(); i++) {
+		_boxes.push_back(_operands[i]->box());
+		_box.add(_boxes.back());
+	}
+}
+
+/**
+ * \brief Minimum of the operands
+ *
+ * The operand with the nearest box is evaluated first, operands whose
+ * box is farther away than the smallest value found so far cannot be
+ * smaller and are skipped.
+ */
+double	UnionDistanceField::operator()(const point& p) const {
+	double	best = std::numeric_limits<double>::infinity();
+	std::vector<double>	lower(_operands.size());
+	size_t	nearest = 0;
+	bounds	b(p);
+	for (size_t i = 0; i < _operands.size(); i++) {
+		lower[i] = (_boxes[i].empty())
+			? std::numeric_limits<double>::infinity()
+			: b.distance(_boxes[i]);
+		if (lower[i] < lower[nearest]) {
+			nearest = i;
+		}
+	}
+	if (_operands.size() == 0) {
+		return best;
+	}
+	best = (*_operands[nearest])(p);
+	for (size_t i = 0; i < _operands.size(); i++) {
+		if ((i != nearest) && (lower[i] < best)) {
+			best = std::min(best, (*_operands[i])(p));
+		}
+	}
+	return best;
+}
+
+double	IntersectionDistanceField::operator()(const point& p) const {
+	return std::max((*_a)(p), (*_b)(p));
+}
+
+/**
+ * \brief Box of an intersection
+ *
+ * The value is at least the distance from either box, but not always
+ * the distance from the intersection of the boxes, so the smaller of
+ * the two boxes is used.
+ */
+bounds	IntersectionDistanceField::box() const {
+	bounds	a = _a->box();
+	bounds	b = _b->box();
+	vector	ea = a.extent(), eb = b.extent();
+	return (ea.x() * ea.y() * ea.z() <= eb.x() * eb.y() * eb.z()) ? a : b;
+}
+
+double	DifferenceDistanceField::operator()(const point& p) const {
+	return std::max((*_a)(p), -(*_b)(p));
+}
+
+//////////////////////////////////////////////////////////////////////
+// fields of primitives
+//////////////////////////////////////////////////////////////////////
+
+typedef std::function<point(double, double)>	parametrization;
+
+/**
+ * \brief Field of a sheet from a triangulation of its middle surface
+ */
+static distancefield_ptr	grid_sheet(const parametrization& f,
+	const Interval& urange, const Interval& vrange, int usteps,
+	int vsteps, double thickness) {
+	std::vector<point>	points;
+	double	du = urange.length() / usteps;
+	double	dv = vrange.length() / vsteps;
+	for (int u = 0; u <= usteps; u++) {
+		for (int v = 0; v <= vsteps; v++) {
+			points.push_back(f(urange.min() + u * du,
+				vrange.min() + v * dv));
+		}
+	}
+	std::vector<int>	triangles;
+	for (int u = 0; u < usteps; u++) {
+		for (int v = 0; v < vsteps; v++) {
+			int	a = u * (vsteps + 1) + v;
+			int	b = a + vsteps + 1;
+			triangles.push_back(a);
+			triangles.push_back(b);
+			triangles.push_back(a + 1);
+			triangles.push_back(a + 1);
+			triangles.push_back(b);
+			triangles.push_back(b + 1);
+		}
+	}
+	return std::make_shared<const MeshDistanceField>(points, triangles,
+		std::vector<int>(), thickness / 2);
+}
+
+/**
+ * \brief Field of a sheet of the graph of a function
+ *
+ * thickness is the total thickness of the sheet.
+ */
+distancefield_ptr	sheet_field(Function& f,
+	const CartesianDomain& domain, int xsteps, int ysteps,
+	double thickness) {
+	return grid_sheet([&f](double x, double y) {
+			return point(x, y, f(x, y));
+		}, domain.xrange(), domain.yrange(), xsteps, ysteps, thickness);
+}
+
+distancefield_ptr	sheet_field(const PointFunction& f,
+	const CartesianDomain& domain, int xsteps, int ysteps,
+	double thickness) {
+	return grid_sheet([&f](double x, double y) { return f.p(x, y); },
+		domain.xrange(), domain.yrange(), xsteps, ysteps, thickness);
+}
+
+distancefield_ptr	sheet_field(Function& f,
+	const PolarDomain& domain, int rsteps, int phisteps,
+	double thickness) {
+	return grid_sheet([&f](double r, double phi) {
+			return point(r * cos(phi), r * sin(phi), f(r, phi));
+		}, domain.rrange(), domain.phirange(), rsteps, phisteps,
+		thickness);
+}
+
+distancefield_ptr	sheet_field(const PointFunction& f,
+	const PolarDomain& domain, int rsteps, int phisteps,
+	double thickness) {
+	return grid_sheet([&f](double r, double phi) { return f.p(r, phi); },
+		domain.rrange(), domain.phirange(), rsteps, phisteps,
+		thickness);
+}
+
+/**
+ * \brief Field of a tube of a curve, with round ends
+ */
+distancefield_ptr	tube_field(const CurveFunction& f,
+	const Interval& interval, int steps, double radius) {
+	std::vector<point>	points;
+	std::vector<int>	segments;
+	double	dt = interval.length() / steps;
+	for (int t = 0; t <= steps; t++) {
+		points.push_back(f.position(interval.min() + t * dt));
+		if (t > 0) {
+			segments.push_back(t - 1);
+			segments.push_back(t);
+		}
+	}
+	return std::make_shared<const MeshDistanceField>(points,
+		std::vector<int>(), segments, radius);
+}
+
+distancefield_ptr	box_field(const bounds& box) {
+	return std::make_shared<const BoxDistanceField>(box);
+}
+
+distancefield_ptr	union_field(
+	const std::vector<distancefield_ptr>& operands) {
+	return std::make_shared<const UnionDistanceField>(operands);
+}
+
+distancefield_ptr	intersection_field(distancefield_ptr a,
+	distancefield_ptr b) {
+	return std::make_shared<const IntersectionDistanceField>(a, b);
+}
+
+distancefield_ptr	difference_field(distancefield_ptr a,
+	distancefield_ptr b) {
+	return std::make_shared<const DifferenceDistanceField>(a, b);
+}
+
+} // namespace csg
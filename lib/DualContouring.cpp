@@ -0,0 +1,83 @@
+/*
+ * DualContouring.cpp -- mesh the zero level set of a distance field
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <DualContouring.h>
+#include <Contouring.h>
+#include <debug.h>
+#include <math.h>
+
+namespace csg {
+
+/**
+ * \brief Contouring of a distance field
+ *
+ * As the field does not change faster than the distance, an octant can
+ * be skipped when the value at its center exceeds its half diagonal.
+ */
+class FieldContouring : public Contouring {
+	const DistanceField&	_field;
+protected:
+	virtual double	evaluate(const dcblock& b, int i, int j, int k) const {
+		return _field(gridpoint(i, j, k));
+	}
+	virtual vector	normal(const point& p) const {
+		return _field.gradient(p, _h / 16);
+	}
+	virtual bool	far(int i, int j, int k, int size) const;
+public:
+	FieldContouring(const DistanceField& field, const point& origin,
+		double h, int nx, int ny, int nz)
+		: Contouring(origin, h, nx, ny, nz), _field(field) { }
+};
+
+bool	FieldContouring::far(int i, int j, int k, int size) const {
+	double	half = size / 2.;
+	double	v = _field(gridpoint(i + half, j + half, k + half));
+	return fabs(v) > 1.01 * sqrt(3.) * half * _h;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Build_DistanceField implementation
+//////////////////////////////////////////////////////////////////////
+
+Build_DistanceField::Build_DistanceField(distancefield_ptr field,
+	const bounds& box, double resolution)
+	: _field(field), _box(box), _resolution(resolution) {
+}
+
+/**
+ * \brief Contour the field clipped to the box
+ *
+ * The grid covers the part of the box where the field may be negative,
+ * with a margin of one cell, so that the values on the boundary of the
+ * grid are positive and the surface is closed.
+ */
+void	Build_DistanceField::build() {
+	bounds	region = _box.intersection(_field->box());
+	if (region.empty()) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "field outside box");
+		return;
+	}
+	distancefield_ptr	clipped = intersection_field(_field,
+					box_field(_box));
+	double	h = _resolution;
+	point	origin = region.min() - vector(h, h, h);
+	vector	e = region.extent();
+	FieldContouring	contouring(*clipped, origin, h,
+		(int)ceil(e.x() / h) + 2, (int)ceil(e.y() / h) + 2,
+		(int)ceil(e.z() / h) + 2);
+	contouring.build();
+	int	n = contouring.number_of_vertices();
+	if (n == 0) {
+		return;
+	}
+	contouring.copy_vertices(append_vertices(n));
+	std::vector<int>	t = contouring.triangles();
+	for (size_t m = 0; m < t.size(); m += 3) {
+		add_facet(t[m], t[m + 1], t[m + 2]);
+	}
+}
+
+} // namespace csg
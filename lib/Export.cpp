@@ -0,0 +1,378 @@
+/*
+ * Export.cpp -- write meshes in binary STL and 3MF format
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Export.h>
+#include <BinaryBuffer.h>
+#include <Binary.h>
+#include <debug.h>
+#include <array>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <CGAL/IO/Polyhedron_iostream.h>
+
+namespace csg {
+
+output_format	format_from_string(const std::string& name) {
+	if (name == "off") {
+		return OFF_FORMAT;
+	}
+	if (name == "stl") {
+		return STL_FORMAT;
+	}
+	if (name == "3mf") {
+		return THREEMF_FORMAT;
+	}
+	if (name == "csgb") {
+		return CSGB_FORMAT;
+	}
+	throw std::runtime_error("unknown output format " + name);
+}
+
+std::string	format_extension(output_format format) {
+	switch (format) {
+	case OFF_FORMAT:	return std::string(".off");
+	case STL_FORMAT:	return std::string(".stl");
+	case THREEMF_FORMAT:	return std::string(".3mf");
+	case CSGB_FORMAT:	return std::string(".csgb");
+	}
+	return std::string("");
+}
+
+//////////////////////////////////////////////////////////////////////
+// binary STL
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Write a mesh as binary STL
+ */
+void	write_stl(std::ostream& out, const IndexedMesh& mesh) {
+	binarybuffer	b(out);
+	char	header[80];
+	memset(header, 0, sizeof(header));
+	strncpy(header, "binary STL written by libcsg", sizeof(header) - 1);
+	b.bytes(header, sizeof(header));
+	b.uint32(mesh.number_of_triangles());
+	for (int t = 0; t < mesh.number_of_triangles(); t++) {
+		point	p0 = mesh.vertex(mesh.triangles[3 * t    ]);
+		point	p1 = mesh.vertex(mesh.triangles[3 * t + 1]);
+		point	p2 = mesh.vertex(mesh.triangles[3 * t + 2]);
+		vector	n = vector(p0, p1).cross(vector(p0, p2));
+		double	l = n.norm();
+		if (l > 0) {
+			n = n / l;
+		}
+		b.float32(n.x()); b.float32(n.y()); b.float32(n.z());
+		b.float32(p0.x()); b.float32(p0.y()); b.float32(p0.z());
+		b.float32(p1.x()); b.float32(p1.y()); b.float32(p1.z());
+		b.float32(p2.x()); b.float32(p2.y()); b.float32(p2.z());
+		b.uint16(0);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// 3MF
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief CRC-32 of the zip format, computed incrementally
+ */
+class crc32 {
+	uint32_t	_crc;
+public:
+	crc32() : _crc(0xffffffff) { }
+	void	update(const char *data, size_t length) {
+		// initialization of a local static is thread safe, parts are
+		// written concurrently by PartWriter
+		static const std::array<uint32_t, 256>	table = []() {
+			std::array<uint32_t, 256>	t;
+			for (uint32_t i = 0; i < 256; i++) {
+				uint32_t	c = i;
+				for (int k = 0; k < 8; k++) {
+					c = (c & 1) ? (0xedb88320 ^ (c >> 1))
+						: (c >> 1);
+				}
+				t[i] = c;
+			}
+			return t;
+		}();
+		for (size_t i = 0; i < length; i++) {
+			_crc = table[(_crc ^ (uint8_t)data[i]) & 0xff]
+				^ (_crc >> 8);
+		}
+	}
+	uint32_t	value() const { return _crc ^ 0xffffffff; }
+};
+
+/**
+ * \brief Minimal zip archive writer, storing the entries uncompressed
+ *
+ * Entries are streamed: the data of an entry is written as it is passed
+ * to write(), while its checksum and size are accumulated. They follow
+ * the data in a data descriptor, as indicated by bit 3 of the flags, and
+ * are repeated in the central directory.
+ */
+class zipwriter {
+	binarybuffer	_b;
+	uint64_t	_offset;
+	class entry {
+	public:
+		std::string	name;
+		uint32_t	crc, size, offset;
+	};
+	std::vector<entry>	_entries;
+	entry	_current;
+	crc32	_crc;
+	uint64_t	_size;
+	static const uint16_t	flags = 0x0008;	// data descriptor follows
+public:
+	zipwriter(std::ostream& out) : _b(out), _offset(0), _size(0) { }
+	void	begin(const std::string& name) {
+		if (_offset > 0xffffffff) {
+			throw std::runtime_error("zip archive too large");
+		}
+		_current.name = name;
+		_current.offset = _offset;
+		_crc = crc32();
+		_size = 0;
+		_b.uint32(0x04034b50);	// local file header signature
+		_b.uint16(20);		// version needed
+		_b.uint16(flags);
+		_b.uint16(0);		// method: stored
+		_b.uint16(0);		// time
+		_b.uint16(0x21);	// date: 1980-01-01
+		_b.uint32(0);		// crc, in the data descriptor
+		_b.uint32(0);		// compressed size
+		_b.uint32(0);		// uncompressed size
+		_b.uint16(name.size());
+		_b.uint16(0);		// extra field length
+		_b.bytes(name.data(), name.size());
+		_offset += 30 + name.size();
+	}
+	void	write(const char *data, size_t length) {
+		_crc.update(data, length);
+		_b.bytes(data, length);
+		_size += length;
+	}
+	void	end() {
+		if (_size > 0xffffffff) {
+			throw std::runtime_error("zip entry too large");
+		}
+		_current.crc = _crc.value();
+		_current.size = _size;
+		_b.uint32(0x08074b50);	// data descriptor signature
+		_b.uint32(_current.crc);
+		_b.uint32(_current.size);
+		_b.uint32(_current.size);
+		_offset += _size + 16;
+		_entries.push_back(_current);
+	}
+	void	add(const std::string& name, const std::string& data) {
+		begin(name);
+		write(data.data(), data.size());
+		end();
+	}
+	void	close() {
+		if (_offset > 0xffffffff) {
+			throw std::runtime_error("zip archive too large");
+		}
+		uint32_t	start = _offset;
+		uint32_t	length = 0;
+		for (size_t i = 0; i < _entries.size(); i++) {
+			const entry&	e = _entries[i];
+			_b.uint32(0x02014b50);	// central directory signature
+			_b.uint16(20);		// version made by
+			_b.uint16(20);		// version needed
+			_b.uint16(flags);
+			_b.uint16(0);		// method: stored
+			_b.uint16(0);		// time
+			_b.uint16(0x21);	// date
+			_b.uint32(e.crc);
+			_b.uint32(e.size);
+			_b.uint32(e.size);
+			_b.uint16(e.name.size());
+			_b.uint16(0);		// extra field length
+			_b.uint16(0);		// comment length
+			_b.uint16(0);		// disk number
+			_b.uint16(0);		// internal attributes
+			_b.uint32(0);		// external attributes
+			_b.uint32(e.offset);
+			_b.bytes(e.name.data(), e.name.size());
+			length += 46 + e.name.size();
+		}
+		_b.uint32(0x06054b50);	// end of central directory
+		_b.uint16(0);
+		_b.uint16(0);
+		_b.uint16(_entries.size());
+		_b.uint16(_entries.size());
+		_b.uint32(length);
+		_b.uint32(start);
+		_b.uint16(0);
+		_b.flush();
+	}
+};
+
+static const char	*contenttypes =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/"
+	"content-types\">\n"
+	" <Default Extension=\"rels\" ContentType=\"application/"
+	"vnd.openxmlformats-package.relationships+xml\"/>\n"
+	" <Default Extension=\"model\" ContentType=\"application/"
+	"vnd.ms-package.3dmanufacturing-3dmodel+xml\"/>\n"
+	"</Types>\n";
+
+static const char	*relationships =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<Relationships xmlns=\"http://schemas.openxmlformats.org/package/"
+	"2006/relationships\">\n"
+	" <Relationship Target=\"/3D/3dmodel.model\" Id=\"rel0\" "
+	"Type=\"http://schemas.microsoft.com/3dmanufacturing/2013/01/"
+	"3dmodel\"/>\n"
+	"</Relationships>\n";
+
+/**
+ * \brief Write a mesh as a 3MF package
+ *
+ * The model is streamed into the package a line at a time, so it never
+ * has to be held in memory.
+ */
+void	write_3mf(std::ostream& out, const IndexedMesh& mesh) {
+	zipwriter	zip(out);
+	zip.add("[Content_Types].xml", contenttypes);
+	zip.add("_rels/.rels", relationships);
+	zip.begin("3D/3dmodel.model");
+	static const char	header[] =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<model unit=\"millimeter\" xmlns=\"http://schemas.microsoft.com/"
+		"3dmanufacturing/core/2015/02\">\n"
+		" <resources>\n"
+		"  <object id=\"1\" type=\"model\">\n"
+		"   <mesh>\n"
+		"    <vertices>\n";
+	zip.write(header, sizeof(header) - 1);
+	char	line[128];
+	for (int i = 0; i < mesh.number_of_vertices(); i++) {
+		int	length = snprintf(line, sizeof(line),
+			"     <vertex x=\"%.7g\" y=\"%.7g\" z=\"%.7g\"/>\n",
+			mesh.vertices[3 * i], mesh.vertices[3 * i + 1],
+			mesh.vertices[3 * i + 2]);
+		zip.write(line, length);
+	}
+	static const char	middle[] =
+		"    </vertices>\n"
+		"    <triangles>\n";
+	zip.write(middle, sizeof(middle) - 1);
+	for (int t = 0; t < mesh.number_of_triangles(); t++) {
+		int	length = snprintf(line, sizeof(line),
+			"     <triangle v1=\"%d\" v2=\"%d\" v3=\"%d\"/>\n",
+			mesh.triangles[3 * t], mesh.triangles[3 * t + 1],
+			mesh.triangles[3 * t + 2]);
+		zip.write(line, length);
+	}
+	static const char	trailer[] =
+		"    </triangles>\n"
+		"   </mesh>\n"
+		"  </object>\n"
+		" </resources>\n"
+		" <build>\n"
+		"  <item objectid=\"1\"/>\n"
+		" </build>\n"
+		"</model>\n";
+	zip.write(trailer, sizeof(trailer) - 1);
+	zip.end();
+	zip.close();
+}
+
+//////////////////////////////////////////////////////////////////////
+// file output
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Open a file, let the writer fill it and check that it was written
+ *
+ * A full disk must not leave a truncated file behind without an error.
+ */
+static void	write_file(const std::string& filename,
+			const std::function<void(std::ostream&)>& writer) {
+	std::ofstream	out(filename.c_str(), std::ios::out | std::ios::binary);
+	if (!out) {
+		throw std::runtime_error("cannot open " + filename);
+	}
+	writer(out);
+	out.close();
+	if (!out) {
+		throw std::runtime_error("cannot write " + filename);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s written", filename.c_str());
+}
+
+/**
+ * \brief Write a mesh as OFF, with all digits of the coordinates
+ */
+static void	write_off(std::ostream& out, const IndexedMesh& mesh) {
+	out.precision(std::numeric_limits<double>::max_digits10);
+	out << "OFF\n";
+	out << mesh.number_of_vertices() << " "
+		<< mesh.number_of_triangles() << " 0\n";
+	for (int i = 0; i < mesh.number_of_vertices(); i++) {
+		out << mesh.vertices[3 * i] << " "
+			<< mesh.vertices[3 * i + 1] << " "
+			<< mesh.vertices[3 * i + 2] << "\n";
+	}
+	for (int t = 0; t < mesh.number_of_triangles(); t++) {
+		out << "3 " << mesh.triangles[3 * t] << " "
+			<< mesh.triangles[3 * t + 1] << " "
+			<< mesh.triangles[3 * t + 2] << "\n";
+	}
+}
+
+void	write_mesh(const std::string& filename, const IndexedMesh& mesh,
+		output_format format) {
+	write_file(filename, [&mesh, format](std::ostream& out) {
+		switch (format) {
+		case OFF_FORMAT:
+			write_off(out, mesh);
+			break;
+		case STL_FORMAT:
+			write_stl(out, mesh);
+			break;
+		case THREEMF_FORMAT:
+			write_3mf(out, mesh);
+			break;
+		case CSGB_FORMAT:
+			write_binary(out, mesh);
+			break;
+		}
+	});
+}
+
+/**
+ * \brief Write a polyhedron, OFF uses the CGAL writer
+ *
+ * CSGB writes the exact coordinates of the polyhedron, OFF all digits of
+ * their double approximations.
+ */
+void	write_polyhedron(const std::string& filename, const Polyhedron& p,
+		output_format format) {
+	if (format == OFF_FORMAT) {
+		write_file(filename, [&p](std::ostream& out) {
+			out.precision(std::numeric_limits<double>::max_digits10);
+			out << p;
+		});
+		return;
+	}
+	if (format == CSGB_FORMAT) {
+		write_binary(filename, p);
+		return;
+	}
+	write_mesh(filename, IndexedMesh(p), format);
+}
+
+} // namespace csg
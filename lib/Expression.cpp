@@ -0,0 +1,962 @@
+/*
+ * Expression.cpp -- deferred CSG expressions and their evaluation
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Expression.h>
+#include <Box.h>
+#include <ThreadPool.h>
+#include <Union.h>
+#include <debug.h>
+#include <CGAL/Aff_transformation_3.h>
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace csg {
+
+/**
+ * \brief Node of the expression graph
+ *
+ * Nodes are never modified once they are part of a graph, the planner
+ * builds new nodes instead. The builders are held by shared pointers,
+ * so that rewritten leaves can still be recognized as the same leaf.
+ */
+class Expression::node {
+public:
+	node_type	type;
+	std::string	name;
+	std::shared_ptr<const builder_type>	builder;
+	std::shared_ptr<const mesh_builder_type>	meshbuilder;
+	bool	transformed;
+	Aff_transformation	transformation;
+	bounds	box;
+	std::vector<nodeptr>	operands;
+	node(node_type _type)
+		: type(_type), transformed(false),
+		  transformation(CGAL::IDENTITY) { }
+};
+
+typedef Expression::node	node;
+typedef Expression::nodeptr	nodeptr;
+
+//////////////////////////////////////////////////////////////////////
+// construction
+//////////////////////////////////////////////////////////////////////
+
+static nodeptr	empty_node() {
+	static nodeptr	empty(new node(Expression::EMPTY_NODE));
+	return empty;
+}
+
+static nodeptr	inner_node(Expression::node_type type,
+			const std::vector<nodeptr>& operands) {
+	node	*n = new node(type);
+	n->operands = operands;
+	return nodeptr(n);
+}
+
+static nodeptr	box_node(const bounds& box) {
+	if (box.empty()) {
+		return empty_node();
+	}
+	node	*n = new node(Expression::BOX_NODE);
+	n->box = box;
+	return nodeptr(n);
+}
+
+static nodeptr	clip_node(const nodeptr& operand, const bounds& box) {
+	node	*n = new node(Expression::CLIP_NODE);
+	n->box = box;
+	n->operands.push_back(operand);
+	return nodeptr(n);
+}
+
+static nodeptr	transform_node(const nodeptr& operand,
+			const Aff_transformation& t) {
+	node	*n = new node(Expression::TRANSFORM_NODE);
+	n->transformation = t;
+	n->operands.push_back(operand);
+	return nodeptr(n);
+}
+
+Expression::Expression() : _node(empty_node()) {
+}
+
+Expression::node_type	Expression::type() const {
+	return _node->type;
+}
+
+Expression	Expression::leaf(const std::string& name,
+			const builder_type& builder) {
+	return leaf(name, builder, bounds());
+}
+
+/**
+ * \brief Leaf with a bounding box known in advance
+ *
+ * The box must contain the result of the builder, it allows the planner
+ * to drop the leaf without building it.
+ */
+Expression	Expression::leaf(const std::string& name,
+			const builder_type& builder, const bounds& box) {
+	node	*n = new node(LEAF_NODE);
+	n->name = name;
+	n->builder = std::make_shared<const builder_type>(builder);
+	n->box = box;
+	return Expression(nodeptr(n));
+}
+
+Expression	Expression::mesh(const std::string& name,
+			const mesh_builder_type& builder) {
+	node	*n = new node(MESH_NODE);
+	n->name = name;
+	n->meshbuilder = std::make_shared<const mesh_builder_type>(builder);
+	return Expression(nodeptr(n));
+}
+
+Expression	Expression::box(const point& a, const point& b) {
+	return Expression(box_node(bounds(a, b)));
+}
+
+Expression	Expression::operator+(const Expression& other) const {
+	return Expression(inner_node(UNION_NODE, { _node, other.root() }));
+}
+
+Expression	Expression::operator*(const Expression& other) const {
+	return Expression(inner_node(INTERSECTION_NODE,
+		{ _node, other.root() }));
+}
+
+Expression	Expression::operator-(const Expression& other) const {
+	return Expression(inner_node(DIFFERENCE_NODE,
+		{ _node, other.root() }));
+}
+
+Expression	Expression::transform(const Aff_transformation& t) const {
+	return Expression(transform_node(_node, t));
+}
+
+Expression	Expression::clip(const bounds& box) const {
+	return Expression(clip_node(_node, box));
+}
+
+//////////////////////////////////////////////////////////////////////
+// description
+//////////////////////////////////////////////////////////////////////
+
+static std::string	boxstring(const bounds& box) {
+	char	buffer[256];
+	snprintf(buffer, sizeof(buffer), "[(%g,%g,%g),(%g,%g,%g)]",
+		box.min().x(), box.min().y(), box.min().z(),
+		box.max().x(), box.max().y(), box.max().z());
+	return std::string(buffer);
+}
+
+static std::string	nodestring(const nodeptr& n) {
+	std::string	result;
+	switch (n->type) {
+	case Expression::EMPTY_NODE:
+		return std::string("empty");
+	case Expression::LEAF_NODE:
+		return n->name;
+	case Expression::MESH_NODE:
+		return n->name + ((n->transformed) ? "'" : "");
+	case Expression::BOX_NODE:
+		return std::string("box") + boxstring(n->box);
+	case Expression::UNION_NODE:
+		result = "union";
+		break;
+	case Expression::INTERSECTION_NODE:
+		result = "intersection";
+		break;
+	case Expression::DIFFERENCE_NODE:
+		result = "difference";
+		break;
+	case Expression::TRANSFORM_NODE:
+		result = "transform";
+		break;
+	case Expression::CLIP_NODE:
+		result = std::string("clip") + boxstring(n->box);
+		break;
+	}
+	result += "(";
+	for (size_t i = 0; i < n->operands.size(); i++) {
+		if (i > 0) {
+			result += ", ";
+		}
+		result += nodestring(n->operands[i]);
+	}
+	return result + ")";
+}
+
+std::string	Expression::str() const {
+	return nodestring(_node);
+}
+
+//////////////////////////////////////////////////////////////////////
+// bounding boxes
+//////////////////////////////////////////////////////////////////////
+
+static bounds	transform_bounds(const bounds& box,
+			const Aff_transformation& t) {
+	bounds	result;
+	for (int corner = 0; corner < 8; corner++) {
+		Point	p((corner & 1) ? box.max().x() : box.min().x(),
+			(corner & 2) ? box.max().y() : box.min().y(),
+			(corner & 4) ? box.max().z() : box.min().z());
+		Point	q = t.transform(p);
+		result.add(point(CGAL::to_double(q.x()),
+			CGAL::to_double(q.y()), CGAL::to_double(q.z())));
+	}
+	return result;
+}
+
+/**
+ * \brief Bounding box of a node known without evaluating it
+ *
+ * Returns false if the box is not known. The box of an empty node is
+ * known and empty. Only leaves with a box given in advance are known to
+ * be bounded, any other leaf may be unbounded, e.g. a half space, so its
+ * box is not known.
+ */
+static bool	known_bounds(const nodeptr& n, bounds& box) {
+	box = bounds();
+	switch (n->type) {
+	case Expression::EMPTY_NODE:
+		return true;
+	case Expression::LEAF_NODE:
+		box = n->box;
+		return !box.empty();
+	case Expression::MESH_NODE:
+		return false;
+	case Expression::BOX_NODE:
+		box = n->box;
+		return true;
+	case Expression::UNION_NODE:
+		for (size_t i = 0; i < n->operands.size(); i++) {
+			bounds	b;
+			if (!known_bounds(n->operands[i], b)) {
+				return false;
+			}
+			box.add(b);
+		}
+		return true;
+	case Expression::INTERSECTION_NODE: {
+		bool	known = false;
+		for (size_t i = 0; i < n->operands.size(); i++) {
+			bounds	b;
+			if (known_bounds(n->operands[i], b)) {
+				box = (known) ? box.intersection(b) : b;
+				known = true;
+			}
+		}
+		return known;
+		}
+	case Expression::DIFFERENCE_NODE:
+		return known_bounds(n->operands[0], box);
+	case Expression::TRANSFORM_NODE:
+		if (!known_bounds(n->operands[0], box)) {
+			return false;
+		}
+		if (!box.empty()) {
+			box = transform_bounds(box, n->transformation);
+		}
+		return true;
+	case Expression::CLIP_NODE:
+		if (known_bounds(n->operands[0], box)) {
+			box = box.intersection(n->box);
+		} else {
+			box = n->box;
+		}
+		return true;
+	}
+	return false;
+}
+
+/**
+ * \brief Find out whether two nodes certainly have no point in common
+ */
+static bool	disjoint(const nodeptr& a, const bounds& box) {
+	bounds	b;
+	if (!known_bounds(a, b)) {
+		return false;
+	}
+	return !b.overlaps(box);
+}
+
+//////////////////////////////////////////////////////////////////////
+// planner
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Rewriting an expression graph into an evaluation plan
+ *
+ * Simplified nodes are remembered, so that shared subgraphs are only
+ * rewritten once and stay shared in the plan.
+ */
+class Planner {
+	std::map<const node *, nodeptr>	_simplified;
+	nodeptr	simplify_union(const nodeptr& n);
+	nodeptr	simplify_intersection(const nodeptr& n);
+	nodeptr	simplify_difference(const nodeptr& n);
+	nodeptr	make_union(const std::vector<nodeptr>& operands);
+	nodeptr	make_difference(const nodeptr& a,
+			const std::vector<nodeptr>& subtrahends);
+public:
+	nodeptr	simplify(const nodeptr& n);
+	nodeptr	clip(const nodeptr& n, const bounds& box);
+	nodeptr	transform(const nodeptr& n, const Aff_transformation& t);
+};
+
+nodeptr	Planner::simplify(const nodeptr& n) {
+	std::map<const node *, nodeptr>::const_iterator	i
+		= _simplified.find(n.get());
+	if (i != _simplified.end()) {
+		return i->second;
+	}
+	nodeptr	result = n;
+	switch (n->type) {
+	case Expression::UNION_NODE:
+		result = simplify_union(n);
+		break;
+	case Expression::INTERSECTION_NODE:
+		result = simplify_intersection(n);
+		break;
+	case Expression::DIFFERENCE_NODE:
+		result = simplify_difference(n);
+		break;
+	case Expression::TRANSFORM_NODE:
+		result = transform(simplify(n->operands[0]), n->transformation);
+		break;
+	case Expression::CLIP_NODE:
+		result = clip(simplify(n->operands[0]), n->box);
+		break;
+	default:
+		break;
+	}
+	_simplified[n.get()] = result;
+	return result;
+}
+
+/**
+ * \brief Union of operands, splicing nested unions and dropping empties
+ */
+nodeptr	Planner::make_union(const std::vector<nodeptr>& operands) {
+	std::vector<nodeptr>	flat;
+	for (size_t i = 0; i < operands.size(); i++) {
+		const nodeptr&	o = operands[i];
+		if (o->type == Expression::EMPTY_NODE) {
+			continue;
+		}
+		if (o->type == Expression::UNION_NODE) {
+			flat.insert(flat.end(), o->operands.begin(),
+				o->operands.end());
+		} else {
+			flat.push_back(o);
+		}
+	}
+	if (flat.size() == 0) {
+		return empty_node();
+	}
+	if (flat.size() == 1) {
+		return flat[0];
+	}
+	return inner_node(Expression::UNION_NODE, flat);
+}
+
+nodeptr	Planner::simplify_union(const nodeptr& n) {
+	std::vector<nodeptr>	operands;
+	for (size_t i = 0; i < n->operands.size(); i++) {
+		operands.push_back(simplify(n->operands[i]));
+	}
+	return make_union(operands);
+}
+
+/**
+ * \brief Simplify an intersection
+ *
+ * All boxes among the operands are intersected into a single clip box,
+ * which is pushed into the first of the remaining operands. If the
+ * known boxes of two operands are disjoint, the intersection is empty.
+ */
+nodeptr	Planner::simplify_intersection(const nodeptr& n) {
+	std::vector<nodeptr>	operands;
+	bounds	clipbox;
+	bool	clipping = false;
+	std::vector<nodeptr>	pending(n->operands);
+	while (pending.size() > 0) {
+		nodeptr	o = simplify(pending.back());
+		pending.pop_back();
+		switch (o->type) {
+		case Expression::EMPTY_NODE:
+			return empty_node();
+		case Expression::INTERSECTION_NODE:
+			pending.insert(pending.end(), o->operands.begin(),
+				o->operands.end());
+			break;
+		case Expression::BOX_NODE:
+			clipbox = (clipping) ? clipbox.intersection(o->box)
+						: o->box;
+			clipping = true;
+			if (clipbox.empty()) {
+				return empty_node();
+			}
+			break;
+		default:
+			operands.insert(operands.begin(), o);
+			break;
+		}
+	}
+	if (operands.size() == 0) {
+		return box_node(clipbox);
+	}
+	if (clipping) {
+		operands[0] = clip(operands[0], clipbox);
+		if (operands[0]->type == Expression::EMPTY_NODE) {
+			return empty_node();
+		}
+	}
+	for (size_t i = 0; i < operands.size(); i++) {
+		bounds	bi;
+		if (!known_bounds(operands[i], bi)) {
+			continue;
+		}
+		for (size_t j = i + 1; j < operands.size(); j++) {
+			if (disjoint(operands[j], bi)) {
+				return empty_node();
+			}
+		}
+	}
+	if (operands.size() == 1) {
+		return operands[0];
+	}
+	return inner_node(Expression::INTERSECTION_NODE, operands);
+}
+
+/**
+ * \brief Difference of a node and the union of the subtrahends
+ *
+ * Subtrahends known to be disjoint from the minuend are dropped.
+ */
+nodeptr	Planner::make_difference(const nodeptr& a,
+		const std::vector<nodeptr>& subtrahends) {
+	if (a->type == Expression::EMPTY_NODE) {
+		return empty_node();
+	}
+	bounds	abox;
+	bool	known = known_bounds(a, abox);
+	std::vector<nodeptr>	operands;
+	operands.push_back(a);
+	for (size_t i = 0; i < subtrahends.size(); i++) {
+		const nodeptr&	s = subtrahends[i];
+		if (s->type == Expression::EMPTY_NODE) {
+			continue;
+		}
+		if (s->type == Expression::UNION_NODE) {
+			operands.insert(operands.end(), s->operands.begin(),
+				s->operands.end());
+		} else {
+			operands.push_back(s);
+		}
+	}
+	if (known) {
+		std::vector<nodeptr>	kept;
+		kept.push_back(a);
+		for (size_t i = 1; i < operands.size(); i++) {
+			if (!disjoint(operands[i], abox)) {
+				kept.push_back(operands[i]);
+			}
+		}
+		operands.swap(kept);
+	}
+	if (operands.size() == 1) {
+		return a;
+	}
+	return inner_node(Expression::DIFFERENCE_NODE, operands);
+}
+
+nodeptr	Planner::simplify_difference(const nodeptr& n) {
+	nodeptr	a = simplify(n->operands[0]);
+	std::vector<nodeptr>	subtrahends;
+	if (a->type == Expression::DIFFERENCE_NODE) {
+		subtrahends.insert(subtrahends.end(), a->operands.begin() + 1,
+			a->operands.end());
+		a = a->operands[0];
+	}
+	for (size_t i = 1; i < n->operands.size(); i++) {
+		subtrahends.push_back(simplify(n->operands[i]));
+	}
+	return make_difference(a, subtrahends);
+}
+
+/**
+ * \brief Push a clip to an axis aligned box down to the leaves
+ */
+nodeptr	Planner::clip(const nodeptr& n, const bounds& box) {
+	bounds	nbox;
+	if (known_bounds(n, nbox)) {
+		if (!nbox.overlaps(box)) {
+			return empty_node();
+		}
+		if (box.contains(nbox)) {
+			return n;
+		}
+	}
+	switch (n->type) {
+	case Expression::EMPTY_NODE:
+		return n;
+	case Expression::BOX_NODE:
+		return box_node(n->box.intersection(box));
+	case Expression::UNION_NODE: {
+		std::vector<nodeptr>	operands;
+		for (size_t i = 0; i < n->operands.size(); i++) {
+			operands.push_back(clip(n->operands[i], box));
+		}
+		return make_union(operands);
+		}
+	case Expression::INTERSECTION_NODE: {
+		std::vector<nodeptr>	operands(n->operands);
+		operands[0] = clip(operands[0], box);
+		if (operands[0]->type == Expression::EMPTY_NODE) {
+			return empty_node();
+		}
+		return inner_node(Expression::INTERSECTION_NODE, operands);
+		}
+	case Expression::DIFFERENCE_NODE: {
+		nodeptr	a = clip(n->operands[0], box);
+		std::vector<nodeptr>	subtrahends;
+		for (size_t i = 1; i < n->operands.size(); i++) {
+			if (!disjoint(n->operands[i], box)) {
+				subtrahends.push_back(n->operands[i]);
+			}
+		}
+		return make_difference(a, subtrahends);
+		}
+	case Expression::CLIP_NODE: {
+		bounds	common = n->box.intersection(box);
+		if (common.empty()) {
+			return empty_node();
+		}
+		return clip(n->operands[0], common);
+		}
+	default:
+		break;
+	}
+	return clip_node(n, box);
+}
+
+/**
+ * \brief Push a transformation down to the leaves
+ *
+ * Mesh leaves and boxes absorb the transformation, Nef leaves and clips
+ * keep a transformation node.
+ */
+nodeptr	Planner::transform(const nodeptr& n, const Aff_transformation& t) {
+	switch (n->type) {
+	case Expression::EMPTY_NODE:
+		return n;
+	case Expression::MESH_NODE: {
+		node	*m = new node(*n);
+		m->transformation = (n->transformed) ? t * n->transformation : t;
+		m->transformed = true;
+		return nodeptr(m);
+		}
+	case Expression::BOX_NODE: {
+		bounds	box = n->box;
+		node	*m = new node(Expression::MESH_NODE);
+		m->name = std::string("box") + boxstring(box);
+		m->meshbuilder = std::make_shared<const
+			Expression::mesh_builder_type>([box]() {
+				Build_Box	b(box.min(), box.max());
+				Polyhedron	p;
+				p.delegate(b);
+				return p;
+			});
+		m->transformation = t;
+		m->transformed = true;
+		return nodeptr(m);
+		}
+	case Expression::UNION_NODE:
+	case Expression::INTERSECTION_NODE:
+	case Expression::DIFFERENCE_NODE: {
+		std::vector<nodeptr>	operands;
+		for (size_t i = 0; i < n->operands.size(); i++) {
+			operands.push_back(transform(n->operands[i], t));
+		}
+		return inner_node(n->type, operands);
+		}
+	case Expression::TRANSFORM_NODE:
+		return transform(n->operands[0], t * n->transformation);
+	default:
+		break;
+	}
+	return transform_node(n, t);
+}
+
+Expression	Expression::plan() const {
+	Planner	planner;
+	return Expression(planner.simplify(_node));
+}
+
+//////////////////////////////////////////////////////////////////////
+// evaluation
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Result of the evaluation of a node
+ *
+ * The box is only meaningful for bounded results. Half spaces and other
+ * unbounded results have a box containing only their finite vertices, so
+ * none of the shortcuts based on boxes may be applied to them.
+ */
+class result {
+public:
+	Nef_polyhedron	nef;
+	bounds	box;
+	bool	empty;
+	bool	unbounded;
+	result() : empty(true), unbounded(false) { }
+	result(const Nef_polyhedron& _nef) : nef(_nef), unbounded(false) {
+		empty = nef.is_empty();
+		if (!empty) {
+			unbounded = csg::unbounded(nef);
+			if (!unbounded) {
+				box = bounding_box(nef);
+			}
+		}
+	}
+	bool	overlaps(const result& other) const {
+		return unbounded || other.unbounded || box.overlaps(other.box);
+	}
+};
+
+/**
+ * \brief State of the evaluation of a plan
+ *
+ * The values of leaves are kept by builder, so that a leaf appearing
+ * several times in the plan, e.g. once clipped and once transformed, is
+ * built only once. Inner nodes shared in the plan are evaluated once.
+ *
+ * Waiting for a task group executes other queued tasks, so a task must
+ * never wait for the value of a node another task may be computing: it
+ * could be the task's own caller further down the stack. Therefore the
+ * meshes are built first, and then the nodes are evaluated level by
+ * level, starting with the leaves, each node after all its operands.
+ * The nodes of a level are evaluated concurrently.
+ */
+class Evaluation {
+	std::map<const void *, Polyhedron>	_meshes;
+	std::map<const void *, result>	_results;
+	std::map<const void *, int>	_levels;
+	std::vector<std::vector<nodeptr> >	_schedule;
+	static const void	*key(const nodeptr& n);
+	int	collect(const nodeptr& n);
+	void	collect_mesh(const nodeptr& n);
+	const result&	value(const nodeptr& n) const;
+	Polyhedron	polyhedron(const nodeptr& n) const;
+	result	compute(const nodeptr& n) const;
+	std::vector<result>	operands(const nodeptr& n) const;
+	result	evaluate_union(const nodeptr& n) const;
+	result	evaluate_intersection(const nodeptr& n) const;
+	result	evaluate_difference(const nodeptr& n) const;
+	result	evaluate_clip(const nodeptr& n) const;
+public:
+	result	evaluate(const nodeptr& n);
+};
+
+/**
+ * \brief Key identifying the value of a node
+ */
+const void	*Evaluation::key(const nodeptr& n) {
+	return (n->type == Expression::LEAF_NODE)
+		? (const void *)n->builder.get() : (const void *)n.get();
+}
+
+/**
+ * \brief Find all nodes whose result is needed and their levels
+ *
+ * The level of a node is one more than the largest level of its
+ * operands. Mesh operands of unions are handed to the union as meshes,
+ * so only their mesh is needed, not their result.
+ */
+int	Evaluation::collect(const nodeptr& n) {
+	const void	*k = key(n);
+	std::map<const void *, int>::const_iterator	i = _levels.find(k);
+	if (i != _levels.end()) {
+		return i->second;
+	}
+	int	level = 0;
+	if (n->type == Expression::MESH_NODE) {
+		collect_mesh(n);
+	}
+	for (size_t j = 0; j < n->operands.size(); j++) {
+		const nodeptr&	o = n->operands[j];
+		if ((n->type == Expression::UNION_NODE)
+			&& (o->type == Expression::MESH_NODE)) {
+			collect_mesh(o);
+			continue;
+		}
+		level = std::max(level, collect(o) + 1);
+	}
+	_levels[k] = level;
+	_results[k] = result();
+	if ((int)_schedule.size() <= level) {
+		_schedule.resize(level + 1);
+	}
+	_schedule[level].push_back(n);
+	return level;
+}
+
+void	Evaluation::collect_mesh(const nodeptr& n) {
+	_meshes[n->meshbuilder.get()] = Polyhedron();
+}
+
+/**
+ * \brief Result of a node of a lower level
+ */
+const result&	Evaluation::value(const nodeptr& n) const {
+	std::map<const void *, result>::const_iterator	i
+		= _results.find(key(n));
+	if (i == _results.end()) {
+		throw std::logic_error("operand not evaluated");
+	}
+	return i->second;
+}
+
+/**
+ * \brief Polyhedron of a mesh leaf, transformed if necessary
+ */
+Polyhedron	Evaluation::polyhedron(const nodeptr& n) const {
+	std::map<const void *, Polyhedron>::const_iterator	i
+		= _meshes.find(n->meshbuilder.get());
+	if (i == _meshes.end()) {
+		throw std::logic_error("mesh not built");
+	}
+	Polyhedron	p(i->second);
+	if (n->transformed) {
+		std::transform(p.points_begin(), p.points_end(),
+			p.points_begin(), n->transformation);
+	}
+	return p;
+}
+
+/**
+ * \brief Evaluate a plan
+ *
+ * The map entries are all created before the tasks start, so that the
+ * tasks only assign values and never modify the maps themselves.
+ */
+result	Evaluation::evaluate(const nodeptr& n) {
+	collect(n);
+	{
+		TaskGroup	group;
+		std::map<const void *, Polyhedron>::iterator	m;
+		for (m = _meshes.begin(); m != _meshes.end(); m++) {
+			const Expression::mesh_builder_type	*builder
+				= (const Expression::mesh_builder_type *)m->first;
+			Polyhedron	*target = &m->second;
+			group.run([builder, target]() {
+				*target = (*builder)();
+			});
+		}
+		group.wait();
+	}
+	for (size_t level = 0; level < _schedule.size(); level++) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "evaluating %d nodes of level %d",
+			(int)_schedule[level].size(), (int)level);
+		TaskGroup	group;
+		for (size_t i = 0; i < _schedule[level].size(); i++) {
+			nodeptr	o = _schedule[level][i];
+			result	*target = &_results.find(key(o))->second;
+			group.run([this, o, target]() {
+				*target = compute(o);
+			});
+		}
+		group.wait();
+	}
+	return value(n);
+}
+
+/**
+ * \brief Collect the results of the operands of a node
+ */
+std::vector<result>	Evaluation::operands(const nodeptr& n) const {
+	std::vector<result>	results;
+	for (size_t i = 0; i < n->operands.size(); i++) {
+		results.push_back(value(n->operands[i]));
+	}
+	return results;
+}
+
+result	Evaluation::compute(const nodeptr& n) const {
+	switch (n->type) {
+	case Expression::EMPTY_NODE:
+		return result();
+	case Expression::LEAF_NODE:
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "building %s", n->name.c_str());
+		return result((*n->builder)());
+	case Expression::MESH_NODE: {
+		Polyhedron	p = polyhedron(n);
+		return result(Nef_polyhedron(p));
+		}
+	case Expression::BOX_NODE: {
+		Build_Box	b(n->box.min(), n->box.max());
+		Polyhedron	p;
+		p.delegate(b);
+		return result(Nef_polyhedron(p));
+		}
+	case Expression::UNION_NODE:
+		return evaluate_union(n);
+	case Expression::INTERSECTION_NODE:
+		return evaluate_intersection(n);
+	case Expression::DIFFERENCE_NODE:
+		return evaluate_difference(n);
+	case Expression::TRANSFORM_NODE: {
+		result	r = value(n->operands[0]);
+		if (r.empty) {
+			return r;
+		}
+		Nef_polyhedron	nef = r.nef;
+		nef.transform(n->transformation);
+		return result(nef);
+		}
+	case Expression::CLIP_NODE:
+		return evaluate_clip(n);
+	}
+	throw std::logic_error("unknown expression node");
+}
+
+/**
+ * \brief Union of the operands
+ *
+ * Mesh leaves are handed to the union as meshes, so that the ones with
+ * disjoint bounding boxes are converted together.
+ */
+result	Evaluation::evaluate_union(const nodeptr& n) const {
+	size_t	count = n->operands.size();
+	std::vector<Polyhedron>	meshes(count);
+	std::vector<result>	results(count);
+	for (size_t i = 0; i < count; i++) {
+		const nodeptr&	o = n->operands[i];
+		if (o->type == Expression::MESH_NODE) {
+			meshes[i] = polyhedron(o);
+		} else {
+			results[i] = value(o);
+		}
+	}
+	Parallel_nary_union	unioner;
+	for (size_t i = 0; i < count; i++) {
+		if (n->operands[i]->type == Expression::MESH_NODE) {
+			if (!meshes[i].empty()) {
+				unioner.add_polyhedron(meshes[i]);
+			}
+		} else if (!results[i].empty) {
+			unioner.add_polyhedron(results[i].nef);
+		}
+	}
+	if (unioner.size() == 0) {
+		return result();
+	}
+	return result(unioner.get_union());
+}
+
+/**
+ * \brief Intersection of the operands, smallest boxes first
+ *
+ * Unbounded operands come last.
+ */
+result	Evaluation::evaluate_intersection(const nodeptr& n) const {
+	std::vector<result>	results = operands(n);
+	for (size_t i = 0; i < results.size(); i++) {
+		if (results[i].empty) {
+			return result();
+		}
+		for (size_t j = 0; j < i; j++) {
+			if (!results[i].overlaps(results[j])) {
+				debug(LOG_DEBUG, DEBUG_LOG, 0,
+					"disjoint intersection operands");
+				return result();
+			}
+		}
+	}
+	std::sort(results.begin(), results.end(),
+		[](const result& a, const result& b) {
+			if (a.unbounded || b.unbounded) {
+				return b.unbounded && !a.unbounded;
+			}
+			vector	ea = a.box.extent();
+			vector	eb = b.box.extent();
+			return ea.x() * ea.y() * ea.z()
+				< eb.x() * eb.y() * eb.z();
+		});
+	Nef_polyhedron	nef = results[0].nef;
+	for (size_t i = 1; i < results.size(); i++) {
+		nef = nef * results[i].nef;
+		if (nef.is_empty()) {
+			return result();
+		}
+	}
+	return result(nef);
+}
+
+/**
+ * \brief Subtract the union of all subtrahends meeting the minuend
+ */
+result	Evaluation::evaluate_difference(const nodeptr& n) const {
+	std::vector<result>	results = operands(n);
+	if (results[0].empty) {
+		return result();
+	}
+	Parallel_nary_union	unioner;
+	for (size_t i = 1; i < results.size(); i++) {
+		if (!results[i].empty && results[i].overlaps(results[0])) {
+			unioner.add_polyhedron(results[i].nef);
+		}
+	}
+	if (unioner.size() == 0) {
+		return results[0];
+	}
+	return result(results[0].nef - unioner.get_union());
+}
+
+/**
+ * \brief Clip a result to a box, if the box does not contain it
+ */
+result	Evaluation::evaluate_clip(const nodeptr& n) const {
+	result	r = value(n->operands[0]);
+	if (r.empty) {
+		return r;
+	}
+	if (!r.unbounded) {
+		if (n->box.contains(r.box)) {
+			return r;
+		}
+		if (!n->box.overlaps(r.box)) {
+			return result();
+		}
+	}
+	Build_Box	b(n->box.min(), n->box.max());
+	Polyhedron	p;
+	p.delegate(b);
+	return result(r.nef * Nef_polyhedron(p));
+}
+
+/**
+ * \brief Plan and evaluate the expression
+ */
+Nef_polyhedron	Expression::evaluate() const {
+	Planner	planner;
+	nodeptr	plan = planner.simplify(_node);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "plan: %s", nodestring(plan).c_str());
+	Evaluation	evaluation;
+	result	r = evaluation.evaluate(plan);
+	if (r.empty) {
+		return Nef_polyhedron();
+	}
+	return r.nef;
+}
+
+} // namespace csg
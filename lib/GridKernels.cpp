@@ -0,0 +1,200 @@
+/*
+ * GridKernels.cpp -- vectorized vertex generation for grid surfaces
+ *
+ * The kernels process blocks of four grid points. The lane type below
+ * maps a block to one AVX register, to two SSE2 registers or to a plain
+ * array, whichever the compiler flags allow. No fused multiply add is
+ * used, so every variant rounds exactly like the scalar code.
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <GridKernels.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace csg {
+
+#if defined(__AVX__)
+
+typedef __m256d	lanes;
+
+static inline lanes	load(const double *a) { return _mm256_loadu_pd(a); }
+static inline void	store(double *a, lanes x) { _mm256_storeu_pd(a, x); }
+static inline lanes	broadcast(double a) { return _mm256_set1_pd(a); }
+static inline lanes	add(lanes a, lanes b) { return _mm256_add_pd(a, b); }
+static inline lanes	sub(lanes a, lanes b) { return _mm256_sub_pd(a, b); }
+static inline lanes	mul(lanes a, lanes b) { return _mm256_mul_pd(a, b); }
+
+const char	*grid_kernel_isa() { return "avx"; }
+
+#elif defined(__SSE2__)
+
+struct lanes {
+	__m128d	lo, hi;
+};
+
+static inline lanes	load(const double *a) {
+	lanes	result = { _mm_loadu_pd(a), _mm_loadu_pd(a + 2) };
+	return result;
+}
+static inline void	store(double *a, lanes x) {
+	_mm_storeu_pd(a, x.lo);
+	_mm_storeu_pd(a + 2, x.hi);
+}
+static inline lanes	broadcast(double a) {
+	lanes	result = { _mm_set1_pd(a), _mm_set1_pd(a) };
+	return result;
+}
+static inline lanes	add(lanes a, lanes b) {
+	lanes	result = { _mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi) };
+	return result;
+}
+static inline lanes	sub(lanes a, lanes b) {
+	lanes	result = { _mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi) };
+	return result;
+}
+static inline lanes	mul(lanes a, lanes b) {
+	lanes	result = { _mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi) };
+	return result;
+}
+
+const char	*grid_kernel_isa() { return "sse2"; }
+
+#else /* scalar fallback */
+
+struct lanes {
+	double	v[4];
+};
+
+static inline lanes	load(const double *a) {
+	lanes	result = { { a[0], a[1], a[2], a[3] } };
+	return result;
+}
+static inline void	store(double *a, lanes x) {
+	for (int k = 0; k < 4; k++) { a[k] = x.v[k]; }
+}
+static inline lanes	broadcast(double a) {
+	lanes	result = { { a, a, a, a } };
+	return result;
+}
+static inline lanes	add(lanes a, lanes b) {
+	for (int k = 0; k < 4; k++) { a.v[k] += b.v[k]; }
+	return a;
+}
+static inline lanes	sub(lanes a, lanes b) {
+	for (int k = 0; k < 4; k++) { a.v[k] -= b.v[k]; }
+	return a;
+}
+static inline lanes	mul(lanes a, lanes b) {
+	for (int k = 0; k < 4; k++) { a.v[k] *= b.v[k]; }
+	return a;
+}
+
+const char	*grid_kernel_isa() { return "scalar"; }
+
+#endif
+
+/**
+ * \brief Store the top and bottom vertex of a grid point
+ */
+static inline void	vertex_pair(double *v, double x, double y,
+				double ztop, double zbottom) {
+	v[0] = x; v[1] = y; v[2] = ztop;
+	v[3] = x; v[4] = y; v[5] = zbottom;
+}
+
+void	grid_coordinates(double min, double delta, int n, double *c) {
+	static const double	step[4] = { 0, 1, 2, 3 };
+	lanes	m = broadcast(min);
+	lanes	d = broadcast(delta);
+	lanes	s = load(step);
+	int	i = 0;
+	for (; i + 4 <= n; i += 4) {
+		store(c + i, add(m, mul(add(broadcast(i), s), d)));
+	}
+	for (; i < n; i++) {
+		c[i] = min + i * delta;
+	}
+}
+
+void	cartesian_vertices(double x, const double *y, const double *z,
+		int n, double offset, double *vertices) {
+	lanes	o = broadcast(offset);
+	double	top[4], bottom[4];
+	int	i = 0;
+	for (; i + 4 <= n; i += 4) {
+		lanes	zz = load(z + i);
+		store(top, add(zz, o));
+		store(bottom, sub(zz, o));
+		for (int k = 0; k < 4; k++) {
+			vertex_pair(vertices + 6 * (i + k), x, y[i + k],
+				top[k], bottom[k]);
+		}
+	}
+	for (; i < n; i++) {
+		vertex_pair(vertices + 6 * i, x, y[i],
+			z[i] + offset, z[i] - offset);
+	}
+}
+
+void	polar_vertices(double r, const double *cosphi, const double *sinphi,
+		const double *z, int n, double offset, double *vertices) {
+	lanes	rr = broadcast(r);
+	lanes	o = broadcast(offset);
+	double	x[4], y[4], top[4], bottom[4];
+	int	i = 0;
+	for (; i + 4 <= n; i += 4) {
+		store(x, mul(rr, load(cosphi + i)));
+		store(y, mul(rr, load(sinphi + i)));
+		lanes	zz = load(z + i);
+		store(top, add(zz, o));
+		store(bottom, sub(zz, o));
+		for (int k = 0; k < 4; k++) {
+			vertex_pair(vertices + 6 * (i + k), x[k], y[k],
+				top[k], bottom[k]);
+		}
+	}
+	for (; i < n; i++) {
+		vertex_pair(vertices + 6 * i, r * cosphi[i], r * sinphi[i],
+			z[i] + offset, z[i] - offset);
+	}
+}
+
+void	offset_vertices(const double *p, const double *v, int n,
+		double offset, double *vertices) {
+	lanes	o = broadcast(offset);
+	// four points are twelve coordinates, i.e. three blocks of lanes
+	double	top[12], bottom[12];
+	int	i = 0;
+	for (; i + 4 <= n; i += 4) {
+		for (int j = 0; j < 12; j += 4) {
+			lanes	pp = load(p + 3 * i + j);
+			lanes	vv = mul(o, load(v + 3 * i + j));
+			store(top + j, add(pp, vv));
+			store(bottom + j, sub(pp, vv));
+		}
+		for (int k = 0; k < 4; k++) {
+			double	*w = vertices + 6 * (i + k);
+			w[0] = top[3 * k];
+			w[1] = top[3 * k + 1];
+			w[2] = top[3 * k + 2];
+			w[3] = bottom[3 * k];
+			w[4] = bottom[3 * k + 1];
+			w[5] = bottom[3 * k + 2];
+		}
+	}
+	for (; i < n; i++) {
+		double	*w = vertices + 6 * i;
+		for (int k = 0; k < 3; k++) {
+			double	d = offset * v[3 * i + k];
+			w[k] = p[3 * i + k] + d;
+			w[3 + k] = p[3 * i + k] - d;
+		}
+	}
+}
+
+} // namespace csg
@@ -1,22 +1,118 @@
 /*
- * IcosahedralSphere.cpp -- Create a spherical mesh based 
+ * IcosahedralSphere.cpp -- geodesic sphere from a subdivided icosahedron
  *
  * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
 #include <IcosahedralSphere.h>
-
-#include <CGAL/Polyhedron_incremental_builder_3.h>
-#include <stdexcept>
+#include <debug.h>
+#include <cmath>
+#include <map>
 
 namespace csg {
 
-void	Build_IcosahedralSphere::operator()(Polyhedron::HalfedgeDS& hds) {
-	CGAL::Polyhedron_incremental_builder_3<Polyhedron::HalfedgeDS>	B(hds, true);
+static const int	icosahedron_faces[20][3] = {
+	{  0, 11,  5 }, {  0,  5,  1 }, {  0,  1,  7 }, {  0,  7, 10 },
+	{  0, 10, 11 }, {  1,  5,  9 }, {  5, 11,  4 }, { 11, 10,  2 },
+	{ 10,  7,  6 }, {  7,  1,  8 }, {  3,  9,  4 }, {  3,  4,  2 },
+	{  3,  2,  6 }, {  3,  6,  8 }, {  3,  8,  9 }, {  4,  9,  5 },
+	{  2,  4, 11 }, {  6,  2, 10 }, {  8,  6,  7 }, {  9,  8,  1 }
+};
+
+int	Build_IcosahedralSphere::expected_vertices() const {
+	return 10 * (1 << (2 * _level)) + 2;
+}
+
+int	Build_IcosahedralSphere::expected_facets() const {
+	return 20 * (1 << (2 * _level));
+}
+
+/**
+ * \brief Add a unit vector to the coordinate array
+ */
+static int	add_unit(std::vector<double>& unit, double x, double y, double z) {
+	double	l = sqrt(x * x + y * y + z * z);
+	unit.push_back(x / l);
+	unit.push_back(y / l);
+	unit.push_back(z / l);
+	return unit.size() / 3 - 1;
+}
+
+/**
+ * \brief Find the vertex on the sphere above the midpoint of an edge
+ *
+ * Each edge is shared by two triangles, the cache makes sure that both
+ * of them get the same vertex.
+ */
+static int	midpoint(std::vector<double>& unit,
+		std::map<std::pair<int, int>, int>& cache, int a, int b) {
+	std::pair<int, int>	edge(std::min(a, b), std::max(a, b));
+	std::map<std::pair<int, int>, int>::const_iterator	i
+		= cache.find(edge);
+	if (i != cache.end()) {
+		return i->second;
+	}
+	int	m = add_unit(unit, unit[3 * a] + unit[3 * b],
+			unit[3 * a + 1] + unit[3 * b + 1],
+			unit[3 * a + 2] + unit[3 * b + 2]);
+	cache[edge] = m;
+	return m;
+}
+
+void	Build_IcosahedralSphere::build() {
+	// vertices of the icosahedron on the unit sphere
+	std::vector<double>	unit;
+	unit.reserve(3 * expected_vertices());
+	double	g = (1 + sqrt(5.)) / 2;
+	for (int s = -1; s <= 1; s += 2) {
+		for (int t = -1; t <= 1; t += 2) {
+			add_unit(unit, t, -s * g, 0);
+		}
+	}
+	for (int s = -1; s <= 1; s += 2) {
+		for (int t = -1; t <= 1; t += 2) {
+			add_unit(unit, 0, t, -s * g);
+		}
+	}
+	for (int s = -1; s <= 1; s += 2) {
+		for (int t = -1; t <= 1; t += 2) {
+			add_unit(unit, -s * g, 0, t);
+		}
+	}
+	std::vector<int>	triangles(&icosahedron_faces[0][0],
+					&icosahedron_faces[0][0] + 60);
 
-	throw std::logic_error("IcosahedralSphere not implemented yet");
-	B.begin_surface(0, 0, 0);
+	// subdivide every triangle into four
+	for (int level = 0; level < _level; level++) {
+		std::map<std::pair<int, int>, int>	cache;
+		std::vector<int>	subdivided;
+		subdivided.reserve(4 * triangles.size());
+		for (unsigned int t = 0; t < triangles.size(); t += 3) {
+			int	a = triangles[t];
+			int	b = triangles[t + 1];
+			int	c = triangles[t + 2];
+			int	ab = midpoint(unit, cache, a, b);
+			int	bc = midpoint(unit, cache, b, c);
+			int	ca = midpoint(unit, cache, c, a);
+			int	children[12] = {
+				a, ab, ca,   b, bc, ab,   c, ca, bc,   ab, bc, ca
+			};
+			subdivided.insert(subdivided.end(), children,
+				children + 12);
+		}
+		triangles.swap(subdivided);
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "level %d: %d triangles",
+			level + 1, (int)triangles.size() / 3);
+	}
 
-	B.end_surface();
+	// scale to the radius
+	int	n = unit.size() / 3;
+	double	*vertices = append_vertices(n);
+	for (int i = 0; i < 3 * n; i++) {
+		vertices[i] = _radius * unit[i];
+	}
+	for (unsigned int t = 0; t < triangles.size(); t += 3) {
+		add_facet(triangles[t], triangles[t + 1], triangles[t + 2]);
+	}
 }
 
 } // namespace csg
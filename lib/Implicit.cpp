@@ -0,0 +1,179 @@
+/*
+ * Implicit.cpp -- build thickened implicit surfaces F(x,y,z) = 0
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Implicit.h>
+#include <Contouring.h>
+#include <DistanceField.h>
+#include <debug.h>
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+namespace csg {
+
+void	ImplicitFunction::evaluate(const point& p, double dx, int from,
+		int to, double *values) const {
+	for (int i = from; i < to; i++) {
+		values[i - from] = (*this)(p + vector(i * dx, 0, 0));
+	}
+}
+
+vector	ImplicitFunction::gradient(const point& p, double h) const {
+	const ImplicitFunction&	f = *this;
+	return vector(
+		f(p + vector(h, 0, 0)) - f(p - vector(h, 0, 0)),
+		f(p + vector(0, h, 0)) - f(p - vector(0, h, 0)),
+		f(p + vector(0, 0, h)) - f(p - vector(0, 0, h))) / (2 * h);
+}
+
+/**
+ * \brief Contouring of a sampled implicit function clipped to a box
+ *
+ * The function is sampled block by block just before the block is
+ * contoured, on the grid points of the block and a halo of one grid point
+ * around it needed for the gradient, and the samples are released when
+ * the block is done. So the memory needed only depends on the number of
+ * blocks contoured concurrently, not on the size of the grid. Grid points
+ * on the faces between blocks are evaluated by each block containing
+ * them, the rows are always evaluated from the start of the grid row, so
+ * that the blocks agree on the values there. The values seen by the
+ * contouring are the approximate distances derived from the samples.
+ */
+class ImplicitContouring : public Contouring {
+	const ImplicitFunction&	_f;
+	BoxDistanceField	_box;
+	double	_thickness;
+	static const int	span = blocksize + 3;
+	static size_t	index(const dcblock& b, int i, int j, int k) {
+		return (size_t)(i - b.i0 + 1) + span * ((size_t)(j - b.j0 + 1)
+			+ span * (size_t)(k - b.k0 + 1));
+	}
+	double	distance(double f, const vector& g) const;
+protected:
+	virtual void	sample(dcblock& b) const;
+	virtual double	evaluate(const dcblock& b, int i, int j, int k) const;
+	virtual vector	normal(const point& p) const;
+public:
+	ImplicitContouring(const ImplicitFunction& f, const bounds& box,
+		double thickness, const point& origin, double h,
+		int nx, int ny, int nz)
+		: Contouring(origin, h, nx, ny, nz), _f(f), _box(box),
+		  _thickness(thickness) { }
+};
+
+/**
+ * \brief Evaluate the function on a block and its halo, a row at a time
+ *
+ * The gradient only needs the halo points next to a face of the block, so
+ * the rows along the edges of the halo are skipped, and rows in the halo
+ * only cover the grid points of the block. The halo is cut off at the
+ * boundary of the grid.
+ */
+void	ImplicitContouring::sample(dcblock& b) const {
+	int	c[3] = { b.i0, b.j0, b.k0 };
+	int	lo[3], hi[3], last[3];
+	for (int a = 0; a < 3; a++) {
+		last[a] = std::min(c[a] + blocksize, _n[a]);
+		lo[a] = std::max(c[a] - 1, 0);
+		hi[a] = std::min(c[a] + blocksize + 1, _n[a]);
+	}
+	b.samples.resize((size_t)span * span * span);
+	for (int k = lo[2]; k <= hi[2]; k++) {
+		bool	kin = (k >= b.k0) && (k <= last[2]);
+		for (int j = lo[1]; j <= hi[1]; j++) {
+			bool	jin = (j >= b.j0) && (j <= last[1]);
+			if (!(jin || kin)) {
+				continue;
+			}
+			int	from = (jin && kin) ? lo[0] : b.i0;
+			int	to = (jin && kin) ? hi[0] : last[0];
+			_f.evaluate(gridpoint(0, j, k), _h, from, to + 1,
+				&b.samples[index(b, from, j, k)]);
+		}
+	}
+}
+
+/**
+ * \brief Signed distance from the surface estimated from value and gradient
+ *
+ * Where the gradient vanishes, the value itself is used.
+ */
+double	ImplicitContouring::distance(double f, const vector& g) const {
+	double	l = g.norm();
+	double	d = (l > 0) ? f / l : f;
+	if (_thickness > 0) {
+		return fabs(d) - _thickness / 2;
+	}
+	return d;
+}
+
+/**
+ * \brief Distance at a grid point, clipped to the box
+ *
+ * The gradient is estimated by central differences of the samples of the
+ * block, or one sided differences on the boundary of the grid.
+ */
+double	ImplicitContouring::evaluate(const dcblock& b, int i, int j, int k)
+		const {
+	const std::vector<double>&	s = b.samples;
+	int	c[3] = { i, j, k };
+	double	g[3];
+	for (int a = 0; a < 3; a++) {
+		int	lo[3] = { i, j, k }, hi[3] = { i, j, k };
+		lo[a] = std::max(c[a] - 1, 0);
+		hi[a] = std::min(c[a] + 1, _n[a]);
+		g[a] = (s[index(b, hi[0], hi[1], hi[2])]
+			- s[index(b, lo[0], lo[1], lo[2])])
+			/ ((hi[a] - lo[a]) * _h);
+	}
+	double	d = distance(s[index(b, i, j, k)], vector(g[0], g[1], g[2]));
+	return std::max(d, _box(gridpoint(i, j, k)));
+}
+
+/**
+ * \brief Normal of the surface or of the box, whichever bounds the solid
+ */
+vector	ImplicitContouring::normal(const point& p) const {
+	double	f = _f(p);
+	vector	g = _f.gradient(p, _h / 16);
+	if (_box(p) > distance(f, g)) {
+		return _box.gradient(p, _h / 16);
+	}
+	if ((_thickness > 0) && (f < 0)) {
+		return -1 * g;
+	}
+	return g;
+}
+
+/**
+ * \brief Sample the function on a grid covering the box and contour it
+ *
+ * The grid has a margin of one cell around the box, so that the values on
+ * the boundary of the grid are positive and the surface is closed.
+ */
+void	Build_Implicit::build() {
+	if (_box.empty()) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "empty box");
+		return;
+	}
+	double	h = _resolution;
+	point	origin = _box.min() - vector(h, h, h);
+	vector	e = _box.extent();
+	ImplicitContouring	contouring(_f, _box, _thickness, origin, h,
+		(int)ceil(e.x() / h) + 2, (int)ceil(e.y() / h) + 2,
+		(int)ceil(e.z() / h) + 2);
+	contouring.build();
+	int	n = contouring.number_of_vertices();
+	if (n == 0) {
+		return;
+	}
+	contouring.copy_vertices(append_vertices(n));
+	std::vector<int>	t = contouring.triangles();
+	for (size_t m = 0; m < t.size(); m += 3) {
+		add_facet(t[m], t[m + 1], t[m + 2]);
+	}
+}
+
+} // namespace csg
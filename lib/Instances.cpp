@@ -0,0 +1,161 @@
+/*
+ * Instances.cpp -- build primitives once and place copies of them
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Instances.h>
+#include <Arrow.h>
+#include <debug.h>
+#include <CGAL/Aff_transformation_3.h>
+#include <algorithm>
+#include <cstdio>
+
+namespace csg {
+
+PrimitiveCache&	PrimitiveCache::cache() {
+	static PrimitiveCache	primitives;
+	return primitives;
+}
+
+size_t	PrimitiveCache::size() {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	return _primitives.size();
+}
+
+/**
+ * \brief Forget all primitives
+ *
+ * Primitives currently being copied stay alive until they are done.
+ */
+void	PrimitiveCache::clear() {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	_primitives.clear();
+}
+
+/**
+ * \brief Find a primitive, building its polyhedron if necessary
+ *
+ * Only the map is protected by the cache mutex, the primitive is built
+ * while holding its own mutex, which is still locked on return.
+ */
+PrimitiveCache::primitiveptr	PrimitiveCache::find(const std::string& key,
+		const builder_type& builder,
+		std::unique_lock<std::mutex>& lock) {
+	primitiveptr	p;
+	{
+		std::unique_lock<std::mutex>	maplock(_mutex);
+		primitiveptr&	entry = _primitives[key];
+		if (!entry) {
+			entry = primitiveptr(new primitive());
+		}
+		p = entry;
+	}
+	lock = std::unique_lock<std::mutex>(p->mutex);
+	if (!p->built) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "building primitive %s",
+			key.c_str());
+		builder(p->polyhedron);
+		p->built = true;
+	}
+	return p;
+}
+
+/**
+ * \brief Get a transformed copy of a primitive polyhedron
+ */
+Polyhedron	PrimitiveCache::polyhedron(const std::string& key,
+		const builder_type& builder, const Aff_transformation& t) {
+	Polyhedron	result;
+	{
+		std::unique_lock<std::mutex>	lock;
+		primitiveptr	p = find(key, builder, lock);
+		result = p->polyhedron;
+	}
+	std::transform(result.points_begin(), result.points_end(),
+		result.points_begin(), t);
+	return result;
+}
+
+/**
+ * \brief Get a transformed copy of a primitive Nef polyhedron
+ *
+ * With the extended kernel, transformations of Nef polyhedra are only
+ * supported in special cases, so each instance is converted from the
+ * transformed polyhedron.
+ */
+Nef_polyhedron	PrimitiveCache::nef(const std::string& key,
+		const builder_type& builder, const Aff_transformation& t) {
+#ifdef CSG_EXTENDED_KERNEL
+	Polyhedron	placed = polyhedron(key, builder, t);
+	return Nef_polyhedron(placed);
+#else /* CSG_EXTENDED_KERNEL */
+	Nef_polyhedron	result;
+	{
+		std::unique_lock<std::mutex>	lock;
+		primitiveptr	p = find(key, builder, lock);
+		if (!p->converted) {
+			debug(LOG_DEBUG, DEBUG_LOG, 0, "converting primitive %s",
+				key.c_str());
+			p->nef = Nef_polyhedron(p->polyhedron);
+			p->converted = true;
+		}
+		result = p->nef;
+	}
+	result.transform(t);
+	return result;
+#endif /* CSG_EXTENDED_KERNEL */
+}
+
+/**
+ * \brief Rigid motion moving the z axis onto the segment from, to
+ *
+ * The origin is mapped to from, the point (0, 0, |to - from|) to to.
+ */
+Aff_transformation	placement(const point& from, const point& to) {
+	vector	d = vector(from, to).normalized();
+	frame	f(d);
+	vector	u = f.v2();
+	vector	w = d.cross(u);
+	return Aff_transformation(
+		u.x(), w.x(), d.x(), from.x(),
+		u.y(), w.y(), d.y(), from.y(),
+		u.z(), w.z(), d.z(), from.z());
+}
+
+/**
+ * \brief Arrow built once per length, radius and number of steps
+ *
+ * The key rounds the length to twelve digits, so that arrows whose end
+ * points were computed with different roundoff share a primitive.
+ */
+static std::string	arrow_key(double length, double radius, int steps,
+				PrimitiveCache::builder_type& builder) {
+	builder = [length, radius, steps](Polyhedron& p) {
+		Build_Arrow	b(point(0, 0, 0), point(0, 0, length),
+					radius, steps);
+		p.delegate(b);
+	};
+	char	key[128];
+	snprintf(key, sizeof(key), "arrow %.12g %.12g %d", length, radius,
+		steps);
+	return std::string(key);
+}
+
+Polyhedron	arrow_polyhedron(const point& from, const point& to,
+			double radius, int steps) {
+	PrimitiveCache::builder_type	builder;
+	std::string	key = arrow_key(vector(from, to).norm(), radius, steps,
+				builder);
+	return PrimitiveCache::cache().polyhedron(key, builder,
+		placement(from, to));
+}
+
+Nef_polyhedron	arrow_nef(const point& from, const point& to,
+			double radius, int steps) {
+	PrimitiveCache::builder_type	builder;
+	std::string	key = arrow_key(vector(from, to).norm(), radius, steps,
+				builder);
+	return PrimitiveCache::cache().nef(key, builder, placement(from, to));
+}
+
+} // namespace csg
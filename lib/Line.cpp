@@ -7,11 +7,22 @@
 
 namespace csg {
 
-vector	Line::normal(double /* t */) const {
+/**
+ * \brief Position and derivatives of the line
+ *
+ * The second derivative vanishes, so any vector orthogonal to the
+ * direction is returned in its place to orient the tube.
+ */
+curvepoint	Line::evaluate(double t) const {
+	curvepoint	c;
+	c.p = _p0 + t * _r;
+	c.d1 = _r;
 	if (vector::e1.parallel(_r)) {
-		return vector::e2.orthogonalto(_r);
+		c.d2 = vector::e2.orthogonalto(_r);
+	} else {
+		c.d2 = vector::e1.orthogonalto(_r);
 	}
-	return vector::e1.orthogonalto(_r);
+	return c;
 }
 
 } // namespace csg
@@ -0,0 +1,97 @@
+/*
+ * Mesh.cpp -- flat indexed triangle meshes
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Mesh.h>
+#include <debug.h>
+#include <map>
+#ifndef CSG_EXTENDED_KERNEL
+#include <CGAL/Polygon_mesh_processing/triangulate_faces.h>
+#endif /* CSG_EXTENDED_KERNEL */
+
+namespace csg {
+
+void	IndexedMesh::reserve(int nvertices, int ntriangles) {
+	vertices.reserve(3 * nvertices);
+	triangles.reserve(3 * ntriangles);
+}
+
+int	IndexedMesh::add_vertex(double x, double y, double z) {
+	vertices.push_back(x);
+	vertices.push_back(y);
+	vertices.push_back(z);
+	return number_of_vertices() - 1;
+}
+
+int	IndexedMesh::add_vertex(const point& p) {
+	return add_vertex(p.x(), p.y(), p.z());
+}
+
+/**
+ * \brief Make room for n more vertices
+ *
+ * Returns a pointer to the 3 * n coordinates of the new vertices, which
+ * the caller fills in. The pointer is invalidated by the next change.
+ */
+double	*IndexedMesh::append_vertices(int n) {
+	size_t	offset = vertices.size();
+	vertices.resize(offset + 3 * n);
+	return &vertices[offset];
+}
+
+void	IndexedMesh::add_triangle(int a, int b, int c) {
+	triangles.push_back(a);
+	triangles.push_back(b);
+	triangles.push_back(c);
+}
+
+point	IndexedMesh::vertex(int i) const {
+	return point(vertices[3 * i], vertices[3 * i + 1], vertices[3 * i + 2]);
+}
+
+/**
+ * \brief Convert a polyhedron to an indexed mesh
+ *
+ * The coordinates of each vertex are converted to double exactly once.
+ * Facets with more than three vertices are triangulated, with the
+ * extended kernel this is only a fan triangulation, which is correct
+ * for convex facets only.
+ */
+IndexedMesh::IndexedMesh(const Polyhedron& polyhedron) {
+#ifndef CSG_EXTENDED_KERNEL
+	Polyhedron	triangulated;
+	if (!polyhedron.is_pure_triangle()) {
+		triangulated = polyhedron;
+		CGAL::Polygon_mesh_processing::triangulate_faces(triangulated);
+	}
+	const Polyhedron&	p = (polyhedron.is_pure_triangle())
+					? polyhedron : triangulated;
+#else /* CSG_EXTENDED_KERNEL */
+	const Polyhedron&	p = polyhedron;
+#endif /* CSG_EXTENDED_KERNEL */
+	reserve(p.size_of_vertices(), p.size_of_facets());
+	std::map<const Polyhedron::Vertex *, int>	index;
+	Polyhedron::Vertex_const_iterator	v;
+	for (v = p.vertices_begin(); v != p.vertices_end(); v++) {
+		const Point&	q = v->point();
+		index[&*v] = add_vertex(CGAL::to_double(q.x()),
+			CGAL::to_double(q.y()), CGAL::to_double(q.z()));
+	}
+	Polyhedron::Facet_const_iterator	f;
+	for (f = p.facets_begin(); f != p.facets_end(); f++) {
+		Polyhedron::Halfedge_const_handle	h = f->halfedge();
+		int	first = index[&*(h->vertex())];
+		h = h->next();
+		int	previous = index[&*(h->vertex())];
+		for (h = h->next(); h != f->halfedge(); h = h->next()) {
+			int	current = index[&*(h->vertex())];
+			add_triangle(first, previous, current);
+			previous = current;
+		}
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "mesh with %d vertices, %d triangles",
+		number_of_vertices(), number_of_triangles());
+}
+
+} // namespace csg
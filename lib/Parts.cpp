@@ -4,31 +4,31 @@
  * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
 #include <Parts.h>
+#include <Box.h>
+#include <ThreadPool.h>
 #include <debug.h>
-#include <fstream>
-#include <CGAL/IO/Polyhedron_iostream.h>
 #include <CGAL/IO/Nef_polyhedron_iostream_3.h>
 
 namespace csg {
 
-PartWriter::PartWriter(const std::string& _prefix) : prefix(_prefix) {
+PartWriter::PartWriter(const std::string& _prefix, output_format format)
+	: prefix(_prefix), _format(format) {
 }
 
-void	PartWriter::write_part(Nef_polyhedron& image, const std::string& part,
+void	PartWriter::write_part(const Nef_polyhedron& image,
+		const std::string& part,
 		const Nef_polyhedron& halfspace) const {
 	try {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "writing part: %s",
 			part.c_str());
 		std::string	name = prefix + std::string("-") + part
-					+ std::string(".off");
-		std::ofstream	out(name.c_str());
+					+ format_extension(_format);
 		Polyhedron	P;
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "intersect with half space");
 		(halfspace * image).convert_to_polyhedron(P);
 		debug(LOG_DEBUG, DEBUG_LOG, 0,
 			"conversion to polygon complete");
-		out << P;
-		out.close();
+		write_polyhedron(name, P, _format);
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "part %s written",
 			part.c_str());
 	} catch (std::exception& x) {
@@ -39,40 +39,65 @@ void	PartWriter::write_part(Nef_polyhedron& image, const std::string& part,
 	}
 }
 
+/**
+ * \brief Name of a part as used in the file name
+ */
+std::string	PartWriter::partname(const object_part& part) {
+	switch (part) {
+	case LEFT_PART:		return std::string("left");
+	case RIGHT_PART:	return std::string("right");
+	case FRONT_PART:	return std::string("front");
+	case BACK_PART:		return std::string("back");
+	case TOP_PART:		return std::string("top");
+	case BOTTOM_PART:	return std::string("bottom");
+	}
+	return std::string("unknown");
+}
+
+/**
+ * \brief Half space containing a part
+ */
+Nef_polyhedron	PartWriter::parthalfspace(const object_part& part,
+			double offset) {
+	switch (part) {
+	case LEFT_PART:		return halfspace(1, 0, 0, offset);
+	case RIGHT_PART:	return halfspace(-1, 0, 0, offset);
+	case FRONT_PART:	return halfspace(0, 1, 0, offset);
+	case BACK_PART:		return halfspace(0, -1, 0, offset);
+	case TOP_PART:		return halfspace(0, 0, 1, offset);
+	case BOTTOM_PART:	return halfspace(0, 0, -1, offset);
+	}
+	return Nef_polyhedron();
+}
+
 void	PartWriter::operator()(const object_part& part,
 			Nef_polyhedron& image, double offset) const {
-	switch (part) {
-	case LEFT_PART:
-		write_part(image, std::string("left"),
-			Nef_polyhedron(Plane(1, 0, 0, offset),
-				Nef_polyhedron::INCLUDED));
-		break;
-	case RIGHT_PART:
-		write_part(image, std::string("right"), 
-			Nef_polyhedron(Plane(-1, 0, 0, offset),
-				Nef_polyhedron::INCLUDED));
-		break;
-	case FRONT_PART:
-		write_part(image, std::string("front"),
-			Nef_polyhedron(Plane(0, 1, 0, offset),
-				Nef_polyhedron::INCLUDED));
-		break;
-	case BACK_PART:
-		write_part(image, std::string("back"),
-			Nef_polyhedron(Plane(0, -1, 0, offset),
-				Nef_polyhedron::INCLUDED));
-		break;
-	case TOP_PART:
-		write_part(image, std::string("top"),
-			Nef_polyhedron(Plane(0, 0, 1, offset),
-				Nef_polyhedron::INCLUDED));
-		break;
-	case BOTTOM_PART:
-		write_part(image, std::string("bottom"),
-			Nef_polyhedron(Plane(0, 0, -1, offset),
-				Nef_polyhedron::INCLUDED));
-		break;
+	write_part(image, partname(part), parthalfspace(part, offset));
+}
+
+/**
+ * \brief Write several parts concurrently
+ *
+ * Each part is cut from the image on a worker thread and written as
+ * soon as it is complete. The image is shared by all workers, it is
+ * only read.
+ */
+void	PartWriter::operator()(const std::vector<object_part>& parts,
+			Nef_polyhedron& image, double offset) const {
+	std::vector<Nef_polyhedron>	halfspaces;
+	for (size_t i = 0; i < parts.size(); i++) {
+		halfspaces.push_back(parthalfspace(parts[i], offset));
+	}
+	TaskGroup	group;
+	for (size_t i = 0; i < parts.size(); i++) {
+		const Nef_polyhedron	*n = &image;
+		const Nef_polyhedron	*h = &halfspaces[i];
+		std::string	name = partname(parts[i]);
+		group.run([this, n, h, name]() {
+			write_part(*n, name, *h);
+		});
 	}
+	group.wait();
 }
 
 } // namespace csg
@@ -8,6 +8,10 @@
 #include <CGAL/Polyhedron_incremental_builder_3.h>
 #include <math.h>
 #include <debug.h>
+#include <GridKernels.h>
+#include <AngleTable.h>
+#include <algorithm>
+#include <vector>
 
 namespace csg {
 
@@ -39,27 +43,101 @@ int	Build_Polar::vertex(const int r, const int phi) const {
 	return 2 * (r * (_phisteps + 1) + phi);
 }
 
+/**
+ * \brief Number of vertices
+ */
+int	Build_Polar::expected_vertices() const {
+	if (_outside) {
+		return 0;
+	}
+	if (_tolerance > 0) {
+		return (_grid) ? 2 * _grid->number_of_nodes() : 0;
+	}
+	int	philimit = closed() ? _phisteps : (_phisteps + 1);
+	int	rings = _rsteps + ((contains0()) ? 0 : 1);
+	return 2 * rings * philimit + ((contains0()) ? 2 : 0);
+}
+
+/**
+ * \brief Number of facets
+ */
+int	Build_Polar::expected_facets() const {
+	if (_outside) {
+		return 0;
+	}
+	if (_tolerance > 0) {
+		return (_grid) ? 2 * (_grid->number_of_triangles()
+				+ _grid->number_of_boundary_edges()) : 0;
+	}
+	int	rlimit = _rsteps - ((contains0()) ? 1 : 0);
+	int	result = 4 * rlimit * _phisteps;	// surface triangles
+	if (contains0()) {
+		result += 2 * _phisteps;		// fan
+	}
+	if (!closed()) {
+		result += 4 * rlimit + ((contains0()) ? 4 : 0);	// radius
+	}
+	result += 2 * _phisteps;			// outer perimeter
+	if (!contains0()) {
+		result += 2 * _phisteps;		// inner perimeter
+	}
+	return result;
+}
+
+/**
+ * \brief Compute top and bottom vertices of a ring of constant radius
+ *
+ * Writes the coordinates of the top and bottom vertex of each of the n
+ * points of the ring to vertices. The default implementation evaluates
+ * p for every vertex.
+ */
+void	Build_Polar::ring(double r, const double *phi,
+		const double * /* cosphi */, const double * /* sinphi */,
+		int n, double h, double *vertices) {
+	for (int i = 0; i < n; i++) {
+		point	top = p(r, phi[i], h);
+		point	bottom = p(r, phi[i], -h);
+		double	*v = vertices + 6 * i;
+		v[0] = top.x(); v[1] = top.y(); v[2] = top.z();
+		v[3] = bottom.x(); v[4] = bottom.y(); v[5] = bottom.z();
+	}
+}
+
 /**
  * \brief add vertices (common to all surfaces)
  */
-void	Build_Polar::add_vertices(Builder& B) {
+void	Build_Polar::add_vertices() {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "vertices");
 	int	philimit = closed() ? _phisteps : (_phisteps + 1);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "philimit: %d (_phisteps = %d)",
 		philimit, _phisteps);
 	int	rinit = (contains0()) ? 1 : 0;
-	for (int r = rinit; r <= _rsteps; r++) {
-		double	_r = _domain.rrange().min() + r * deltar;
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "r = %d, _r = %f", r, _r);
-		for (int phi = 0; phi < philimit; phi++) {
-			double	_phi = _domain.phirange().min() + phi * deltaphi;
-			add_vertex(B, p(_r, _phi, _h));
-			add_vertex(B, p(_r, _phi, -_h));
+	if (_samples.size() > 0) {
+		// rings of the window, from the samples taken by trim()
+		int	fulln = _fullphisteps + 1;
+		for (int r = rinit; r <= _rsteps; r++) {
+			const double	*v = &_samples[6 * (fulln
+						* (_window[0] + r) + _window[2])];
+			std::copy(v, v + 6 * philimit,
+				append_vertices(2 * philimit));
+		}
+		std::vector<double>().swap(_samples);
+	} else {
+		// the angles are the same on every ring
+		const AngleTable&	angles
+			= AngleTable::get(_domain.phirange(), _phisteps);
+		for (int r = rinit; r <= _rsteps; r++) {
+			double	_r = _domain.rrange().min() + r * deltar;
+			debug(LOG_DEBUG, DEBUG_LOG, 0, "r = %d, _r = %f",
+				r, _r);
+			ring(_r, angles.angles(), angles.cosines(),
+				angles.sines(), philimit, _h,
+				append_vertices(2 * philimit));
 		}
 	}
 	if (contains0()) {
-		add_vertex(B, p(0, 0, _h));
-		add_vertex(B, p(0, 0, -_h));
+		add_vertex(p(0, 0, _h));
+		add_vertex(p(0, 0, -_h));
 	}
 }
 
@@ -68,27 +146,27 @@ void	Build_Polar::add_vertices(Builder& B) {
  *
  * This method does not add the triangles along the border of the domain
  */
-void	Build_Polar::add_surface_triangles(Builder& B) {
+void	Build_Polar::add_surface_triangles() {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "surface facets");
 	int	rlimit = _rsteps - ((contains0()) ? 1 : 0);
 	for (int r = 0; r < rlimit; r++) {
 		for (int phi = 0; phi < _phisteps; phi++) {
-			add_facet(B,
+			add_facet(
 				vertex(r    , phi    ),
 				vertex(r + 1, phi    ),
 				vertex(r    , phi + 1));
 
-			add_facet(B,
+			add_facet(
 				vertex(r + 1, phi    )    ,
 				vertex(r + 1, phi + 1)    ,
 				vertex(r    , phi + 1)    );
 
-			add_facet(B,
+			add_facet(
 				vertex(r    , phi    ) + 1,
 				vertex(r    , phi + 1) + 1,
 				vertex(r + 1, phi    ) + 1);
 
-			add_facet(B,
+			add_facet(
 				vertex(r + 1, phi    ) + 1,
 				vertex(r    , phi + 1) + 1,
 				vertex(r + 1, phi + 1) + 1);
@@ -99,18 +177,18 @@ void	Build_Polar::add_surface_triangles(Builder& B) {
 /**
  * \brief add fan triangles
  */
-void	Build_Polar::add_surface_fan(Builder& B) {
+void	Build_Polar::add_surface_fan() {
 	if (!contains0()) {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "fan not needed");
 		return;
 	}
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "add fan");
 	for (int phi = 0; phi < _phisteps; phi++) {
-		add_facet(B,
+		add_facet(
 			vertexnumber() - 2,
 			vertex(0, phi),
 			vertex(0, phi + 1));
-		add_facet(B,
+		add_facet(
 			vertexnumber() - 1,
 			vertex(0, phi + 1) + 1,
 			vertex(0, phi) + 1);
@@ -120,7 +198,7 @@ void	Build_Polar::add_surface_fan(Builder& B) {
 /**
  * \brief add the facets along the radial borders
  */
-void	Build_Polar::add_radius_surface(Builder& B) {
+void	Build_Polar::add_radius_surface() {
 	if (closed()) {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "radius surfaces not needed");
 		return;
@@ -128,41 +206,41 @@ void	Build_Polar::add_radius_surface(Builder& B) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "radius surfaces");
 	int	rlimit = _rsteps - ((contains0()) ? 1 : 0);
 	for (int r = 0; r < rlimit; r++) {
-		add_facet(B,
+		add_facet(
 			vertex(r    , 0    )    ,
 			vertex(r    , 0    ) + 1,
 			vertex(r + 1, 0    )    );
-		add_facet(B,
+		add_facet(
 			vertex(r    , 0    ) + 1,
 			vertex(r + 1, 0    ) + 1,
 			vertex(r + 1, 0    )    );
 	}
 	if (contains0()) {
-		add_facet(B,
+		add_facet(
 			vertex(0, 0) + 1,
 			vertex(0, 0)    ,
 			vertexnumber() - 2);
-		add_facet(B,
+		add_facet(
 			vertexnumber() - 1,
 			vertex(0, 0) + 1,
 			vertexnumber() - 2);
 	}
 	for (int r = 0; r < rlimit; r++) {
-		add_facet(B,
+		add_facet(
 			vertex(r    , _phisteps)    ,
 			vertex(r + 1, _phisteps)    ,
 			vertex(r    , _phisteps) + 1);
-		add_facet(B,
+		add_facet(
 			vertex(r + 1, _phisteps)    ,
 			vertex(r + 1, _phisteps) + 1,
 			vertex(r    , _phisteps) + 1);
 	}
 	if(contains0()) {
-		add_facet(B,
+		add_facet(
 			vertex(0, _phisteps)    ,
 			vertex(0, _phisteps) + 1,
 			vertexnumber() - 2);
-		add_facet(B,
+		add_facet(
 			vertex(0, _phisteps) + 1,
 			vertexnumber() - 1,
 			vertexnumber() - 2);
@@ -172,16 +250,16 @@ void	Build_Polar::add_radius_surface(Builder& B) {
 /**
  * \brief add the inner and outer borders
  */
-void	Build_Polar::add_perimeter(Builder& B) {
+void	Build_Polar::add_perimeter() {
 	int	rimindex = _rsteps - ((contains0()) ? 1 : 0);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "outer surface");
 	for (int phi = 0; phi < _phisteps; phi++) {
-		add_facet(B,
+		add_facet(
 			vertex(rimindex, phi    )    ,
 			vertex(rimindex, phi    ) + 1,
 			vertex(rimindex, phi + 1) + 1);
 
-		add_facet(B,
+		add_facet(
 			vertex(rimindex, phi    )    ,
 			vertex(rimindex, phi + 1) + 1,
 			vertex(rimindex, phi + 1)    );
@@ -190,12 +268,12 @@ void	Build_Polar::add_perimeter(Builder& B) {
 	if (!contains0()) {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "inner surface");
 		for (int phi = 0; phi < _phisteps; phi++) {
-			add_facet(B,
+			add_facet(
 				vertex(0, phi    )    ,
 				vertex(0, phi + 1)    ,
 				vertex(0, phi    ) + 1);
 
-			add_facet(B,
+			add_facet(
 				vertex(0, phi + 1)    ,
 				vertex(0, phi + 1) + 1,
 				vertex(0, phi    ) + 1);
@@ -203,20 +281,101 @@ void	Build_Polar::add_perimeter(Builder& B) {
 	}
 }
 
+/**
+ * \brief Restrict the domain to the grid cells that may meet the clip box
+ *
+ * All rings of the full grid are sampled once, including the ring at
+ * r = 0 and the last angle of a closed domain, then the domain and the
+ * steps are replaced by the window of cells found by grid_window().
+ * The samples are kept, so that build() can take the rings of the window
+ * from them.
+ */
+void	Build_Polar::trim() {
+	_domain = _fulldomain;
+	_rsteps = _fullrsteps;
+	_phisteps = _fullphisteps;
+	_outside = false;
+	_samples.clear();
+	if (!_clip.empty()) {
+		const AngleTable&	angles
+			= AngleTable::get(_domain.phirange(), _phisteps);
+		int	n = _phisteps + 1;
+		double	dr = _domain.rrange().length() / _rsteps;
+		std::vector<double>	vertices(6 * n * (_rsteps + 1));
+		for (int r = 0; r <= _rsteps; r++) {
+			ring(_domain.rrange().min() + r * dr, angles.angles(),
+				angles.cosines(), angles.sines(), n, _h,
+				&vertices[6 * n * r]);
+		}
+		int	*window = _window;
+		if (grid_window(&vertices[0], _rsteps, _phisteps, _clip,
+			window)) {
+			_domain = PolarDomain(
+				_fulldomain.rrange().subinterval(_rsteps,
+					window[0], window[1]),
+				_fulldomain.phirange().subinterval(_phisteps,
+					window[2], window[3]));
+			_rsteps = window[1] - window[0];
+			_phisteps = window[3] - window[2];
+			debug(LOG_DEBUG, DEBUG_LOG, 0,
+				"clipped to %d x %d of %d x %d cells",
+				_rsteps, _phisteps, _fullrsteps, _fullphisteps);
+			if (_tolerance <= 0) {
+				_samples.swap(vertices);
+			}
+		} else {
+			debug(LOG_DEBUG, DEBUG_LOG, 0,
+				"surface outside clip box");
+			_outside = true;
+		}
+	}
+	deltar = _domain.rrange().length() / _rsteps;
+	deltaphi = _domain.phirange().length() / _phisteps;
+}
+
+/**
+ * \brief Trim the domain, so that the expected counts are known
+ */
+void	Build_Polar::prepare() {
+	trim();
+}
+
+/**
+ * \brief Build the surface on an adaptively refined grid
+ *
+ * The grid closes around if the domain is the full circle, and the nodes
+ * at r = 0 are merged into one if the domain contains the origin.
+ */
+void	Build_Polar::build_adaptive() {
+	_grid.reset(new AdaptiveGrid(_domain.rrange(), _domain.phirange(),
+		_rsteps, _phisteps, _tolerance, closed(), contains0()));
+	_grid->build([this](double r, double phi) { return p(r, phi, 0); });
+	std::vector<point>	top, bottom;
+	for (int k = 0; k < _grid->number_of_nodes(); k++) {
+		top.push_back(p(_grid->u[k], _grid->v[k], _h));
+		bottom.push_back(p(_grid->u[k], _grid->v[k], -_h));
+	}
+	add_sheet(top, bottom, _grid->triangles, _grid->boundary);
+}
+
 /**
  * \brief create the polyhedron
  */
-void	Build_Polar::operator()(Polyhedron::HalfedgeDS& hds) {
-	Builder	B(hds, true);
+void	Build_Polar::build() {
+	if (_outside) {
+		return;
+	}
+	if (_tolerance > 0) {
+		build_adaptive();
+		return;
+	}
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "start building surface");
-	B.begin_surface(0, 0, 0);
-	add_vertices(B);
-	add_surface_triangles(B);
-	add_surface_fan(B);
-	add_radius_surface(B);
-	add_perimeter(B);
+	add_vertices();
+	add_surface_triangles();
+	add_surface_fan();
+	add_radius_surface();
+	add_perimeter();
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "all facets added");
-	B.end_surface();
 }
 
 /**
@@ -229,6 +388,17 @@ point	Build_PolarFunction::p(double r, double phi, double h) {
 	return point(x, y, z);
 }
 
+/**
+ * \brief Evaluate the function once per ring point
+ */
+void	Build_PolarFunction::ring(double r, const double *phi,
+		const double *cosphi, const double *sinphi,
+		int n, double h, double *vertices) {
+	std::vector<double>	z(n);
+	_f.evaluate(r, phi, n, &z[0]);
+	polar_vertices(r, cosphi, sinphi, &z[0], n, h/2, vertices);
+}
+
 /**
  * \brief Get the point with parameter values r, phi and h
  */
@@ -236,4 +406,15 @@ point	Build_PolarPointFunction::p(double r, double phi, double h) {
 	return _f.p(r, phi) + _f.v(r, phi) * (h/2);
 }
 
+/**
+ * \brief Evaluate point and normal once per ring point
+ */
+void	Build_PolarPointFunction::ring(double r, const double *phi,
+		const double * /* cosphi */, const double * /* sinphi */,
+		int n, double h, double *vertices) {
+	std::vector<double>	points(3 * n), normals(3 * n);
+	_f.evaluate(r, phi, n, &points[0], &normals[0]);
+	offset_vertices(&points[0], &normals[0], n, h/2, vertices);
+}
+
 } // namespace csg
@@ -4,55 +4,63 @@
  * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
 #include <SphericalSurface.h>
+#include <AngleTable.h>
 #include <common.h>
 #include <debug.h>
 #include <CGAL/Polyhedron_incremental_builder_3.h>
 
 namespace csg {
 
-void	Build_SphericalSurface::operator()(Polyhedron::HalfedgeDS& hds) {
-	Builder	B(hds, true);
-	B.begin_surface(0, 0, 0);
+int	Build_SphericalSurface::expected_vertices() const {
+	return 4 * _steps * (2 * _steps - 1) + 2;
+}
+
+int	Build_SphericalSurface::expected_facets() const {
+	return 8 * _steps * (2 * _steps - 1);
+}
+
+void	Build_SphericalSurface::build() {
 
 	// north pole
-	add_vertex(B, 0, 0, _f(0, 0));
+	add_vertex(0, 0, _f(0, 0));
 
 	// add vertices between poles
-	double	delta = M_PI / (2 * _steps);
+	// theta and phi use the same step, theta only the first half
+	const AngleTable&	angles = AngleTable::get(Interval2Pi, 4 * _steps);
 	for (int theta = 1; theta < 2 * _steps; theta++) {
-		double	_theta = theta * delta;
-		double	costheta = cos(_theta);
-		double	sintheta = sin(_theta);
+		double	_theta = angles.angle(theta);
+		double	costheta = angles.cosine(theta);
+		double	sintheta = angles.sine(theta);
 		for (int phi = 0; phi < 4 * _steps; phi++) {
-			double	_phi = phi * delta;
+			double	_phi = angles.angle(phi);
 			double	_radius = _f(_theta, _phi);
 			double	st = _radius * sintheta;
-			double	x = st * cos(_phi);
-			double	y = st * sin(_phi);
+			double	x = st * angles.cosine(phi);
+			double	y = st * angles.sine(phi);
 			double	z = _radius * costheta;
-			add_vertex(B, x, y, z);
+			add_vertex(x, y, z);
 		}
 	}
 
 	// south pole
-	add_vertex(B, 0, 0, -_f(M_PI, 0));
+	add_vertex(0, 0, -_f(M_PI, 0));
 
 	// triangles around the north pole
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "triangles around north pole");
 	for (int i = 1; i <= 4 * _steps - 1; i++) {
-		add_facet(B, 0, i, i + 1);
+		add_facet(0, i, i + 1);
 	}
-	add_facet(B, 0, 4 * _steps, 1);
+	add_facet(0, 4 * _steps, 1);
 
 	// triangles around the south pole
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "triangles around south pole");
 	for (int i = 1; i <= 4 * _steps - 1; i++) {
-		add_facet(B,
+		add_facet(
 			vertexnumber() - 1,
 			vertexnumber() - i - 1,
 			vertexnumber() - i - 2);
 	}
-	add_facet(B,
+	add_facet(
 		vertexnumber() - 1,
 		vertexnumber() - 4 * _steps - 1,
 		vertexnumber() - 2);
@@ -62,25 +70,24 @@ void	Build_SphericalSurface::operator()(Polyhedron::HalfedgeDS& hds) {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "zone theta = %d", theta);
 		int	t = 4 * (theta - 1) * _steps + 1;
 		for (int phi = 0; phi < 4 * _steps - 1; phi++) {
-			add_facet(B, 
+			add_facet(
 				t + phi,
 				t + phi + 4 * _steps,
 				t + phi + 1);
-			add_facet(B, 
+			add_facet(
 				t + phi + 1,
 				t + phi + 4 * _steps,
 				t + phi + 4 * _steps + 1);
 		}
-		add_facet(B, 
+		add_facet(
 			t,
 			t + 4 * _steps - 1,
 			t + 8 * _steps - 1);
-		add_facet(B,
+		add_facet(
 			t,
 			t + 8 * _steps - 1,
 			t + 4 * _steps);
 	}
-	B.end_surface();
 }
 
 } // namespace csg
@@ -4,49 +4,139 @@
  * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
 #include <Surface.h>
+#include <AABBTree.h>
 #include <debug.h>
+#include <stdexcept>
 
 namespace csg {
 
-void	Build_Surface::add_vertex(Builder& B, double x, double y, double z) {
-	if (debuglevel > LOG_DEBUG) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "vertex %d (%f, %f, %f)",
-			vertexnumber(), x, y, z);
+/**
+ * \brief Build the surface into an indexed mesh
+ *
+ * The vertex and facet counts are checked before decimation, self
+ * intersections after it, if validation is enabled.
+ */
+void	Build_Surface::mesh(IndexedMesh& m) {
+	m.vertices.clear();
+	m.triangles.clear();
+	prepare();
+	m.reserve(expected_vertices(), expected_facets());
+	_mesh = &m;
+	_vertexnumber = 0;
+	_facetnumber = 0;
+	try {
+		build();
+	} catch (...) {
+		_mesh = NULL;
+		throw;
+	}
+	_mesh = NULL;
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "surface with %d vertices, %d facets",
+		vertexnumber(), facetnumber());
+	if ((expected_vertices() > 0)
+		&& (expected_vertices() != vertexnumber())) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "expected %d vertices, got %d",
+			expected_vertices(), vertexnumber());
+	}
+	if ((expected_facets() > 0) && (expected_facets() != facetnumber())) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "expected %d facets, got %d",
+			expected_facets(), facetnumber());
+	}
+	if (_maxdeviation > 0) {
+		Decimation	decimate(_maxdeviation);
+		decimate(m);
+	}
+	if (_validation) {
+		AABBTree	tree(m);
+		if (tree.self_intersects()) {
+			debug(LOG_ERR, DEBUG_LOG, 0,
+				"surface with %d facets intersects itself",
+				m.number_of_triangles());
+			throw std::runtime_error("self intersecting surface");
+		}
+	}
+}
+
+/**
+ * \brief Add a closed sheet around a triangulated parameter domain
+ *
+ * Node k of the triangulation gets the vertices top[k] and bottom[k].
+ * The triangles are counterclockwise as seen from the top side, and the
+ * boundary contains the directed boundary edges in the direction the
+ * triangles traverse them. The top and bottom sheets are connected by a
+ * wall along the boundary.
+ */
+void	Build_Surface::add_sheet(const std::vector<point>& top,
+		const std::vector<point>& bottom,
+		const std::vector<int>& triangles,
+		const std::vector<int>& boundary) {
+	int	base = vertexnumber();
+	for (unsigned int k = 0; k < top.size(); k++) {
+		add_vertex(top[k]);
+		add_vertex(bottom[k]);
 	}
-	B.add_vertex(Point(x, y, z));
-	_vertexnumber++;
+	for (unsigned int t = 0; t < triangles.size(); t += 3) {
+		int	a = base + 2 * triangles[t];
+		int	b = base + 2 * triangles[t + 1];
+		int	c = base + 2 * triangles[t + 2];
+		add_facet(a, b, c);
+		add_facet(a + 1, c + 1, b + 1);
+	}
+	for (unsigned int e = 0; e < boundary.size(); e += 2) {
+		int	a = base + 2 * boundary[e];
+		int	b = base + 2 * boundary[e + 1];
+		add_facet(a, a + 1, b);
+		add_facet(b, a + 1, b + 1);
+	}
+}
+
+IndexedMesh	Build_Surface::mesh() {
+	IndexedMesh	m;
+	mesh(m);
+	return m;
 }
 
-void	Build_Surface::add_vertex(Builder& B, const point& p) {
-	add_vertex(B, p.x(), p.y(), p.z());
+/**
+ * \brief Build the surface and load it into a polyhedron
+ */
+void	Build_Surface::operator()(Polyhedron::HalfedgeDS& hds) {
+	IndexedMesh	m;
+	mesh(m);
+	load(hds, m);
 }
 
-void	Build_Surface::add_facet(Builder& B, int a, int b, int c) {
-	if (debuglevel > LOG_DEBUG) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "facet  %d (%d, %d, %d)",
-			facetnumber(), a, b, c);
-	}
-	if (a >= vertexnumber()) {
-		fprintf(stderr, "vertex number %d exceeds %d\n", a,
-			vertexnumber());
-		throw std::runtime_error("bad vertex number");
-	}
-	if (b >= vertexnumber()) {
-		fprintf(stderr, "vertex number %d exceeds %d\n", b,
-			vertexnumber());
-		throw std::runtime_error("bad vertex number");
-	}
-	if (c >= vertexnumber()) {
-		fprintf(stderr, "vertex number %d exceeds %d\n", c,
-			vertexnumber());
-		throw std::runtime_error("bad vertex number");
-	}
-	B.begin_facet();
-	B.add_vertex_to_facet(a);
-	B.add_vertex_to_facet(b);
-	B.add_vertex_to_facet(c);
-	B.end_facet();
-	_facetnumber++;
+/**
+ * \brief Load an indexed mesh into a halfedge data structure
+ *
+ * The vertex indices are checked once for the whole mesh, then all
+ * vertices and facets are handed to the incremental builder, with the
+ * halfedge data structure allocated to its final size up front.
+ */
+void	load(Polyhedron::HalfedgeDS& hds, const IndexedMesh& mesh) {
+	int	nvertices = mesh.number_of_vertices();
+	for (size_t i = 0; i < mesh.triangles.size(); i++) {
+		int	v = mesh.triangles[i];
+		if ((v < 0) || (v >= nvertices)) {
+			fprintf(stderr, "vertex number %d exceeds %d\n", v,
+				nvertices);
+			throw std::runtime_error("bad vertex number");
+		}
+	}
+	int	nfacets = mesh.number_of_triangles();
+	Builder	B(hds, false);
+	B.begin_surface(nvertices, nfacets, 3 * nfacets);
+	for (int i = 0; i < nvertices; i++) {
+		B.add_vertex(Point(mesh.vertices[3 * i],
+			mesh.vertices[3 * i + 1], mesh.vertices[3 * i + 2]));
+	}
+	const int	*t = (nfacets > 0) ? &mesh.triangles[0] : NULL;
+	for (int f = 0; f < nfacets; f++, t += 3) {
+		B.add_facet(t, t + 3);
+	}
+	B.end_surface();
+	if (B.error()) {
+		throw std::runtime_error("cannot build polyhedron from mesh");
+	}
 }
 
 } // namespace csg
@@ -0,0 +1,168 @@
+/*
+ * ThreadPool.cpp -- worker threads for independent construction tasks
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <ThreadPool.h>
+#include <debug.h>
+
+namespace csg {
+
+unsigned	ThreadPool::_concurrency = 0;
+
+ThreadPool::ThreadPool(unsigned threads) : _stop(false) {
+	if (threads == 0) {
+		threads = std::thread::hardware_concurrency();
+	}
+	if (threads == 0) {
+		threads = 1;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "starting %u worker threads", threads);
+	for (unsigned i = 0; i < threads; i++) {
+		_workers.push_back(std::thread(&ThreadPool::work, this));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		_stop = true;
+	}
+	_cond.notify_all();
+	for (size_t i = 0; i < _workers.size(); i++) {
+		_workers[i].join();
+	}
+}
+
+/**
+ * \brief Main function of the worker threads
+ */
+void	ThreadPool::work() {
+	for (;;) {
+		task_type	task;
+		{
+			std::unique_lock<std::mutex>	lock(_mutex);
+			while ((!_stop) && (_queue.empty())) {
+				_cond.wait(lock);
+			}
+			if (_queue.empty()) {
+				return;
+			}
+			task = _queue.front();
+			_queue.pop_front();
+		}
+		task();
+	}
+}
+
+void	ThreadPool::submit(const task_type& task) {
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		_queue.push_back(task);
+	}
+	_cond.notify_one();
+}
+
+/**
+ * \brief Execute a queued task in the calling thread
+ *
+ * Returns false if there was no task in the queue.
+ */
+bool	ThreadPool::run_one() {
+	task_type	task;
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		if (_queue.empty()) {
+			return false;
+		}
+		task = _queue.front();
+		_queue.pop_front();
+	}
+	task();
+	return true;
+}
+
+ThreadPool&	ThreadPool::pool() {
+	static ThreadPool	_pool(_concurrency);
+	return _pool;
+}
+
+void	ThreadPool::concurrency(unsigned threads) {
+	_concurrency = threads;
+}
+
+unsigned	ThreadPool::concurrency() {
+	return _concurrency;
+}
+
+//////////////////////////////////////////////////////////////////////
+// TaskGroup implementation
+//////////////////////////////////////////////////////////////////////
+
+TaskGroup::TaskGroup(ThreadPool& pool) : _pool(pool), _pending(0) {
+}
+
+TaskGroup::~TaskGroup() {
+	try {
+		wait();
+	} catch (...) {
+	}
+}
+
+void	TaskGroup::done(std::exception_ptr x) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	if ((x) && (!_exception)) {
+		_exception = x;
+	}
+	if (--_pending == 0) {
+		_cond.notify_all();
+	}
+}
+
+void	TaskGroup::run(const ThreadPool::task_type& task) {
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		_pending++;
+	}
+	_pool.submit([this, task]() {
+		std::exception_ptr	x;
+		try {
+			task();
+		} catch (...) {
+			x = std::current_exception();
+		}
+		done(x);
+	});
+}
+
+/**
+ * \brief Wait for all tasks of the group, helping with queued tasks
+ */
+void	TaskGroup::wait() {
+	for (;;) {
+		{
+			std::unique_lock<std::mutex>	lock(_mutex);
+			if (_pending == 0) {
+				break;
+			}
+		}
+		if (!_pool.run_one()) {
+			// all our tasks are running in other threads
+			std::unique_lock<std::mutex>	lock(_mutex);
+			while (_pending > 0) {
+				_cond.wait(lock);
+			}
+		}
+	}
+	std::exception_ptr	x;
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		x = _exception;
+		_exception = std::exception_ptr();
+	}
+	if (x) {
+		std::rethrow_exception(x);
+	}
+}
+
+} // namespace csg
@@ -0,0 +1,248 @@
+/*
+ * Union.cpp -- parallel union of many Nef polyhedra
+ *
+ * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Union.h>
+#include <AABBTree.h>
+#include <ThreadPool.h>
+#include <debug.h>
+#include <algorithm>
+#include <memory>
+#include <CGAL/boost/graph/graph_traits_Polyhedron_3.h>
+#include <CGAL/boost/graph/copy_face_graph.h>
+
+namespace csg {
+
+/**
+ * \brief Append the vertices and facets of a polyhedron to another one
+ */
+void	append(Polyhedron& target, const Polyhedron& source) {
+	CGAL::copy_face_graph(source, target);
+}
+
+/**
+ * \brief Concatenate two polyhedra
+ *
+ * If the two polyhedra do not intersect, this is their union.
+ */
+Polyhedron	concatenate(const Polyhedron& a, const Polyhedron& b) {
+	Polyhedron	result(a);
+	append(result, b);
+	return result;
+}
+
+Parallel_nary_union::operand::operand(const Nef_polyhedron& _nef)
+	: ismesh(false), nef(_nef) {
+	unbounded = csg::unbounded(nef);
+	if (!unbounded) {
+		box = bounding_box(nef);
+	}
+}
+
+Nef_polyhedron	Parallel_nary_union::operand::to_nef() const {
+	if (!ismesh) {
+		return nef;
+	}
+	// the Nef_polyhedron constructor needs a nonconst polyhedron
+	Polyhedron	copy(polyhedron);
+	return Nef_polyhedron(copy);
+}
+
+/**
+ * \brief Get the operand as a mesh, if it is bounded and simple
+ */
+bool	Parallel_nary_union::operand::to_mesh(Polyhedron& p) const {
+	if (ismesh) {
+		p = polyhedron;
+		return true;
+	}
+	if (unbounded || !nef.is_simple()) {
+		return false;
+	}
+	nef.convert_to_polyhedron(p);
+	return true;
+}
+
+void	Parallel_nary_union::add_polyhedron(const Nef_polyhedron& n) {
+	_operands.push_back(operand(n));
+}
+
+void	Parallel_nary_union::add_polyhedron(const Polyhedron& p) {
+	_meshes.push_back(mesh(p, bounding_box(p)));
+}
+
+/**
+ * \brief Collect the meshes in operands
+ *
+ * Meshes are greedily collected in clusters such that the solids within
+ * a cluster are pairwise apart: either their bounding boxes are disjoint,
+ * or bounding box trees show that their surfaces do not meet and neither
+ * contains the other. Each cluster is concatenated into a single mesh
+ * operand, which is converted to a Nef polyhedron only when needed.
+ */
+void	Parallel_nary_union::convert_meshes() {
+	if (_meshes.empty()) {
+		return;
+	}
+	bounds	total;
+	for (size_t i = 0; i < _meshes.size(); i++) {
+		total.add(_meshes[i].box);
+	}
+	double	margin = 1e-6 * total.extent().norm();
+	std::vector<std::unique_ptr<AABBTree> >	trees(_meshes.size());
+	{
+		TaskGroup	group;
+		for (size_t i = 0; i < _meshes.size(); i++) {
+			std::unique_ptr<AABBTree>	*tree = &trees[i];
+			const Polyhedron	*p = &_meshes[i].polyhedron;
+			group.run([tree, p]() { tree->reset(new AABBTree(*p)); });
+		}
+		group.wait();
+	}
+	std::vector<std::vector<size_t> >	clusters;
+	for (size_t i = 0; i < _meshes.size(); i++) {
+		size_t	c = 0;
+		for (; c < clusters.size(); c++) {
+			bool	disjoint = true;
+			for (size_t j = 0; j < clusters[c].size(); j++) {
+				size_t	k = clusters[c][j];
+				if (_meshes[k].box.overlaps(_meshes[i].box)
+					&& !trees[k]->separated(*trees[i],
+						margin)) {
+					disjoint = false;
+					break;
+				}
+			}
+			if (disjoint) {
+				break;
+			}
+		}
+		if (c == clusters.size()) {
+			clusters.push_back(std::vector<size_t>());
+		}
+		clusters[c].push_back(i);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%d meshes in %d disjoint clusters",
+		(int)_meshes.size(), (int)clusters.size());
+	size_t	first = _operands.size();
+	_operands.resize(first + clusters.size());
+	{
+		TaskGroup	group;
+		for (size_t c = 0; c < clusters.size(); c++) {
+			const std::vector<size_t>	*cluster = &clusters[c];
+			operand	*result = &_operands[first + c];
+			const std::vector<mesh>	*meshes = &_meshes;
+			group.run([cluster, result, meshes]() {
+				for (size_t j = 0; j < cluster->size(); j++) {
+					const mesh&	m = (*meshes)[(*cluster)[j]];
+					append(result->polyhedron, m.polyhedron);
+					result->box.add(m.box);
+				}
+				result->ismesh = true;
+			});
+		}
+		group.wait();
+	}
+	_meshes.clear();
+}
+
+/**
+ * \brief Order the operands along the longest axis of the total box
+ *
+ * Unbounded operands have no meaningful box, they come last.
+ */
+void	Parallel_nary_union::sort() {
+	bounds	total;
+	for (size_t i = 0; i < _operands.size(); i++) {
+		total.add(_operands[i].box);
+	}
+	vector	e = total.extent();
+	int	axis = 0;
+	if ((e.y() >= e.x()) && (e.y() >= e.z())) {
+		axis = 1;
+	}
+	if ((e.z() >= e.x()) && (e.z() >= e.y())) {
+		axis = 2;
+	}
+	std::stable_sort(_operands.begin(), _operands.end(),
+		[axis](const operand& a, const operand& b) {
+			if (a.unbounded || b.unbounded) {
+				return b.unbounded && !a.unbounded;
+			}
+			point	ca = a.box.center();
+			point	cb = b.box.center();
+			switch (axis) {
+			case 0:	return ca.x() < cb.x();
+			case 1:	return ca.y() < cb.y();
+			}
+			return ca.z() < cb.z();
+		});
+}
+
+/**
+ * \brief Merge two operands
+ *
+ * Bounded operands with disjoint boxes do not meet, so if both are simple
+ * their union is the concatenation of their meshes. As the boxes are
+ * rounded outwards monotonically, disjoint boxes imply disjoint solids.
+ */
+void	Parallel_nary_union::merge(const operand& a, const operand& b,
+		operand& result) {
+	if (!a.unbounded && !b.unbounded && !a.box.overlaps(b.box)) {
+		Polyhedron	pa, pb;
+		if (a.to_mesh(pa) && b.to_mesh(pb)) {
+			debug(LOG_DEBUG, DEBUG_LOG, 0, "disjoint operands");
+			result.polyhedron = concatenate(pa, pb);
+			result.ismesh = true;
+			result.box = a.box;
+			result.box.add(b.box);
+			return;
+		}
+	}
+	result.nef = a.to_nef() + b.to_nef();
+	result.unbounded = a.unbounded || b.unbounded;
+	if (result.unbounded) {
+		return;
+	}
+	result.box = a.box;
+	result.box.add(b.box);
+}
+
+/**
+ * \brief Perform one round of pairwise merges concurrently
+ */
+void	Parallel_nary_union::reduce() {
+	sort();
+	size_t	pairs = _operands.size() / 2;
+	std::vector<operand>	merged(pairs);
+	{
+		TaskGroup	group;
+		for (size_t i = 0; i < pairs; i++) {
+			operand	*a = &_operands[2 * i];
+			operand	*b = &_operands[2 * i + 1];
+			operand	*result = &merged[i];
+			group.run([a, b, result]() { merge(*a, *b, *result); });
+		}
+		group.wait();
+	}
+	if (_operands.size() % 2) {
+		merged.push_back(_operands.back());
+	}
+	_operands.swap(merged);
+}
+
+Nef_polyhedron	Parallel_nary_union::get_union() {
+	convert_meshes();
+	if (_operands.empty()) {
+		return Nef_polyhedron();
+	}
+	while (_operands.size() > 1) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "merging %d operands",
+			(int)_operands.size());
+		reduce();
+	}
+	return _operands.front().to_nef();
+}
+
+} // namespace csg
@@ -10,6 +10,19 @@ namespace csg {
 
 const Interval	Interval2Pi(0, 2 * M_PI);
 
+/**
+ * \brief Part of the interval between grid points a and b
+ *
+ * The interval is divided into steps equal parts. The end points of the
+ * interval are kept exactly, so that a subinterval covering the whole
+ * grid compares equal to the interval.
+ */
+Interval	Interval::subinterval(int steps, int a, int b) const {
+	double	delta = length() / steps;
+	return Interval((a == 0) ? _min : _min + a * delta,
+		(b == steps) ? _max : _min + b * delta);
+}
+
 vector	operator*(double l, const vector& v) {
 	return vector(l * v._x, l * v._y, l * v._z);
 }
@@ -71,6 +84,28 @@ bool	vector::parallel(const vector& v) const {
 	return false;
 }
 
+void	Function::evaluate(double x, const double *y, int n, double *z) {
+	for (int i = 0; i < n; i++) {
+		z[i] = (*this)(x, y[i]);
+	}
+}
+
+void	PointFunction::pv(double x, double y, point& _p, vector& _v) const {
+	_p = p(x, y);
+	_v = v(x, y);
+}
+
+void	PointFunction::evaluate(double x, const double *y, int n,
+		double *_p, double *_v) const {
+	point	pp;
+	vector	vv;
+	for (int i = 0; i < n; i++) {
+		pv(x, y[i], pp, vv);
+		_p[3 * i] = pp.x(); _p[3 * i + 1] = pp.y(); _p[3 * i + 2] = pp.z();
+		_v[3 * i] = vv.x(); _v[3 * i + 1] = vv.y(); _v[3 * i + 2] = vv.z();
+	}
+}
+
 const vector	vector::e1(1, 0, 0);
 const vector	vector::e2(0, 1, 0);
 const vector	vector::e3(0, 0, 1);